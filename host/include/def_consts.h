@@ -0,0 +1,16 @@
+// Host build: common constants of the framework
+#ifndef __DEF_CONSTS_H__
+#define __DEF_CONSTS_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <limits.h>
+
+#define BIT0 0x00000001
+#define BIT1 0x00000002
+#define BIT2 0x00000004
+#define BIT3 0x00000008
+#define BIT4 0x00000010
+
+#endif // __DEF_CONSTS_H__
@@ -0,0 +1,23 @@
+// Host build: heap information, the values of the process heap are returned
+#ifndef __ESP_HEAP_CAPS_H__
+#define __ESP_HEAP_CAPS_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MALLOC_CAP_DEFAULT (1 << 12)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+size_t heap_caps_get_total_size(uint32_t caps);
+size_t heap_caps_get_free_size(uint32_t caps);
+size_t heap_caps_get_largest_free_block(uint32_t caps);
+size_t heap_caps_get_allocated_size(void* ptr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __ESP_HEAP_CAPS_H__
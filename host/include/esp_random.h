@@ -0,0 +1,17 @@
+// Host build: random numbers
+#ifndef __ESP_RANDOM_H__
+#define __ESP_RANDOM_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t esp_random(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __ESP_RANDOM_H__
@@ -0,0 +1,8 @@
+// Host build: system functions
+#ifndef __ESP_SYSTEM_H__
+#define __ESP_SYSTEM_H__
+
+#include "esp_err.h"
+#include "esp_random.h"
+
+#endif // __ESP_SYSTEM_H__
@@ -0,0 +1,28 @@
+/*
+   EN: FreeRTOS for the host build: tasks are POSIX threads, one tick is one millisecond
+   RU: FreeRTOS для сборки на хосте: задачи - потоки POSIX, один тик равен одной миллисекунде
+*/
+
+#ifndef __HOST_FREERTOS_H__
+#define __HOST_FREERTOS_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <limits.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint8_t StackType_t;
+
+#define pdFALSE                 ((BaseType_t)0)
+#define pdTRUE                  ((BaseType_t)1)
+#define pdFAIL                  pdFALSE
+#define pdPASS                  pdTRUE
+#define portMAX_DELAY           ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS      ((TickType_t)1)
+#define pdMS_TO_TICKS(ms)       ((TickType_t)(ms))
+#define configTICK_RATE_HZ      1000
+
+#endif // __HOST_FREERTOS_H__
@@ -0,0 +1,29 @@
+// Host build: FreeRTOS semaphores
+#ifndef __HOST_FREERTOS_SEMPHR_H__
+#define __HOST_FREERTOS_SEMPHR_H__
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_semaphore_t* SemaphoreHandle_t;
+
+typedef struct {
+  uint8_t dummy;
+} StaticSemaphore_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t* pxSemaphoreBuffer);
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t* pxMutexBuffer);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xBlockTime);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore);
+void vSemaphoreDelete(SemaphoreHandle_t xSemaphore);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __HOST_FREERTOS_SEMPHR_H__
@@ -0,0 +1,56 @@
+// Host build: FreeRTOS tasks and direct notifications
+#ifndef __HOST_FREERTOS_TASK_H__
+#define __HOST_FREERTOS_TASK_H__
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_task_t* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+typedef struct {
+  uint8_t dummy;
+} StaticTask_t;
+
+typedef enum {
+  eRunning = 0,
+  eReady,
+  eBlocked,
+  eSuspended,
+  eDeleted,
+  eInvalid
+} eTaskState;
+
+typedef enum {
+  eNoAction = 0,
+  eSetBits,
+  eIncrement,
+  eSetValueWithOverwrite,
+  eSetValueWithoutOverwrite
+} eNotifyAction;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t pvTaskCode, const char* pcName, uint32_t usStackDepth, void* pvParameters,
+  UBaseType_t uxPriority, TaskHandle_t* pvCreatedTask, BaseType_t xCoreID);
+TaskHandle_t xTaskCreateStaticPinnedToCore(TaskFunction_t pvTaskCode, const char* pcName, uint32_t ulStackDepth, void* pvParameters,
+  UBaseType_t uxPriority, StackType_t* pxStackBuffer, StaticTask_t* pxTaskBuffer, BaseType_t xCoreID);
+void vTaskDelete(TaskHandle_t xTaskToDelete);
+void vTaskSuspend(TaskHandle_t xTaskToSuspend);
+void vTaskResume(TaskHandle_t xTaskToResume);
+eTaskState eTaskGetState(TaskHandle_t xTask);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t xTask);
+
+TickType_t xTaskGetTickCount(void);
+void vTaskDelay(TickType_t xTicksToDelay);
+
+BaseType_t xTaskNotify(TaskHandle_t xTaskToNotify, uint32_t ulValue, eNotifyAction eAction);
+BaseType_t xTaskNotifyWait(uint32_t ulBitsToClearOnEntry, uint32_t ulBitsToClearOnExit, uint32_t* pulNotificationValue, TickType_t xTicksToWait);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __HOST_FREERTOS_TASK_H__
@@ -0,0 +1,76 @@
+/*
+   EN: Control of the host build shims: clock (real or virtual), random numbers, socket backend, log level and output of the sinks
+   RU: Управление прослойками сборки на хосте: часы (реальные или виртуальные), случайные числа, сетевой бэкенд, уровень журнала и вывод
+*/
+
+#ifndef __HOST_H__
+#define __HOST_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <sys/types.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include "lwip/lwip_host.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ------------------------------------------------------- Clock ----------------------------------------------------------
+
+/**
+ * Virtual clock: time stands still until it is advanced explicitly or by a wait (vTaskDelay, xSemaphoreTake, 
+ * xTaskNotifyWait, select of the backend), waits do not block, so only one task may work with the virtual clock.
+ * Timers are called at the scheduled time in the thread that advances the clock
+ **/
+typedef void (*host_timer_cb_t)(void* arg);
+
+void hostClockSetVirtual(bool enabled);
+bool hostClockIsVirtual();
+int64_t hostClockNow();
+void hostClockAdvanceTo(int64_t time_us);
+bool hostClockSchedule(int64_t time_us, host_timer_cb_t callback, void* arg);
+int64_t hostClockNextTimer();
+
+// Waiting until ready(arg) or timeout (-1 - infinitely), on the virtual clock, returns ready(arg)
+bool hostClockWait(int64_t timeout_us, bool (*ready)(void* arg), void* arg);
+
+// ------------------------------------------------------- Random ---------------------------------------------------------
+
+// Repeatable sequence of esp_random() for the simulation, 0 - system random numbers
+void hostRandomSeed(uint64_t seed);
+
+// ---------------------------------------------------- Sockets -----------------------------------------------------------
+
+typedef struct {
+  int (*socket)(int domain, int type, int protocol);
+  int (*close)(int s);
+  ssize_t (*sendto)(int s, const void* dataptr, size_t size, int flags, const struct sockaddr* to, socklen_t tolen);
+  ssize_t (*recvfrom)(int s, void* mem, size_t len, int flags, struct sockaddr* from, socklen_t* fromlen);
+  int (*select)(int maxfdp1, fd_set* readset, fd_set* writeset, fd_set* exceptset, struct timeval* timeout);
+  int (*setsockopt)(int s, int level, int optname, const void* optval, socklen_t optlen);
+  int (*getsockopt)(int s, int level, int optname, void* optval, socklen_t* optlen);
+  err_t (*gethostbyname)(const char* hostname, ip_addr_t* addr, dns_found_callback found, void* callback_arg);
+} host_net_backend_t;
+
+// nullptr - Linux sockets and resolver
+void hostNetSetBackend(const host_net_backend_t* backend);
+
+// ------------------------------------------------------ Output ----------------------------------------------------------
+
+// Log level: 0 - none ... 5 - verbose, limited by CONFIG_RLOG_PROJECT_LEVEL
+void hostLogSetLevel(int level);
+
+// Printing of MQTT messages and data sent to external services to stdout
+void hostOutputSetEnabled(bool enabled);
+
+// Interception of the sinks instead of printing (benchmarks): topic is nullptr for the data sent to external services
+typedef void (*host_output_sink_t)(const char* topic, const char* payload, size_t size);
+void hostOutputSetSink(host_output_sink_t sink);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __HOST_H__
@@ -0,0 +1,7 @@
+// Host build: see lwip/lwip_host.h
+#ifndef __LWIP_INIT_H__
+#define __LWIP_INIT_H__
+
+#include "lwip/lwip_host.h"
+
+#endif // __LWIP_INIT_H__
@@ -0,0 +1,149 @@
+/*
+   EN: lwIP for the host build: IPv4 only, sockets are Linux sockets. ICMP sockets are raw sockets if the process has
+       CAP_NET_RAW, otherwise unprivileged SOCK_DGRAM sockets (net.ipv4.ping_group_range), in this case the IP header
+       of the received packets is restored by lwip_recvfrom()
+   RU: lwIP для сборки на хосте: только IPv4, сокеты - сокеты Linux. Сокеты ICMP - raw сокеты, если у процесса есть
+       CAP_NET_RAW, иначе непривилегированные сокеты SOCK_DGRAM (net.ipv4.ping_group_range), в этом случае заголовок
+       IP принятых пакетов восстанавливает lwip_recvfrom()
+*/
+
+#ifndef __LWIP_HOST_H__
+#define __LWIP_HOST_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <unistd.h>
+
+#ifndef LWIP_DNS
+#define LWIP_DNS 1
+#endif // LWIP_DNS
+
+typedef uint8_t u8_t;
+typedef uint16_t u16_t;
+typedef uint32_t u32_t;
+typedef int8_t s8_t;
+typedef int16_t s16_t;
+typedef int32_t s32_t;
+
+typedef s8_t err_t;
+
+#define ERR_OK          0
+#define ERR_MEM        -1
+#define ERR_BUF        -2
+#define ERR_TIMEOUT    -3
+#define ERR_RTE        -4
+#define ERR_INPROGRESS -5
+#define ERR_VAL        -6
+#define ERR_ARG       -16
+
+// Addresses
+typedef struct ip4_addr {
+  u32_t addr;
+} ip4_addr_t;
+
+typedef ip4_addr_t ip_addr_t;
+
+#define IPADDR_TYPE_V4 0U
+#define IPADDR_TYPE_V6 6U
+
+#define ip_2_ip4(ipaddr)                (ipaddr)
+#define IP_SET_TYPE_VAL(ipaddr, iptype)
+#define IP_IS_V4_VAL(ipaddr)            1
+#define IP_IS_V6_VAL(ipaddr)            0
+#define IP_IS_V4(ipaddr)                1
+#define IP_IS_V6(ipaddr)                0
+
+#define ip_addr_set_zero(ipaddr)        ((ipaddr)->addr = 0)
+#define ip_addr_isany_val(ipaddr)       ((ipaddr).addr == 0)
+#define ip_addr_isany(ipaddr)           (((ipaddr) == NULL) || ((ipaddr)->addr == 0))
+#define ip_addr_cmp(addr1, addr2)       ((addr1)->addr == (addr2)->addr)
+#define ip_addr_copy(dest, src)         ((dest).addr = (src).addr)
+
+#define ip4_addr_get_byte(ipaddr, idx)  (((const u8_t*)(&(ipaddr)->addr))[idx])
+#define ip4_addr1(ipaddr)               ip4_addr_get_byte(ipaddr, 0)
+#define ip4_addr2(ipaddr)               ip4_addr_get_byte(ipaddr, 1)
+#define ip4_addr3(ipaddr)               ip4_addr_get_byte(ipaddr, 2)
+#define ip4_addr4(ipaddr)               ip4_addr_get_byte(ipaddr, 3)
+
+#define inet_addr_from_ip4addr(target_inaddr, source_ipaddr) ((target_inaddr)->s_addr = (source_ipaddr)->addr)
+#define inet_addr_to_ip4addr(target_ipaddr, source_inaddr)   ((target_ipaddr)->addr = (source_inaddr)->s_addr)
+
+#define lwip_htons(x) htons(x)
+#define lwip_ntohs(x) ntohs(x)
+#define lwip_htonl(x) htonl(x)
+#define lwip_ntohl(x) ntohl(x)
+
+// Headers
+#define IP_PROTO_ICMP 1
+
+struct ip_hdr {
+  u8_t _v_hl;
+  u8_t _tos;
+  u16_t _len;
+  u16_t _id;
+  u16_t _offset;
+  u8_t _ttl;
+  u8_t _proto;
+  u16_t _chksum;
+  ip4_addr_t src;
+  ip4_addr_t dest;
+} __attribute__((packed));
+
+#define IPH_V(hdr)  ((hdr)->_v_hl >> 4)
+#define IPH_HL(hdr) ((hdr)->_v_hl & 0x0f)
+#define IPH_LEN(hdr) ((hdr)->_len)
+#define IPH_TTL(hdr) ((hdr)->_ttl)
+
+#define ICMP_ER   0
+#define ICMP_DUR  3
+#define ICMP_ECHO 8
+#define ICMP_TE  11
+
+struct icmp_echo_hdr {
+  u8_t type;
+  u8_t code;
+  u16_t chksum;
+  u16_t id;
+  u16_t seqno;
+} __attribute__((packed));
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Address conversion, ipaddr_ntoa() returns a static buffer
+char* ipaddr_ntoa(const ip_addr_t* addr);
+char* ipaddr_ntoa_r(const ip_addr_t* addr, char* buf, int buflen);
+int ipaddr_aton(const char* cp, ip_addr_t* addr);
+
+// Internet checksum (RFC 1071)
+u16_t inet_chksum(const void* dataptr, u16_t len);
+
+// Resolver: literal addresses are returned immediately, names are resolved in a separate thread
+typedef void (*dns_found_callback)(const char* name, const ip_addr_t* ipaddr, void* callback_arg);
+err_t dns_gethostbyname(const char* hostname, ip_addr_t* addr, dns_found_callback found, void* callback_arg);
+
+// Sockets
+int lwip_socket(int domain, int type, int protocol);
+int lwip_close(int s);
+ssize_t lwip_sendto(int s, const void* dataptr, size_t size, int flags, const struct sockaddr* to, socklen_t tolen);
+ssize_t lwip_recvfrom(int s, void* mem, size_t len, int flags, struct sockaddr* from, socklen_t* fromlen);
+int lwip_select(int maxfdp1, fd_set* readset, fd_set* writeset, fd_set* exceptset, struct timeval* timeout);
+int lwip_setsockopt(int s, int level, int optname, const void* optval, socklen_t optlen);
+int lwip_getsockopt(int s, int level, int optname, void* optval, socklen_t* optlen);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __LWIP_HOST_H__
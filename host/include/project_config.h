@@ -0,0 +1,202 @@
+/*
+   EN: Project configuration for the host build (Linux), any value can be overridden with -D
+   RU: Конфигурация проекта для сборки на хосте (Linux), любое значение можно переопределить через -D
+   --------------------------
+   (с) 2021 Разживин Александр | Razzhivin Alexander
+   kotyara12@yandex.ru | https://kotyara12.ru | tg: @kotyara1971
+*/
+
+#ifndef __PROJECT_CONFIG_H__
+#define __PROJECT_CONFIG_H__
+
+// ------------------------------------------------------ Pinger ---------------------------------------------------------
+#ifndef CONFIG_PINGER_ENABLE
+#define CONFIG_PINGER_ENABLE 1
+#endif
+#ifndef CONFIG_PINGER_HOST_1
+#define CONFIG_PINGER_HOST_1 "8.8.8.8"
+#endif
+#ifndef CONFIG_PINGER_HOST_2
+#define CONFIG_PINGER_HOST_2 "1.1.1.1"
+#endif
+#ifndef CONFIG_PINGER_HOST_3
+#define CONFIG_PINGER_HOST_3 "77.88.8.8"
+#endif
+#ifndef CONFIG_PINGER_PARAM_COUNT
+#define CONFIG_PINGER_PARAM_COUNT 5
+#endif
+#ifndef CONFIG_PINGER_PARAM_TIMEOUT
+#define CONFIG_PINGER_PARAM_TIMEOUT 1000
+#endif
+#ifndef CONFIG_PINGER_PARAM_DATASIZE
+#define CONFIG_PINGER_PARAM_DATASIZE 32
+#endif
+#ifndef CONFIG_PINGER_TOTAL_RESULT_MODE
+#define CONFIG_PINGER_TOTAL_RESULT_MODE 1
+#endif
+#ifndef CONFIG_PINGER_SLOWDOWN_DURATION
+#define CONFIG_PINGER_SLOWDOWN_DURATION 300
+#endif
+#ifndef CONFIG_PINGER_SLOWDOWN_LOSS
+#define CONFIG_PINGER_SLOWDOWN_LOSS 20.0
+#endif
+#ifndef CONFIG_PINGER_UNAVAILABLE_DURATION
+#define CONFIG_PINGER_UNAVAILABLE_DURATION 1000
+#endif
+#ifndef CONFIG_PINGER_UNAVAILABLE_LOSS
+#define CONFIG_PINGER_UNAVAILABLE_LOSS 80.0
+#endif
+#ifndef CONFIG_PINGER_UNAVAILABLE_THRESHOLD
+#define CONFIG_PINGER_UNAVAILABLE_THRESHOLD 2
+#endif
+#ifndef CONFIG_PINGER_INTERVAL_AVAILABLE
+#define CONFIG_PINGER_INTERVAL_AVAILABLE 10000
+#endif
+#ifndef CONFIG_PINGER_INTERVAL_UNAVAILABLE
+#define CONFIG_PINGER_INTERVAL_UNAVAILABLE 5000
+#endif
+#ifndef CONFIG_PINGER_IP_VALIDITY
+#define CONFIG_PINGER_IP_VALIDITY 3600000
+#endif
+#ifndef CONFIG_PINGER_FILTER_MODE
+#define CONFIG_PINGER_FILTER_MODE 2
+#endif
+#ifndef CONFIG_PINGER_FILTER_SIZE
+#define CONFIG_PINGER_FILTER_SIZE 5
+#endif
+#ifndef CONFIG_PING_SHOW_INTERMEDIATE
+#define CONFIG_PING_SHOW_INTERMEDIATE 0
+#endif
+
+// ------------------------------------------------------- Task ----------------------------------------------------------
+#ifndef CONFIG_PINGER_TASK_STATIC_ALLOCATION
+#define CONFIG_PINGER_TASK_STATIC_ALLOCATION 0
+#endif
+#ifndef CONFIG_PINGER_TASK_STACK_SIZE
+#define CONFIG_PINGER_TASK_STACK_SIZE 4096
+#endif
+#ifndef CONFIG_TASK_PRIORITY_PINGER
+#define CONFIG_TASK_PRIORITY_PINGER 5
+#endif
+#ifndef CONFIG_TASK_CORE_PINGER
+#define CONFIG_TASK_CORE_PINGER 1
+#endif
+
+// ---------------------------------------------------- Parameters -------------------------------------------------------
+#define CONFIG_PINGER_PGROUP_ROOT_KEY "ping"
+#define CONFIG_PINGER_PGROUP_ROOT_TOPIC "ping"
+#define CONFIG_PINGER_PGROUP_ROOT_FRIENDLY "Pinger"
+#define CONFIG_PINGER_PARAM_COUNT_KEY "count"
+#define CONFIG_PINGER_PARAM_COUNT_FRIENDLY "Number of requests"
+#define CONFIG_PINGER_PARAM_TIMEOUT_KEY "timeout"
+#define CONFIG_PINGER_PARAM_TIMEOUT_FRIENDLY "Response timeout"
+#define CONFIG_PINGER_PARAM_DATASIZE_KEY "size"
+#define CONFIG_PINGER_PARAM_DATASIZE_FRIENDLY "Packet size"
+#define CONFIG_PINGER_PARAM_RESULT_MODE_KEY "mode"
+#define CONFIG_PINGER_PARAM_RESULT_MODE_FRIENDLY "Result mode"
+#define CONFIG_PINGER_PARAM_SLOWDOWN_DURATION_KEY "slow_time"
+#define CONFIG_PINGER_PARAM_SLOWDOWN_DURATION_FRIENDLY "Slowdown: response time"
+#define CONFIG_PINGER_PARAM_SLOWDOWN_LOSS_KEY "slow_loss"
+#define CONFIG_PINGER_PARAM_SLOWDOWN_LOSS_FRIENDLY "Slowdown: losses"
+#define CONFIG_PINGER_PARAM_UNAVAILABLE_DURATION_KEY "unavailable_time"
+#define CONFIG_PINGER_PARAM_UNAVAILABLE_DURATION_FRIENDLY "Unavailable: response time"
+#define CONFIG_PINGER_PARAM_UNAVAILABLE_LOSS_KEY "unavailable_loss"
+#define CONFIG_PINGER_PARAM_UNAVAILABLE_LOSS_FRIENDLY "Unavailable: losses"
+#define CONFIG_PINGER_PARAM_UNAVAILABLE_THRESHOLD_KEY "unavailable_threshold"
+#define CONFIG_PINGER_PARAM_UNAVAILABLE_THRESHOLD_FRIENDLY "Unavailable: threshold"
+#define CONFIG_PINGER_PARAM_INTERVAL_AVAILABLE_KEY "interval_available"
+#define CONFIG_PINGER_PARAM_INTERVAL_AVAILABLE_FRIENDLY "Interval: available"
+#define CONFIG_PINGER_PARAM_INTERVAL_UNAVAILABLE_KEY "interval_unavailable"
+#define CONFIG_PINGER_PARAM_INTERVAL_UNAVAILABLE_FRIENDLY "Interval: unavailable"
+#define CONFIG_MQTT_PARAMS_QOS 1
+
+// ------------------------------------------------------- MQTT ----------------------------------------------------------
+#ifndef CONFIG_MQTT1_PING_CHECK
+#define CONFIG_MQTT1_PING_CHECK 0
+#endif
+#ifndef CONFIG_MQTT1_HOST
+#define CONFIG_MQTT1_HOST "localhost"
+#endif
+#ifndef CONFIG_MQTT1_PING_CHECK_LIMIT
+#define CONFIG_MQTT1_PING_CHECK_LIMIT 3
+#endif
+#ifndef CONFIG_MQTT2_PING_CHECK
+#define CONFIG_MQTT2_PING_CHECK 0
+#endif
+#ifndef CONFIG_MQTT2_HOST
+#define CONFIG_MQTT2_HOST "localhost"
+#endif
+#ifndef CONFIG_MQTT2_PING_CHECK_LIMIT
+#define CONFIG_MQTT2_PING_CHECK_LIMIT 3
+#endif
+#ifndef CONFIG_MQTT_PINGER_ENABLE
+#define CONFIG_MQTT_PINGER_ENABLE 1
+#endif
+#ifndef CONFIG_MQTT_PINGER_AS_PLAIN
+#define CONFIG_MQTT_PINGER_AS_PLAIN 0
+#endif
+#ifndef CONFIG_MQTT_PINGER_AS_JSON
+#define CONFIG_MQTT_PINGER_AS_JSON 1
+#endif
+#ifndef CONFIG_MQTT_PINGER_LOCAL
+#define CONFIG_MQTT_PINGER_LOCAL 0
+#endif
+#ifndef CONFIG_MQTT_PINGER_TOPIC
+#define CONFIG_MQTT_PINGER_TOPIC "ping"
+#endif
+#ifndef CONFIG_MQTT_PINGER_QOS
+#define CONFIG_MQTT_PINGER_QOS 0
+#endif
+#ifndef CONFIG_MQTT_PINGER_RETAINED
+#define CONFIG_MQTT_PINGER_RETAINED 1
+#endif
+
+// ------------------------------------------------- open-monitoring -----------------------------------------------------
+#ifndef CONFIG_OPENMON_ENABLE
+#define CONFIG_OPENMON_ENABLE 1
+#endif
+#ifndef CONFIG_OPENMON_PINGER_ENABLE
+#define CONFIG_OPENMON_PINGER_ENABLE 1
+#endif
+#define CONFIG_OPENMON_PINGER_ID 1
+#define CONFIG_OPENMON_PINGER_TOKEN "host"
+#define CONFIG_OPENMON_MIN_INTERVAL 60000
+#define CONFIG_OPENMON_ERROR_INTERVAL 60000
+#ifndef CONFIG_OPENMON_PINGER_RSSI
+#define CONFIG_OPENMON_PINGER_RSSI 0
+#endif
+#ifndef CONFIG_OPENMON_PINGER_HEAP_FREE
+#define CONFIG_OPENMON_PINGER_HEAP_FREE 0
+#endif
+#ifndef CONFIG_OPENMON_PINGER_HOSTS
+#define CONFIG_OPENMON_PINGER_HOSTS 1
+#endif
+#ifndef CONFIG_OPENMON_PINGER_JITTER
+#define CONFIG_OPENMON_PINGER_JITTER 1
+#endif
+
+// ----------------------------------------------------- Formats ---------------------------------------------------------
+#ifndef CONFIG_SENSOR_STRING_ENABLE
+#define CONFIG_SENSOR_STRING_ENABLE 0
+#endif
+#define CONFIG_SENSOR_NUMERIC_VALUE "value"
+#define CONFIG_SENSOR_STRING_VALUE "string"
+#define CONFIG_SENSOR_DISPLAY "display"
+#define CONFIG_FORMAT_PING_TIMERESP_VALUE "%d"
+#define CONFIG_FORMAT_PING_TIMERESP_STRING "%d ms"
+#define CONFIG_FORMAT_PING_LOSS_VALUE "%.1f"
+#define CONFIG_FORMAT_PING_LOSS_STRING "%.1f%%"
+#define CONFIG_FORMAT_PING_MIXED "%s %d ms %.1f%%"
+#define CONFIG_FORMAT_PING_OK "OK"
+#define CONFIG_FORMAT_PING_SLOWDOWN "SLOW"
+#define CONFIG_FORMAT_PING_UNAVAILABLED "DOWN"
+#define CONFIG_FORMAT_DTS "%d.%m.%Y %H:%M:%S"
+#define CONFIG_FORMAT_STRFTIME_DTS_BUFFER_SIZE 20
+#define CONFIG_FORMAT_STRFTIME_BUFFER_SIZE 20
+#define CONFIG_BUFFER_LEN_INT64_RADIX10 21
+
+// ------------------------------------------------------- lwIP ----------------------------------------------------------
+#define CONFIG_LWIP_IPV6 0
+#define LWIP_DNS 1
+
+#endif // __PROJECT_CONFIG_H__
@@ -0,0 +1,34 @@
+// Host build: log messages are written to stderr
+#ifndef __RLOG_H__
+#define __RLOG_H__
+
+#include <stdio.h>
+
+// 0 - none, 1 - errors, 2 - warnings, 3 - info, 4 - debug, 5 - verbose
+#ifndef CONFIG_RLOG_PROJECT_LEVEL
+#define CONFIG_RLOG_PROJECT_LEVEL 3
+#endif // CONFIG_RLOG_PROJECT_LEVEL
+
+// Level at runtime, see hostLogSetLevel()
+#ifdef __cplusplus
+extern "C" int rlogHostLevel;
+#else
+extern int rlogHostLevel;
+#endif
+
+#define RLOG_HOST_PRINT(level, letter, tag, format, ...) \
+  do { if ((CONFIG_RLOG_PROJECT_LEVEL >= level) && (rlogHostLevel >= level)) fprintf(stderr, letter " (%s): " format "\n", tag, ##__VA_ARGS__); } while (0)
+
+#define rlog_e(tag, format, ...) RLOG_HOST_PRINT(1, "E", tag, format, ##__VA_ARGS__)
+#define rlog_w(tag, format, ...) RLOG_HOST_PRINT(2, "W", tag, format, ##__VA_ARGS__)
+#define rlog_i(tag, format, ...) RLOG_HOST_PRINT(3, "I", tag, format, ##__VA_ARGS__)
+#define rlog_d(tag, format, ...) RLOG_HOST_PRINT(4, "D", tag, format, ##__VA_ARGS__)
+#define rlog_v(tag, format, ...) RLOG_HOST_PRINT(5, "V", tag, format, ##__VA_ARGS__)
+
+#define rloga_e(format, ...) RLOG_HOST_PRINT(1, "E", "ASSERT", format, ##__VA_ARGS__)
+#define rloga_w(format, ...) RLOG_HOST_PRINT(2, "W", "ASSERT", format, ##__VA_ARGS__)
+#define rloga_i(format, ...) RLOG_HOST_PRINT(3, "I", "ASSERT", format, ##__VA_ARGS__)
+#define rloga_d(format, ...) RLOG_HOST_PRINT(4, "D", "ASSERT", format, ##__VA_ARGS__)
+#define rloga_v(format, ...) RLOG_HOST_PRINT(5, "V", "ASSERT", format, ##__VA_ARGS__)
+
+#endif // __RLOG_H__
@@ -0,0 +1,24 @@
+// Host build: string functions of the rStrings library
+#ifndef __RSTRINGS_H__
+#define __RSTRINGS_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+char* malloc_string(const char* source);
+char* malloc_stringf(const char* format, ...);
+char* malloc_timestr(const char* format, time_t value);
+char* concat_strings_div(char* str1, char* str2, const char* divider);
+char* _ui64toa(uint64_t value, char* buffer, int radix);
+size_t time2str(const char* format, time_t* value, char* buffer, size_t buffer_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __RSTRINGS_H__
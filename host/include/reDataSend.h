@@ -0,0 +1,25 @@
+// Host build: sending data to external services, requests are written to stdout
+#ifndef __RE_DATASEND_H__
+#define __RE_DATASEND_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum {
+  EDS_OPENMON = 0,
+  EDS_NARODMON,
+  EDS_THINGSPEAK
+} ext_data_service_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool dsChannelInit(ext_data_service_t kind, uint32_t uid, const char* key, uint32_t min_interval, uint32_t err_interval);
+bool dsSend(ext_data_service_t kind, uint32_t uid, char* data, bool free_data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __RE_DATASEND_H__
@@ -0,0 +1,26 @@
+// Host build: memory allocation functions of the reEsp32 library
+#ifndef __RE_ESP32_H__
+#define __RE_ESP32_H__
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include "rLog.h"
+#include "esp_err.h"
+#include "esp_heap_caps.h"
+
+#define RE_MEM_CHECK(tag, a, action) if (!(a)) { rlog_e(tag, "Failed to allocate memory!"); action; }
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void* esp_malloc(size_t size);
+void* esp_calloc(size_t count, size_t size);
+bool esp_heap_free_check();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __RE_ESP32_H__
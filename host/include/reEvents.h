@@ -0,0 +1,122 @@
+/*
+   EN: Event loop for the host build: events are delivered synchronously to the registered handlers
+   RU: Цикл событий для сборки на хосте: события доставляются обработчикам синхронно
+*/
+
+#ifndef __RE_EVENTS_H__
+#define __RE_EVENTS_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <time.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "lwip/ip_addr.h"
+
+typedef const char* esp_event_base_t;
+typedef void (*esp_event_handler_t)(void* event_handler_arg, esp_event_base_t event_base, int32_t event_id, void* event_data);
+
+#define ESP_EVENT_ANY_ID -1
+
+extern esp_event_base_t const RE_SYSTEM_EVENTS;
+extern esp_event_base_t const RE_WIFI_EVENTS;
+extern esp_event_base_t const RE_MQTT_EVENTS;
+extern esp_event_base_t const RE_PING_EVENTS;
+
+typedef enum {
+  RE_SYS_STARTED = 0,
+  RE_SYS_OTA,
+  RE_SYS_ERROR
+} re_system_event_id_t;
+
+typedef enum {
+  RE_SYS_CLEAR = 0,
+  RE_SYS_SET
+} re_system_event_type_t;
+
+typedef struct {
+  re_system_event_type_t type;
+  int value;
+} re_system_event_data_t;
+
+typedef enum {
+  RE_WIFI_STA_INIT = 0,
+  RE_WIFI_STA_STARTED,
+  RE_WIFI_STA_GOT_IP,
+  RE_WIFI_STA_DISCONNECTED,
+  RE_WIFI_STA_STOPPED
+} re_wifi_event_id_t;
+
+typedef enum {
+  RE_MQTT_CONNECTED = 0,
+  RE_MQTT_CONN_LOST,
+  RE_MQTT_CONN_FAILED
+} re_mqtt_event_id_t;
+
+typedef struct {
+  bool primary;
+} re_mqtt_event_data_t;
+
+typedef enum {
+  RE_PING_STARTED = 0,
+  RE_PING_STOPPED,
+  RE_PING_INET_AVAILABLE,
+  RE_PING_INET_SLOWDOWN,
+  RE_PING_INET_UNAVAILABLE,
+  RE_PING_HOST_AVAILABLE,
+  RE_PING_HOST_UNAVAILABLE,
+  RE_PING_MQTT1_AVAILABLE,
+  RE_PING_MQTT1_UNAVAILABLE,
+  RE_PING_MQTT2_AVAILABLE,
+  RE_PING_MQTT2_UNAVAILABLE
+} re_ping_event_id_t;
+
+typedef enum {
+  PING_OK = 0,
+  PING_SLOWDOWN,
+  PING_UNAVAILABLE,
+  PING_FAILED
+} ping_state_t;
+
+typedef struct {
+  const char* host_name;
+  ip_addr_t host_addr;
+  ping_state_t state;
+  uint32_t transmitted;
+  uint32_t received;
+  uint32_t total_time_ms;
+  uint32_t duration_ms;
+  float loss;
+  uint8_t ttl;
+  time_t time_unavailable;
+} ping_host_data_t;
+
+typedef struct {
+  ping_state_t state;
+  uint8_t hosts_count;
+  uint8_t hosts_available;
+  uint32_t duration_ms_min;
+  uint32_t duration_ms_max;
+  uint32_t duration_ms_total;
+  float loss_min;
+  float loss_max;
+  float loss_total;
+  time_t time_unavailable;
+  uint32_t count_unavailable;
+} ping_inet_data_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool eventLoopPost(esp_event_base_t event_base, int32_t event_id, void* event_data, size_t event_data_size, TickType_t ticks_to_wait);
+bool eventLoopPostError(int32_t event_id, esp_err_t err);
+bool eventHandlerRegister(esp_event_base_t event_base, int32_t event_id, esp_event_handler_t event_handler, void* event_handler_arg);
+bool eventHandlerUnregister(esp_event_base_t event_base, int32_t event_id, esp_event_handler_t event_handler);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __RE_EVENTS_H__
@@ -0,0 +1,20 @@
+// Host build: MQTT client, messages are written to stdout as "topic = payload"
+#ifndef __RE_MQTT_H__
+#define __RE_MQTT_H__
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+char* mqttGetTopicDevice1(bool primary, bool local, const char* topic);
+char* mqttGetSubTopic(const char* topic, const char* subtopic);
+bool mqttPublish(char* topic, char* payload, int qos, bool retained, bool free_topic, bool free_payload);
+bool mqttIsConnected();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __RE_MQTT_H__
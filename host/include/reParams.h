@@ -0,0 +1,56 @@
+/*
+   EN: Parameters for the host build: the default value can be overridden with the environment variable <GROUP>_<KEY>,
+       for example PING_COUNT=10
+   RU: Параметры для сборки на хосте: значение по умолчанию можно переопределить переменной окружения <GROUP>_<KEY>,
+       например PING_COUNT=10
+*/
+
+#ifndef __RE_PARAMS_H__
+#define __RE_PARAMS_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum {
+  OPT_KIND_PARAMETER = 0,
+  OPT_KIND_LOCDATA_ONLINE
+} param_kind_t;
+
+typedef enum {
+  OPT_TYPE_I8 = 0,
+  OPT_TYPE_U8,
+  OPT_TYPE_I16,
+  OPT_TYPE_U16,
+  OPT_TYPE_I32,
+  OPT_TYPE_U32,
+  OPT_TYPE_FLOAT,
+  OPT_TYPE_STRING
+} param_type_t;
+
+typedef enum {
+  PARAM_SET_CHANGED = 0,
+  PARAM_SET_RESTORED
+} param_change_mode_t;
+
+// The handler is called by the parameter update with the parameters locked
+class param_handler_t {
+  public:
+    virtual void onChange(param_change_mode_t mode) = 0;
+};
+
+typedef struct paramsGroup_t* paramsGroupHandle_t;
+typedef struct paramsEntry_t* paramsEntryHandle_t;
+
+paramsGroupHandle_t paramsRegisterGroup(paramsGroupHandle_t parent_group, const char* name_key, const char* name_topic, const char* name_friendly);
+paramsEntryHandle_t paramsRegisterValue(param_kind_t type_param, param_type_t type_value, param_handler_t* change_handler,
+  paramsGroupHandle_t parent_group, const char* name_key, const char* name_friendly, int qos, void* value);
+void paramsSetLimitsU8(paramsEntryHandle_t entry, uint8_t min_value, uint8_t max_value);
+void paramsSetLimitsU16(paramsEntryHandle_t entry, uint16_t min_value, uint16_t max_value);
+void paramsSetLimitsU32(paramsEntryHandle_t entry, uint32_t min_value, uint32_t max_value);
+void paramsSetLimitsFloat(paramsEntryHandle_t entry, float min_value, float max_value);
+
+// Exclusive access to the values of the parameters, the lock is recursive
+void paramsLock();
+void paramsUnlock();
+
+#endif // __RE_PARAMS_H__
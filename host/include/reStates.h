@@ -0,0 +1,17 @@
+// Host build: device states
+#ifndef __RE_STATES_H__
+#define __RE_STATES_H__
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool statesMqttIsEnabled();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __RE_STATES_H__
@@ -0,0 +1,25 @@
+// Host build: WiFi station, the host is always connected
+#ifndef __RE_WIFI_H__
+#define __RE_WIFI_H__
+
+#include <stdint.h>
+#include "reEvents.h"
+
+typedef struct {
+  uint8_t bssid[6];
+  uint8_t ssid[33];
+  uint8_t primary;
+  int8_t rssi;
+} wifi_ap_record_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+wifi_ap_record_t wifiInfo();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __RE_WIFI_H__
@@ -0,0 +1,70 @@
+/*
+   EN: Deterministic network simulator for the host build: echo requests are answered according to the profiles
+       of the hosts (delay distribution, losses, burst losses, reordering, DNS delays) on the virtual clock
+   RU: Детерминированный симулятор сети для сборки на хосте: эхо-запросы обслуживаются согласно профилям
+       хостов (распределение задержки, потери, пакеты потерь, переупорядочивание, задержки DNS) на виртуальных часах
+*/
+
+#ifndef __SIMNET_H__
+#define __SIMNET_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SIM_HOSTS_MAX 32
+
+typedef enum {
+  SIM_DELAY_FIXED = 0,      // base
+  SIM_DELAY_UNIFORM,        // base .. base + spread
+  SIM_DELAY_NORMAL,         // base +/- spread (standard deviation), not less than zero
+  SIM_DELAY_PARETO          // base + heavy tail with the scale "spread" (alpha = 1.5)
+} sim_delay_t;
+
+typedef struct {
+  sim_delay_t delay;
+  uint32_t delay_base_us;
+  uint32_t delay_spread_us;
+  float loss;               // Probability of losing the request or the reply, 0..1
+  float burst_start;        // Burst losses (Gilbert-Elliott): probability of entering the burst state per packet
+  float burst_end;          // Probability of leaving the burst state per packet
+  float burst_loss;         // Probability of losing the packet in the burst state
+  float reorder;            // Probability of an additional delay of the reply
+  uint32_t reorder_us;
+  uint32_t dns_delay_us;    // Name resolution time
+  bool dns_fail;            // The name is not resolved
+  uint8_t ttl;
+} sim_host_profile_t;
+
+typedef struct {
+  uint64_t requests;
+  uint64_t replies;
+  uint64_t lost;
+  uint64_t reordered;
+  uint64_t dns_requests;
+  uint64_t dns_failed;
+} sim_net_stats_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Switches the shims to the virtual clock and the simulated network, all hosts and statistics are reset
+void simNetStart(uint64_t seed);
+void simNetStop();
+
+/**
+ * Add a host or change its profile. The name can be a literal address, otherwise the address 10.0.x.y is assigned.
+ * Requests to unknown addresses are lost
+ **/
+bool simNetHostSet(const char* name, const sim_host_profile_t* profile);
+
+// Random numbers of the simulator, 0..1
+double simNetRandom();
+
+void simNetGetStats(sim_net_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __SIMNET_H__
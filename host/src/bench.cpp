@@ -0,0 +1,292 @@
+/*
+   EN: Benchmark of the publishers of the check results: pinger_bench [iterations]
+       The payload formats are selected at compile time, so each format is a separate build of the library
+       (targets pinger_bench_*, all of them are run by the target "bench"). For each data set, one line of JSON is printed:
+       time per publication, heap allocations and allocated bytes per publication, peak transient heap, bytes emitted
+   RU: Замер публикации результатов проверки: pinger_bench [итерации]
+       Форматы выбираются при компиляции, поэтому каждый формат - отдельная сборка библиотеки (цели pinger_bench_*,
+       все они запускаются целью "bench"). Для каждого набора данных выводится одна строка JSON: время публикации,
+       число выделений и выделенные байты на публикацию, пиковый прирост кучи, отправлено байт
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <malloc.h>
+#include <atomic>
+#include "project_config.h"
+#include "rePinger.h"
+#include "host.h"
+#if CONFIG_MQTT_PINGER_ENABLE
+#include "rePingerMqtt.h"
+#endif // CONFIG_MQTT_PINGER_ENABLE
+#if CONFIG_OPENMON_ENABLE && CONFIG_OPENMON_PINGER_ENABLE
+#include "rePingerOM.h"
+#endif // CONFIG_OPENMON_ENABLE && CONFIG_OPENMON_PINGER_ENABLE
+
+// ------------------------------------------------------------------------------------------------------------------------
+// ---------------------------------------------------- Heap counters -----------------------------------------------------
+// ------------------------------------------------------------------------------------------------------------------------
+
+// The allocator of glibc is replaced by wrappers, so the allocations of libc itself (vasprintf, strdup) are counted too
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* ptr);
+}
+
+static std::atomic<uint64_t> _heapAllocs(0);
+static std::atomic<uint64_t> _heapBytes(0);
+static std::atomic<int64_t> _heapInUse(0);
+static std::atomic<int64_t> _heapPeak(0);
+
+static void* benchHeapAlloc(void* ptr)
+{
+  if (ptr) {
+    size_t size = malloc_usable_size(ptr);
+    _heapAllocs.fetch_add(1, std::memory_order_relaxed);
+    _heapBytes.fetch_add(size, std::memory_order_relaxed);
+    int64_t inuse = _heapInUse.fetch_add(size, std::memory_order_relaxed) + size;
+    int64_t peak = _heapPeak.load(std::memory_order_relaxed);
+    while ((inuse > peak) && !_heapPeak.compare_exchange_weak(peak, inuse, std::memory_order_relaxed)) {};
+  };
+  return ptr;
+}
+
+static void benchHeapFree(void* ptr)
+{
+  if (ptr) _heapInUse.fetch_sub(malloc_usable_size(ptr), std::memory_order_relaxed);
+}
+
+extern "C" {
+
+void* malloc(size_t size)
+{
+  return benchHeapAlloc(__libc_malloc(size));
+}
+
+void* calloc(size_t count, size_t size)
+{
+  return benchHeapAlloc(__libc_calloc(count, size));
+}
+
+void* realloc(void* ptr, size_t size)
+{
+  benchHeapFree(ptr);
+  return benchHeapAlloc(__libc_realloc(ptr, size));
+}
+
+void* aligned_alloc(size_t alignment, size_t size)
+{
+  return benchHeapAlloc(__libc_memalign(alignment, size));
+}
+
+int posix_memalign(void** memptr, size_t alignment, size_t size)
+{
+  *memptr = benchHeapAlloc(__libc_memalign(alignment, size));
+  return *memptr ? 0 : ENOMEM;
+}
+
+void free(void* ptr)
+{
+  benchHeapFree(ptr);
+  __libc_free(ptr);
+}
+
+}
+
+// ------------------------------------------------------------------------------------------------------------------------
+// ------------------------------------------------------- Sinks ----------------------------------------------------------
+// ------------------------------------------------------------------------------------------------------------------------
+
+static uint64_t _sinkMessages = 0;
+static uint64_t _sinkBytes = 0;
+
+static void benchSink(const char* topic, const char* payload, size_t size)
+{
+  _sinkMessages++;
+  _sinkBytes += size;
+}
+
+#if CONFIG_MQTT_PINGER_ENABLE && CONFIG_MQTT_PINGER_AS_CBOR
+static bool benchRawPublish(const char* topic, const uint8_t* payload, size_t size, int qos, bool retained)
+{
+  _sinkMessages++;
+  _sinkBytes += size;
+  return true;
+}
+#endif // CONFIG_MQTT_PINGER_AS_CBOR
+
+// ------------------------------------------------------------------------------------------------------------------------
+// ------------------------------------------------------ Data sets -------------------------------------------------------
+// ------------------------------------------------------------------------------------------------------------------------
+
+typedef enum {
+  BENCH_TYPICAL = 0,    // Three hosts, all available
+  BENCH_DEGRADED,       // Three hosts, one is unavailable, internet is slowed
+  BENCH_MAXIMUM,        // CONFIG_PINGER_HOSTS_MAX hosts
+  BENCH_SETS_COUNT
+} bench_set_t;
+
+static const char* _benchSetNames[BENCH_SETS_COUNT] = { "typical", "degraded", "maximum" };
+static char _benchHostNames[CONFIG_PINGER_HOSTS_MAX][32];
+
+// The values change from iteration to iteration, as they do in the real checks
+static void benchFillData(pinger_publish_data_t* data, bench_set_t set, uint32_t iteration)
+{
+  memset(data, 0, sizeof(pinger_publish_data_t));
+  data->hosts_count = set == BENCH_MAXIMUM ? CONFIG_PINGER_HOSTS_MAX : 3;
+  for (uint8_t i = 0; i < data->hosts_count; i++) {
+    ping_host_data_t* host = &data->hosts[i];
+    pinger_host_stats_t* stats = &data->hosts_stats[i];
+    bool down = (set == BENCH_DEGRADED) && (i == 1);
+    host->host_name = _benchHostNames[i];
+    host->host_addr.addr = htonl(0x0a000001 + i);
+    host->state = down ? PING_UNAVAILABLE : PING_OK;
+    host->transmitted = 10;
+    host->received = down ? 0 : 10 - (iteration + i) % 2;
+    host->loss = 100.0f * (host->transmitted - host->received) / host->transmitted;
+    host->duration_ms = down ? 0 : 15 + 7 * i + (iteration % 11);
+    host->total_time_ms = host->duration_ms * host->received;
+    host->ttl = down ? 0 : 56 + i;
+    host->time_unavailable = down ? 1700000000 : 0;
+    stats->duration_us = host->duration_ms * 1000 + (iteration % 997);
+    stats->rtt_p50_us = stats->duration_us - 500;
+    stats->rtt_p95_us = stats->duration_us + 4000;
+    stats->rtt_p99_us = stats->duration_us + 9000;
+    stats->rtt_mdev_us = 1200 + (iteration % 300);
+    stats->jitter_us = 800 + (iteration % 200);
+  };
+  data->inet.state = set == BENCH_DEGRADED ? PING_SLOWDOWN : PING_OK;
+  data->inet.hosts_count = data->hosts_count;
+  data->inet.hosts_available = set == BENCH_DEGRADED ? data->hosts_count - 1 : data->hosts_count;
+  data->inet.duration_ms_min = data->hosts[0].duration_ms;
+  data->inet.duration_ms_max = data->hosts[data->hosts_count - 1].duration_ms;
+  data->inet.duration_ms_total = (data->inet.duration_ms_min + data->inet.duration_ms_max) / 2;
+  data->inet.loss_min = 0.0f;
+  data->inet.loss_max = set == BENCH_DEGRADED ? 100.0f : 10.0f;
+  data->inet.loss_total = set == BENCH_DEGRADED ? 33.3f : 5.0f;
+  data->inet_stats.rtt_mdev_us = 1500 + (iteration % 300);
+  data->inet_stats.jitter_us = 900 + (iteration % 200);
+}
+
+// ------------------------------------------------------------------------------------------------------------------------
+// ------------------------------------------------------ Measuring -------------------------------------------------------
+// ------------------------------------------------------------------------------------------------------------------------
+
+static void benchPublish(pinger_publish_data_t* data)
+{
+  #if CONFIG_MQTT_PINGER_ENABLE
+    pingerMqttPublish(data);
+  #endif // CONFIG_MQTT_PINGER_ENABLE
+  #if CONFIG_OPENMON_ENABLE && CONFIG_OPENMON_PINGER_ENABLE
+    pingerOpenMonPublish(data);
+  #endif // CONFIG_OPENMON_ENABLE && CONFIG_OPENMON_PINGER_ENABLE
+}
+
+static void benchPathName(char* buf, size_t size)
+{
+  buf[0] = 0;
+  #if CONFIG_MQTT_PINGER_ENABLE
+    #if CONFIG_MQTT_PINGER_AS_PLAIN
+      strncat(buf, "+mqtt_plain", size - strlen(buf) - 1);
+    #endif // CONFIG_MQTT_PINGER_AS_PLAIN
+    #if CONFIG_MQTT_PINGER_AS_JSON
+      strncat(buf, "+mqtt_json", size - strlen(buf) - 1);
+    #endif // CONFIG_MQTT_PINGER_AS_JSON
+    #if CONFIG_MQTT_PINGER_AS_CBOR
+      strncat(buf, "+mqtt_cbor", size - strlen(buf) - 1);
+    #endif // CONFIG_MQTT_PINGER_AS_CBOR
+    #if CONFIG_MQTT_PINGER_DELTA
+      strncat(buf, "_delta", size - strlen(buf) - 1);
+    #endif // CONFIG_MQTT_PINGER_DELTA
+  #endif // CONFIG_MQTT_PINGER_ENABLE
+  #if CONFIG_OPENMON_ENABLE && CONFIG_OPENMON_PINGER_ENABLE
+    strncat(buf, "+openmon", size - strlen(buf) - 1);
+  #endif // CONFIG_OPENMON_ENABLE && CONFIG_OPENMON_PINGER_ENABLE
+  if (buf[0] == '+') memmove(buf, buf + 1, strlen(buf));
+}
+
+static int64_t benchNowNs()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// Allocations of the publishers during initialization and warming up, cumulative
+static uint64_t _initAllocs = 0;
+
+static void benchRun(const char* path, bench_set_t set, uint32_t iterations)
+{
+  pinger_publish_data_t data;
+  uint64_t init = _heapAllocs.load();
+
+  // Warming up: topics, buffers and caches of the publishers are created on the first publications
+  for (uint32_t i = 0; i < 16; i++) {
+    benchFillData(&data, set, i);
+    benchPublish(&data);
+  };
+  _initAllocs += _heapAllocs.load() - init;
+
+  _sinkMessages = 0;
+  _sinkBytes = 0;
+  uint64_t allocs = _heapAllocs.load();
+  uint64_t bytes = _heapBytes.load();
+  int64_t baseline = _heapInUse.load();
+  _heapPeak.store(baseline);
+  int64_t fillNs = 0;
+  int64_t started = benchNowNs();
+  for (uint32_t i = 0; i < iterations; i++) {
+    int64_t fill = benchNowNs();
+    benchFillData(&data, set, i);
+    fillNs += benchNowNs() - fill;
+    benchPublish(&data);
+  };
+  int64_t elapsed = benchNowNs() - started - fillNs;
+
+  printf("{\"path\":\"%s\",\"data\":\"%s\",\"hosts\":%u,\"iterations\":%u,\"ns_per_op\":%.1f,"
+         "\"allocs_per_op\":%.2f,\"alloc_bytes_per_op\":%.1f,\"peak_heap_bytes\":%lld,\"init_allocs\":%llu,"
+         "\"messages_per_op\":%.2f,\"bytes_per_op\":%.1f}\n",
+    path, _benchSetNames[set], data.hosts_count, iterations, (double)elapsed / iterations,
+    (double)(_heapAllocs.load() - allocs) / iterations, (double)(_heapBytes.load() - bytes) / iterations,
+    (long long)(_heapPeak.load() - baseline), (unsigned long long)_initAllocs,
+    (double)_sinkMessages / iterations, (double)_sinkBytes / iterations);
+}
+
+int main(int argc, char* argv[])
+{
+  uint32_t iterations = argc > 1 ? strtoul(argv[1], nullptr, 0) : 100000;
+  if (iterations == 0) iterations = 1;
+  hostLogSetLevel(0);
+  hostOutputSetSink(benchSink);
+  for (uint8_t i = 0; i < CONFIG_PINGER_HOSTS_MAX; i++) {
+    snprintf(_benchHostNames[i], sizeof(_benchHostNames[i]), "host%u.example.com", i + 1);
+  };
+
+  uint64_t init = _heapAllocs.load();
+  #if CONFIG_MQTT_PINGER_ENABLE
+    #if CONFIG_MQTT_PINGER_AS_CBOR
+      pingerMqttSetRawPublisher(benchRawPublish);
+    #endif // CONFIG_MQTT_PINGER_AS_CBOR
+    mqttTopicPingerCreate(true);
+  #endif // CONFIG_MQTT_PINGER_ENABLE
+  #if CONFIG_OPENMON_ENABLE && CONFIG_OPENMON_PINGER_ENABLE
+    pingerOpenMonInit();
+  #endif // CONFIG_OPENMON_ENABLE && CONFIG_OPENMON_PINGER_ENABLE
+
+  _initAllocs = _heapAllocs.load() - init;
+  char path[64];
+  benchPathName(path, sizeof(path));
+  for (uint8_t set = 0; set < BENCH_SETS_COUNT; set++) {
+    benchRun(path, (bench_set_t)set, iterations);
+  };
+
+  #if CONFIG_MQTT_PINGER_ENABLE
+    mqttTopicPingerFree();
+  #endif // CONFIG_MQTT_PINGER_ENABLE
+  return EXIT_SUCCESS;
+}
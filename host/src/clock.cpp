@@ -0,0 +1,102 @@
+/*
+   EN: Real and virtual clock of the host build
+   RU: Реальные и виртуальные часы сборки на хосте
+*/
+
+#include <time.h>
+#include <stdint.h>
+#include "host.h"
+
+#define HOST_TIMERS_MAX 64
+
+typedef struct {
+  int64_t time_us;
+  host_timer_cb_t callback;
+  void* arg;
+} host_timer_t;
+
+static bool _clockVirtual = false;
+static int64_t _clockVirtualNow = 0;
+static host_timer_t _timers[HOST_TIMERS_MAX];
+static int _timersCount = 0;
+
+static int64_t hostClockMonotonic()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+void hostClockSetVirtual(bool enabled)
+{
+  _clockVirtual = enabled;
+  _clockVirtualNow = 0;
+  _timersCount = 0;
+}
+
+bool hostClockIsVirtual()
+{
+  return _clockVirtual;
+}
+
+int64_t hostClockNow()
+{
+  if (_clockVirtual) return _clockVirtualNow;
+  static const int64_t start = hostClockMonotonic();
+  return hostClockMonotonic() - start;
+}
+
+bool hostClockSchedule(int64_t time_us, host_timer_cb_t callback, void* arg)
+{
+  if (_timersCount >= HOST_TIMERS_MAX) return false;
+  _timers[_timersCount].time_us = time_us;
+  _timers[_timersCount].callback = callback;
+  _timers[_timersCount].arg = arg;
+  _timersCount++;
+  return true;
+}
+
+static int hostClockFirstTimer()
+{
+  int first = -1;
+  for (int i = 0; i < _timersCount; i++) {
+    if ((first < 0) || (_timers[i].time_us < _timers[first].time_us)) first = i;
+  };
+  return first;
+}
+
+int64_t hostClockNextTimer()
+{
+  int first = hostClockFirstTimer();
+  return first < 0 ? INT64_MAX : _timers[first].time_us;
+}
+
+// Timers are called in the order of time, a timer may schedule new ones
+void hostClockAdvanceTo(int64_t time_us)
+{
+  if (!_clockVirtual) return;
+  while (1) {
+    int first = hostClockFirstTimer();
+    if ((first < 0) || (_timers[first].time_us > time_us)) break;
+    host_timer_t timer = _timers[first];
+    _timers[first] = _timers[--_timersCount];
+    if (timer.time_us > _clockVirtualNow) _clockVirtualNow = timer.time_us;
+    timer.callback(timer.arg);
+  };
+  if (time_us > _clockVirtualNow) _clockVirtualNow = time_us;
+}
+
+bool hostClockWait(int64_t timeout_us, bool (*ready)(void* arg), void* arg)
+{
+  int64_t deadline = timeout_us < 0 ? INT64_MAX : _clockVirtualNow + timeout_us;
+  while (!ready(arg)) {
+    int64_t next = hostClockNextTimer();
+    if (next > deadline) {
+      // Nothing can happen until the deadline
+      if (deadline != INT64_MAX) hostClockAdvanceTo(deadline);
+      return ready(arg);
+    };
+    hostClockAdvanceTo(next);
+  };
+  return true;
+}
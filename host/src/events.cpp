@@ -0,0 +1,74 @@
+/*
+   EN: Event loop: events are delivered to the handlers in the calling thread, in the order of registration
+   RU: Цикл событий: события доставляются обработчикам в вызывающем потоке, в порядке регистрации
+*/
+
+#include <string.h>
+#include <pthread.h>
+#include "rLog.h"
+#include "reEvents.h"
+
+esp_event_base_t const RE_SYSTEM_EVENTS = "RE_SYSTEM_EVENTS";
+esp_event_base_t const RE_WIFI_EVENTS = "RE_WIFI_EVENTS";
+esp_event_base_t const RE_MQTT_EVENTS = "RE_MQTT_EVENTS";
+esp_event_base_t const RE_PING_EVENTS = "RE_PING_EVENTS";
+
+#define HOST_EVENT_HANDLERS_MAX 32
+
+typedef struct {
+  esp_event_base_t event_base;
+  int32_t event_id;
+  esp_event_handler_t event_handler;
+  void* event_handler_arg;
+} host_event_handler_t;
+
+static host_event_handler_t _handlers[HOST_EVENT_HANDLERS_MAX];
+static int _handlersCount = 0;
+static pthread_mutex_t _handlersLock = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+
+bool eventHandlerRegister(esp_event_base_t event_base, int32_t event_id, esp_event_handler_t event_handler, void* event_handler_arg)
+{
+  pthread_mutex_lock(&_handlersLock);
+  bool ret = _handlersCount < HOST_EVENT_HANDLERS_MAX;
+  if (ret) {
+    _handlers[_handlersCount].event_base = event_base;
+    _handlers[_handlersCount].event_id = event_id;
+    _handlers[_handlersCount].event_handler = event_handler;
+    _handlers[_handlersCount].event_handler_arg = event_handler_arg;
+    _handlersCount++;
+  };
+  pthread_mutex_unlock(&_handlersLock);
+  return ret;
+}
+
+bool eventHandlerUnregister(esp_event_base_t event_base, int32_t event_id, esp_event_handler_t event_handler)
+{
+  pthread_mutex_lock(&_handlersLock);
+  for (int i = 0; i < _handlersCount; i++) {
+    if ((_handlers[i].event_base == event_base) && (_handlers[i].event_id == event_id) && (_handlers[i].event_handler == event_handler)) {
+      memmove(&_handlers[i], &_handlers[i + 1], (_handlersCount - i - 1) * sizeof(host_event_handler_t));
+      _handlersCount--;
+      break;
+    };
+  };
+  pthread_mutex_unlock(&_handlersLock);
+  return true;
+}
+
+bool eventLoopPost(esp_event_base_t event_base, int32_t event_id, void* event_data, size_t event_data_size, TickType_t ticks_to_wait)
+{
+  pthread_mutex_lock(&_handlersLock);
+  for (int i = 0; i < _handlersCount; i++) {
+    if ((_handlers[i].event_base == event_base) && ((_handlers[i].event_id == ESP_EVENT_ANY_ID) || (_handlers[i].event_id == event_id))) {
+      _handlers[i].event_handler(_handlers[i].event_handler_arg, event_base, event_id, event_data);
+    };
+  };
+  pthread_mutex_unlock(&_handlersLock);
+  return true;
+}
+
+bool eventLoopPostError(int32_t event_id, esp_err_t err)
+{
+  rlog_e("EVENTS", "System error %d: %s", event_id, esp_err_to_name(err));
+  return eventLoopPost(RE_SYSTEM_EVENTS, event_id, &err, sizeof(err), portMAX_DELAY);
+}
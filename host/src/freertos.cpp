@@ -0,0 +1,431 @@
+/*
+   EN: FreeRTOS tasks, notifications and semaphores on POSIX threads
+   RU: Задачи, уведомления и семафоры FreeRTOS на потоках POSIX
+*/
+
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "host.h"
+
+struct host_task_t {
+  host_task_t* next;
+  pthread_t thread;
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  TaskFunction_t function;
+  void* parameters;
+  uint8_t* stack;
+  size_t stack_size;
+  char name[16];
+  uint32_t notify_value;
+  bool notify_pending;
+  bool suspended;
+  bool deleted;
+  bool blocked;
+};
+
+struct host_semaphore_t {
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  bool mutex;
+  bool given;
+};
+
+static thread_local host_task_t* _currentTask = nullptr;
+static host_task_t _mainTask = { };
+
+// Handles of the deleted tasks remain valid, eTaskGetState() returns eDeleted for them
+static host_task_t* _tasks = nullptr;
+static pthread_mutex_t _tasksLock = PTHREAD_MUTEX_INITIALIZER;
+
+// Stacks of the tasks are filled with a pattern for uxTaskGetStackHighWaterMark(). Functions of glibc need much more
+// stack than those of newlib, so the stack is not smaller than HOST_TASK_STACK_MIN, and the mark is only comparable between runs
+#define HOST_TASK_STACK_MIN (256 * 1024)
+#define HOST_TASK_STACK_FILL 0xA5
+
+// ------------------------------------------------------------------------------------------------------------------------
+// ------------------------------------------------------- Time -----------------------------------------------------------
+// ------------------------------------------------------------------------------------------------------------------------
+
+static struct timespec hostNow()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts;
+}
+
+static struct timespec hostDeadline(TickType_t ticks)
+{
+  struct timespec ts = hostNow();
+  ts.tv_sec += ticks / configTICK_RATE_HZ;
+  ts.tv_nsec += (long)(ticks % configTICK_RATE_HZ) * (1000000000L / configTICK_RATE_HZ);
+  if (ts.tv_nsec >= 1000000000L) {
+    ts.tv_sec++;
+    ts.tv_nsec -= 1000000000L;
+  };
+  return ts;
+}
+
+static void hostCondInit(pthread_mutex_t* lock, pthread_cond_t* cond)
+{
+  pthread_condattr_t attr;
+  pthread_condattr_init(&attr);
+  pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+  pthread_cond_init(cond, &attr);
+  pthread_condattr_destroy(&attr);
+  pthread_mutex_init(lock, nullptr);
+}
+
+// Waiting on the condition with the lock held, returns false on timeout
+static bool hostCondWait(pthread_cond_t* cond, pthread_mutex_t* lock, TickType_t ticks, const struct timespec* deadline)
+{
+  if (ticks == portMAX_DELAY) {
+    pthread_cond_wait(cond, lock);
+    return true;
+  };
+  return pthread_cond_timedwait(cond, lock, deadline) != ETIMEDOUT;
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+  return (TickType_t)(hostClockNow() / (1000000 / configTICK_RATE_HZ));
+}
+
+// On the virtual clock the wait does not block, the clock is advanced instead
+static int64_t hostVirtualTimeout(TickType_t ticks)
+{
+  return ticks == portMAX_DELAY ? -1 : (int64_t)ticks * (1000000 / configTICK_RATE_HZ);
+}
+
+static bool hostVirtualNever(void* arg)
+{
+  return false;
+}
+
+// ------------------------------------------------------------------------------------------------------------------------
+// ------------------------------------------------------- Tasks ----------------------------------------------------------
+// ------------------------------------------------------------------------------------------------------------------------
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+  if (!_currentTask) {
+    // Threads not created by xTaskCreate() share one handle, as the main task
+    static pthread_once_t once = PTHREAD_ONCE_INIT;
+    pthread_once(&once, [] { hostCondInit(&_mainTask.lock, &_mainTask.cond); strcpy(_mainTask.name, "main"); });
+    _currentTask = &_mainTask;
+  };
+  return _currentTask;
+}
+
+// The task is deleted at the next blocking call, the thread is terminated
+static void hostTaskCheckDeleted(host_task_t* task)
+{
+  if (task->deleted) {
+    pthread_mutex_unlock(&task->lock);
+    pthread_exit(nullptr);
+  };
+}
+
+// Suspended task is stopped at the next blocking call until vTaskResume()
+static void hostTaskCheckSuspended(host_task_t* task)
+{
+  while (task->suspended && !task->deleted) {
+    pthread_cond_wait(&task->cond, &task->lock);
+  };
+  hostTaskCheckDeleted(task);
+}
+
+static void* hostTaskThread(void* arg)
+{
+  host_task_t* task = (host_task_t*)arg;
+  _currentTask = task;
+  pthread_setname_np(pthread_self(), task->name);
+  task->function(task->parameters);
+  return nullptr;
+}
+
+static TaskHandle_t hostTaskCreate(TaskFunction_t pvTaskCode, const char* pcName, uint32_t stackDepth, void* pvParameters)
+{
+  host_task_t* task = (host_task_t*)calloc(1, sizeof(host_task_t));
+  if (!task) return nullptr;
+  hostCondInit(&task->lock, &task->cond);
+  task->function = pvTaskCode;
+  task->parameters = pvParameters;
+  strncpy(task->name, pcName ? pcName : "task", sizeof(task->name) - 1);
+  task->stack_size = stackDepth > HOST_TASK_STACK_MIN ? (stackDepth + 4095) & ~(size_t)4095 : HOST_TASK_STACK_MIN;
+  task->stack = (uint8_t*)aligned_alloc(4096, task->stack_size);
+  if (!task->stack) {
+    free(task);
+    return nullptr;
+  };
+  memset(task->stack, HOST_TASK_STACK_FILL, task->stack_size);
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setstack(&attr, task->stack, task->stack_size);
+  int created = pthread_create(&task->thread, &attr, hostTaskThread, task);
+  pthread_attr_destroy(&attr);
+  if (created != 0) {
+    free(task->stack);
+    free(task);
+    return nullptr;
+  };
+  pthread_detach(task->thread);
+  pthread_mutex_lock(&_tasksLock);
+  task->next = _tasks;
+  _tasks = task;
+  pthread_mutex_unlock(&_tasksLock);
+  return task;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t pvTaskCode, const char* pcName, uint32_t usStackDepth, void* pvParameters,
+  UBaseType_t uxPriority, TaskHandle_t* pvCreatedTask, BaseType_t xCoreID)
+{
+  TaskHandle_t task = hostTaskCreate(pvTaskCode, pcName, usStackDepth, pvParameters);
+  if (pvCreatedTask) *pvCreatedTask = task;
+  return task ? pdPASS : pdFAIL;
+}
+
+TaskHandle_t xTaskCreateStaticPinnedToCore(TaskFunction_t pvTaskCode, const char* pcName, uint32_t ulStackDepth, void* pvParameters,
+  UBaseType_t uxPriority, StackType_t* pxStackBuffer, StaticTask_t* pxTaskBuffer, BaseType_t xCoreID)
+{
+  return hostTaskCreate(pvTaskCode, pcName, ulStackDepth, pvParameters);
+}
+
+void vTaskDelete(TaskHandle_t xTaskToDelete)
+{
+  host_task_t* task = xTaskToDelete ? xTaskToDelete : xTaskGetCurrentTaskHandle();
+  pthread_mutex_lock(&task->lock);
+  task->deleted = true;
+  pthread_cond_broadcast(&task->cond);
+  if (task == _currentTask) {
+    hostTaskCheckDeleted(task);
+  };
+  pthread_mutex_unlock(&task->lock);
+}
+
+void vTaskSuspend(TaskHandle_t xTaskToSuspend)
+{
+  host_task_t* task = xTaskToSuspend ? xTaskToSuspend : xTaskGetCurrentTaskHandle();
+  pthread_mutex_lock(&task->lock);
+  task->suspended = true;
+  pthread_cond_broadcast(&task->cond);
+  if (task == _currentTask) {
+    hostTaskCheckSuspended(task);
+  };
+  pthread_mutex_unlock(&task->lock);
+}
+
+void vTaskResume(TaskHandle_t xTaskToResume)
+{
+  if (!xTaskToResume) return;
+  pthread_mutex_lock(&xTaskToResume->lock);
+  xTaskToResume->suspended = false;
+  pthread_cond_broadcast(&xTaskToResume->cond);
+  pthread_mutex_unlock(&xTaskToResume->lock);
+}
+
+eTaskState eTaskGetState(TaskHandle_t xTask)
+{
+  if (!xTask) return eInvalid;
+  eTaskState state;
+  pthread_mutex_lock(&xTask->lock);
+  if (xTask->deleted) {
+    state = eDeleted;
+  } else if (xTask->suspended) {
+    state = eSuspended;
+  } else if (xTask == _currentTask) {
+    state = eRunning;
+  } else {
+    state = xTask->blocked ? eBlocked : eReady;
+  };
+  pthread_mutex_unlock(&xTask->lock);
+  return state;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t xTask)
+{
+  // The stack grows down, the untouched part remains at the beginning of the buffer. Unknown for the main thread
+  host_task_t* task = xTask ? xTask : xTaskGetCurrentTaskHandle();
+  if (!task->stack) return 0;
+  size_t untouched = 0;
+  while ((untouched < task->stack_size) && (task->stack[untouched] == HOST_TASK_STACK_FILL)) {
+    untouched++;
+  };
+  return (UBaseType_t)untouched;
+}
+
+void vTaskDelay(TickType_t xTicksToDelay)
+{
+  if (hostClockIsVirtual()) {
+    hostClockWait(hostVirtualTimeout(xTicksToDelay), hostVirtualNever, nullptr);
+    return;
+  };
+  host_task_t* task = xTaskGetCurrentTaskHandle();
+  struct timespec deadline = hostDeadline(xTicksToDelay);
+  pthread_mutex_lock(&task->lock);
+  hostTaskCheckSuspended(task);
+  task->blocked = true;
+  while (hostCondWait(&task->cond, &task->lock, xTicksToDelay, &deadline)) {
+    hostTaskCheckSuspended(task);
+  };
+  task->blocked = false;
+  pthread_mutex_unlock(&task->lock);
+}
+
+// ------------------------------------------------------------------------------------------------------------------------
+// --------------------------------------------------- Notifications ------------------------------------------------------
+// ------------------------------------------------------------------------------------------------------------------------
+
+BaseType_t xTaskNotify(TaskHandle_t xTaskToNotify, uint32_t ulValue, eNotifyAction eAction)
+{
+  if (!xTaskToNotify) return pdFAIL;
+  BaseType_t ret = pdPASS;
+  pthread_mutex_lock(&xTaskToNotify->lock);
+  switch (eAction) {
+    case eSetBits:
+      xTaskToNotify->notify_value |= ulValue;
+      break;
+    case eIncrement:
+      xTaskToNotify->notify_value++;
+      break;
+    case eSetValueWithOverwrite:
+      xTaskToNotify->notify_value = ulValue;
+      break;
+    case eSetValueWithoutOverwrite:
+      if (xTaskToNotify->notify_pending) {
+        ret = pdFAIL;
+      } else {
+        xTaskToNotify->notify_value = ulValue;
+      };
+      break;
+    default:
+      break;
+  };
+  xTaskToNotify->notify_pending = true;
+  pthread_cond_broadcast(&xTaskToNotify->cond);
+  pthread_mutex_unlock(&xTaskToNotify->lock);
+  return ret;
+}
+
+static bool hostNotifyPending(void* arg)
+{
+  return ((host_task_t*)arg)->notify_pending;
+}
+
+BaseType_t xTaskNotifyWait(uint32_t ulBitsToClearOnEntry, uint32_t ulBitsToClearOnExit, uint32_t* pulNotificationValue, TickType_t xTicksToWait)
+{
+  host_task_t* task = xTaskGetCurrentTaskHandle();
+  struct timespec deadline = hostDeadline(xTicksToWait);
+  BaseType_t ret = pdFALSE;
+  pthread_mutex_lock(&task->lock);
+  hostTaskCheckSuspended(task);
+  if (!task->notify_pending) {
+    task->notify_value &= ~ulBitsToClearOnEntry;
+  };
+  if (hostClockIsVirtual()) {
+    // Notifications can only come from the timers
+    pthread_mutex_unlock(&task->lock);
+    hostClockWait(hostVirtualTimeout(xTicksToWait), hostNotifyPending, task);
+    pthread_mutex_lock(&task->lock);
+    xTicksToWait = 0;
+  };
+  task->blocked = true;
+  while (!task->notify_pending && (xTicksToWait > 0)) {
+    bool signaled = hostCondWait(&task->cond, &task->lock, xTicksToWait, &deadline);
+    hostTaskCheckSuspended(task);
+    if (!signaled) break;
+  };
+  task->blocked = false;
+  if (pulNotificationValue) *pulNotificationValue = task->notify_value;
+  if (task->notify_pending) {
+    task->notify_value &= ~ulBitsToClearOnExit;
+    task->notify_pending = false;
+    ret = pdTRUE;
+  };
+  pthread_mutex_unlock(&task->lock);
+  return ret;
+}
+
+// ------------------------------------------------------------------------------------------------------------------------
+// ---------------------------------------------------- Semaphores --------------------------------------------------------
+// ------------------------------------------------------------------------------------------------------------------------
+
+static SemaphoreHandle_t hostSemaphoreCreate(bool mutex)
+{
+  host_semaphore_t* sem = (host_semaphore_t*)calloc(1, sizeof(host_semaphore_t));
+  if (!sem) return nullptr;
+  hostCondInit(&sem->lock, &sem->cond);
+  sem->mutex = mutex;
+  // The mutex is created free, the binary semaphore is created taken
+  sem->given = mutex;
+  return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+  return hostSemaphoreCreate(false);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+  return hostSemaphoreCreate(true);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t* pxSemaphoreBuffer)
+{
+  return hostSemaphoreCreate(false);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t* pxMutexBuffer)
+{
+  return hostSemaphoreCreate(true);
+}
+
+static bool hostSemaphoreGiven(void* arg)
+{
+  return ((host_semaphore_t*)arg)->given;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xBlockTime)
+{
+  if (!xSemaphore) return pdFALSE;
+  if (hostClockIsVirtual()) {
+    hostClockWait(hostVirtualTimeout(xBlockTime), hostSemaphoreGiven, xSemaphore);
+    xBlockTime = 0;
+  };
+  struct timespec deadline = hostDeadline(xBlockTime);
+  pthread_mutex_lock(&xSemaphore->lock);
+  while (!xSemaphore->given && (xBlockTime > 0)) {
+    if (!hostCondWait(&xSemaphore->cond, &xSemaphore->lock, xBlockTime, &deadline)) break;
+  };
+  BaseType_t ret = xSemaphore->given ? pdTRUE : pdFALSE;
+  xSemaphore->given = false;
+  pthread_mutex_unlock(&xSemaphore->lock);
+  return ret;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore)
+{
+  if (!xSemaphore) return pdFALSE;
+  pthread_mutex_lock(&xSemaphore->lock);
+  BaseType_t ret = xSemaphore->given ? pdFALSE : pdTRUE;
+  xSemaphore->given = true;
+  pthread_cond_signal(&xSemaphore->cond);
+  pthread_mutex_unlock(&xSemaphore->lock);
+  return ret;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t xSemaphore)
+{
+  if (xSemaphore) {
+    pthread_cond_destroy(&xSemaphore->cond);
+    pthread_mutex_destroy(&xSemaphore->lock);
+    free(xSemaphore);
+  };
+}
@@ -0,0 +1,347 @@
+/*
+   EN: lwIP sockets, checksum and resolver on top of Linux sockets
+   RU: Сокеты, контрольная сумма и DNS lwIP поверх сокетов Linux
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/uio.h>
+#include <sys/epoll.h>
+#include "lwip/lwip_host.h"
+#include "host.h"
+
+#ifndef ICMP_FILTER
+#define ICMP_FILTER 1
+#endif // ICMP_FILTER
+
+// Unprivileged ICMP sockets, the kernel replaces the identifier with the local "port" and removes the IP header.
+// One lwIP socket serves the requests with different identifiers, so it is an epoll instance over a kernel socket 
+// for each identifier
+#define HOST_SOCKETS_MAX 1024
+#define HOST_SOCKET_IDS 32
+
+typedef struct {
+  int fd;
+  bool bound;
+  u16_t id;
+} host_socket_id_t;
+
+typedef struct {
+  bool dgram;
+  uint8_t count;
+  host_socket_id_t ids[HOST_SOCKET_IDS];
+} host_socket_t;
+
+static host_socket_t _sockets[HOST_SOCKETS_MAX];
+
+// ------------------------------------------------------------------------------------------------------------------------
+// ----------------------------------------------------- Addresses --------------------------------------------------------
+// ------------------------------------------------------------------------------------------------------------------------
+
+char* ipaddr_ntoa_r(const ip_addr_t* addr, char* buf, int buflen)
+{
+  struct in_addr in;
+  in.s_addr = addr ? addr->addr : 0;
+  if (!inet_ntop(AF_INET, &in, buf, buflen)) return nullptr;
+  return buf;
+}
+
+char* ipaddr_ntoa(const ip_addr_t* addr)
+{
+  static thread_local char buf[INET_ADDRSTRLEN];
+  return ipaddr_ntoa_r(addr, buf, sizeof(buf));
+}
+
+int ipaddr_aton(const char* cp, ip_addr_t* addr)
+{
+  struct in_addr in;
+  if (inet_pton(AF_INET, cp, &in) != 1) return 0;
+  if (addr) addr->addr = in.s_addr;
+  return 1;
+}
+
+u16_t inet_chksum(const void* dataptr, u16_t len)
+{
+  const u8_t* data = (const u8_t*)dataptr;
+  u32_t sum = 0;
+  while (len > 1) {
+    u16_t word;
+    memcpy(&word, data, sizeof(word));
+    sum += word;
+    data += 2;
+    len -= 2;
+  };
+  if (len > 0) {
+    u16_t word = 0;
+    memcpy(&word, data, 1);
+    sum += word;
+  };
+  while (sum >> 16) {
+    sum = (sum & 0xffff) + (sum >> 16);
+  };
+  return (u16_t)~sum;
+}
+
+// ------------------------------------------------------------------------------------------------------------------------
+// ------------------------------------------------------ Resolver --------------------------------------------------------
+// ------------------------------------------------------------------------------------------------------------------------
+
+typedef struct {
+  char* hostname;
+  dns_found_callback found;
+  void* callback_arg;
+} host_dns_request_t;
+
+// The callback is called from the resolver thread, as lwIP calls it from the TCP/IP task
+static void* hostDnsThread(void* arg)
+{
+  host_dns_request_t* request = (host_dns_request_t*)arg;
+  struct addrinfo hints;
+  struct addrinfo* res = nullptr;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  if ((getaddrinfo(request->hostname, nullptr, &hints, &res) == 0) && res) {
+    ip_addr_t addr;
+    inet_addr_to_ip4addr(&addr, &((struct sockaddr_in*)res->ai_addr)->sin_addr);
+    freeaddrinfo(res);
+    request->found(request->hostname, &addr, request->callback_arg);
+  } else {
+    request->found(request->hostname, nullptr, request->callback_arg);
+  };
+  free(request->hostname);
+  free(request);
+  return nullptr;
+}
+
+static err_t hostLinuxGetHostByName(const char* hostname, ip_addr_t* addr, dns_found_callback found, void* callback_arg)
+{
+  host_dns_request_t* request = (host_dns_request_t*)calloc(1, sizeof(host_dns_request_t));
+  if (!request) return ERR_MEM;
+  request->hostname = strdup(hostname);
+  request->found = found;
+  request->callback_arg = callback_arg;
+  pthread_t thread;
+  if (!request->hostname || (pthread_create(&thread, nullptr, hostDnsThread, request) != 0)) {
+    free(request->hostname);
+    free(request);
+    return ERR_MEM;
+  };
+  pthread_detach(thread);
+  return ERR_INPROGRESS;
+}
+
+// ------------------------------------------------------------------------------------------------------------------------
+// ------------------------------------------------------- Sockets --------------------------------------------------------
+// ------------------------------------------------------------------------------------------------------------------------
+
+// Kernel socket for the identifier of the request, it is created at the first request
+static host_socket_id_t* hostLinuxSocketId(int s, u16_t id)
+{
+  host_socket_t* hs = &_sockets[s];
+  for (uint8_t i = 0; i < hs->count; i++) {
+    if (hs->ids[i].id == id) return &hs->ids[i];
+  };
+  if (hs->count >= HOST_SOCKET_IDS) {
+    errno = ENOBUFS;
+    return nullptr;
+  };
+  int fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_ICMP);
+  if (fd < 0) return nullptr;
+  int on = 1;
+  setsockopt(fd, IPPROTO_IP, IP_RECVTTL, &on, sizeof(on));
+  host_socket_id_t* sid = &hs->ids[hs->count];
+  sid->fd = fd;
+  sid->id = id;
+  // The identifier is the local "port", it is kept as is, in the byte order of the packet
+  struct sockaddr_in local;
+  memset(&local, 0, sizeof(local));
+  local.sin_family = AF_INET;
+  local.sin_port = id;
+  sid->bound = bind(fd, (struct sockaddr*)&local, sizeof(local)) == 0;
+  struct epoll_event event;
+  memset(&event, 0, sizeof(event));
+  event.events = EPOLLIN;
+  event.data.u32 = hs->count;
+  if (epoll_ctl(s, EPOLL_CTL_ADD, fd, &event) != 0) {
+    close(fd);
+    return nullptr;
+  };
+  hs->count++;
+  return sid;
+}
+
+static int hostLinuxSocket(int domain, int type, int protocol)
+{
+  int s = socket(domain, type, protocol);
+  if ((s < 0) && (type == SOCK_RAW) && (domain == AF_INET) && (protocol == IP_PROTO_ICMP) && ((errno == EPERM) || (errno == EACCES))) {
+    // No CAP_NET_RAW: unprivileged ICMP sockets, if they are allowed
+    s = socket(domain, SOCK_DGRAM, protocol);
+    if (s < 0) return s;
+    close(s);
+    s = epoll_create1(0);
+    if ((s >= 0) && (s < HOST_SOCKETS_MAX)) {
+      memset(&_sockets[s], 0, sizeof(host_socket_t));
+      _sockets[s].dgram = true;
+      return s;
+    };
+  } else if ((s >= 0) && (type == SOCK_RAW) && (protocol == IP_PROTO_ICMP)) {
+    // The raw socket also receives outgoing requests to the local addresses, lwIP does not pass them
+    uint32_t filter = ~(1U << ICMP_ER);
+    setsockopt(s, SOL_RAW, ICMP_FILTER, &filter, sizeof(filter));
+  };
+  if ((s >= 0) && (s < HOST_SOCKETS_MAX)) {
+    memset(&_sockets[s], 0, sizeof(host_socket_t));
+  };
+  return s;
+}
+
+static int hostLinuxClose(int s)
+{
+  if ((s >= 0) && (s < HOST_SOCKETS_MAX)) {
+    for (uint8_t i = 0; i < _sockets[s].count; i++) {
+      close(_sockets[s].ids[i].fd);
+    };
+    memset(&_sockets[s], 0, sizeof(host_socket_t));
+  };
+  return close(s);
+}
+
+static ssize_t hostLinuxSendTo(int s, const void* dataptr, size_t size, int flags, const struct sockaddr* to, socklen_t tolen)
+{
+  if ((s >= 0) && (s < HOST_SOCKETS_MAX) && _sockets[s].dgram) {
+    if (size < sizeof(struct icmp_echo_hdr)) {
+      errno = EINVAL;
+      return -1;
+    };
+    host_socket_id_t* sid = hostLinuxSocketId(s, ((const struct icmp_echo_hdr*)dataptr)->id);
+    if (!sid) return -1;
+    if (tolen > sizeof(struct sockaddr_in)) tolen = sizeof(struct sockaddr_in);
+    return sendto(sid->fd, dataptr, size, flags, to, tolen);
+  };
+  return sendto(s, dataptr, size, flags, to, tolen);
+}
+
+static ssize_t hostLinuxRecvFrom(int s, void* mem, size_t len, int flags, struct sockaddr* from, socklen_t* fromlen)
+{
+  if ((s < 0) || (s >= HOST_SOCKETS_MAX) || !_sockets[s].dgram) {
+    return recvfrom(s, mem, len, flags, from, fromlen);
+  };
+
+  // The kernel returns the ICMP message only, the IP header is restored in front of it
+  host_socket_t* hs = &_sockets[s];
+  if (len < sizeof(struct ip_hdr)) {
+    errno = EINVAL;
+    return -1;
+  };
+  struct epoll_event event;
+  int ready = epoll_wait(s, &event, 1, (flags & MSG_DONTWAIT) ? 0 : -1);
+  if (ready <= 0) {
+    if (ready == 0) errno = EAGAIN;
+    return -1;
+  };
+  host_socket_id_t* sid = &hs->ids[event.data.u32];
+  struct ip_hdr* iphdr = (struct ip_hdr*)mem;
+  char control[64];
+  struct iovec iov;
+  iov.iov_base = (u8_t*)mem + sizeof(struct ip_hdr);
+  iov.iov_len = len - sizeof(struct ip_hdr);
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_name = from;
+  msg.msg_namelen = fromlen ? *fromlen : 0;
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+  ssize_t received = recvmsg(sid->fd, &msg, flags | MSG_DONTWAIT);
+  if (received < 0) return received;
+  if (fromlen) *fromlen = msg.msg_namelen;
+
+  memset(iphdr, 0, sizeof(struct ip_hdr));
+  iphdr->_v_hl = (4 << 4) | (sizeof(struct ip_hdr) / 4);
+  iphdr->_len = htons((u16_t)(sizeof(struct ip_hdr) + received));
+  iphdr->_proto = IP_PROTO_ICMP;
+  iphdr->_ttl = 64;
+  for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+    if ((cmsg->cmsg_level == IPPROTO_IP) && (cmsg->cmsg_type == IP_TTL)) {
+      int ttl;
+      memcpy(&ttl, CMSG_DATA(cmsg), sizeof(ttl));
+      iphdr->_ttl = (u8_t)ttl;
+    };
+  };
+  if (from && (from->sa_family == AF_INET)) {
+    inet_addr_to_ip4addr(&iphdr->src, &((struct sockaddr_in*)from)->sin_addr);
+  };
+  // If the identifier could not be bound, the socket receives only its own replies anyway
+  if (!sid->bound && (received >= (ssize_t)sizeof(struct icmp_echo_hdr))) {
+    ((struct icmp_echo_hdr*)iov.iov_base)->id = sid->id;
+  };
+  return (ssize_t)sizeof(struct ip_hdr) + received;
+}
+
+// ------------------------------------------------------------------------------------------------------------------------
+// ------------------------------------------------------- Backend --------------------------------------------------------
+// ------------------------------------------------------------------------------------------------------------------------
+
+static const host_net_backend_t _linuxBackend = {
+  .socket = hostLinuxSocket,
+  .close = hostLinuxClose,
+  .sendto = hostLinuxSendTo,
+  .recvfrom = hostLinuxRecvFrom,
+  .select = select,
+  .setsockopt = setsockopt,
+  .getsockopt = getsockopt,
+  .gethostbyname = hostLinuxGetHostByName
+};
+
+static const host_net_backend_t* _backend = &_linuxBackend;
+
+void hostNetSetBackend(const host_net_backend_t* backend)
+{
+  _backend = backend ? backend : &_linuxBackend;
+}
+
+err_t dns_gethostbyname(const char* hostname, ip_addr_t* addr, dns_found_callback found, void* callback_arg)
+{
+  if (!hostname || !addr || !found) return ERR_ARG;
+  if (ipaddr_aton(hostname, addr)) return ERR_OK;
+  return _backend->gethostbyname(hostname, addr, found, callback_arg);
+}
+
+int lwip_socket(int domain, int type, int protocol)
+{
+  return _backend->socket(domain, type, protocol);
+}
+
+int lwip_close(int s)
+{
+  return _backend->close(s);
+}
+
+ssize_t lwip_sendto(int s, const void* dataptr, size_t size, int flags, const struct sockaddr* to, socklen_t tolen)
+{
+  return _backend->sendto(s, dataptr, size, flags, to, tolen);
+}
+
+ssize_t lwip_recvfrom(int s, void* mem, size_t len, int flags, struct sockaddr* from, socklen_t* fromlen)
+{
+  return _backend->recvfrom(s, mem, len, flags, from, fromlen);
+}
+
+int lwip_select(int maxfdp1, fd_set* readset, fd_set* writeset, fd_set* exceptset, struct timeval* timeout)
+{
+  return _backend->select(maxfdp1, readset, writeset, exceptset, timeout);
+}
+
+int lwip_setsockopt(int s, int level, int optname, const void* optval, socklen_t optlen)
+{
+  return _backend->setsockopt(s, level, optname, optval, optlen);
+}
+
+int lwip_getsockopt(int s, int level, int optname, void* optval, socklen_t* optlen)
+{
+  return _backend->getsockopt(s, level, optname, optval, optlen);
+}
@@ -0,0 +1,67 @@
+/*
+   EN: Pinger on the host: pinger_host [seconds], without an argument it works until Ctrl+C.
+       Parameters are set by the environment variables, for example: PING_HOSTS=8.8.8.8,1.1.1.1 PING_COUNT=10
+   RU: Пингер на хосте: pinger_host [секунды], без аргумента работает до Ctrl+C.
+       Параметры задаются переменными окружения, например: PING_HOSTS=8.8.8.8,1.1.1.1 PING_COUNT=10
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <unistd.h>
+#include "project_config.h"
+#include "rLog.h"
+#include "reEvents.h"
+#include "rePinger.h"
+#include "rePingerMqtt.h"
+
+static const char* logTAG = "HOST";
+
+static volatile sig_atomic_t _terminated = 0;
+
+static void hostSignalHandler(int signal)
+{
+  _terminated = 1;
+}
+
+#if CONFIG_MQTT_PINGER_ENABLE && CONFIG_MQTT_PINGER_AS_CBOR
+static bool hostRawPublish(const char* topic, const uint8_t* payload, size_t size, int qos, bool retained)
+{
+  printf("%s = ", topic);
+  for (size_t i = 0; i < size; i++) {
+    printf("%02x", payload[i]);
+  };
+  printf("\n");
+  fflush(stdout);
+  return true;
+}
+#endif // CONFIG_MQTT_PINGER_AS_CBOR
+
+int main(int argc, char* argv[])
+{
+  int duration = argc > 1 ? atoi(argv[1]) : 0;
+  signal(SIGINT, hostSignalHandler);
+  signal(SIGTERM, hostSignalHandler);
+
+  #if CONFIG_MQTT_PINGER_ENABLE && CONFIG_MQTT_PINGER_AS_CBOR
+    pingerMqttSetRawPublisher(hostRawPublish);
+  #endif // CONFIG_MQTT_PINGER_AS_CBOR
+
+  if (!pingerEventHandlerRegister() || !pingerTaskCreate(false)) {
+    rlog_e(logTAG, "Failed to start pinger");
+    return EXIT_FAILURE;
+  };
+
+  // The network and the broker are available from the start
+  re_mqtt_event_data_t mqtt_data = { .primary = true };
+  eventLoopPost(RE_MQTT_EVENTS, RE_MQTT_CONNECTED, &mqtt_data, sizeof(mqtt_data), portMAX_DELAY);
+  eventLoopPost(RE_WIFI_EVENTS, RE_WIFI_STA_GOT_IP, nullptr, 0, portMAX_DELAY);
+
+  for (int elapsed = 0; !_terminated && ((duration == 0) || (elapsed < duration)); elapsed++) {
+    sleep(1);
+  };
+
+  pingerTaskDelete();
+  rlog_i(logTAG, "Pinger stopped");
+  return EXIT_SUCCESS;
+}
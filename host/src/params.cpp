@@ -0,0 +1,136 @@
+/*
+   EN: Parameters: the default values are overridden with the environment variables <GROUP>_<KEY> (in upper case)
+   RU: Параметры: значения по умолчанию переопределяются переменными окружения <GROUP>_<KEY> (в верхнем регистре)
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <pthread.h>
+#include "rLog.h"
+#include "reParams.h"
+
+static const char* logTAG = "PARAMS";
+
+struct paramsGroup_t {
+  paramsGroup_t* next;
+  paramsGroup_t* parent;
+  const char* key;
+};
+
+struct paramsEntry_t {
+  paramsEntry_t* next;
+  param_type_t type;
+  const char* key;
+  void* value;
+};
+
+// Registered groups and values exist until the process terminates
+static paramsGroup_t* _paramsGroups = nullptr;
+static paramsEntry_t* _paramsEntries = nullptr;
+static pthread_mutex_t _paramsLock = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+
+void paramsLock()
+{
+  pthread_mutex_lock(&_paramsLock);
+}
+
+void paramsUnlock()
+{
+  pthread_mutex_unlock(&_paramsLock);
+}
+
+paramsGroupHandle_t paramsRegisterGroup(paramsGroupHandle_t parent_group, const char* name_key, const char* name_topic, const char* name_friendly)
+{
+  paramsGroup_t* group = (paramsGroup_t*)calloc(1, sizeof(paramsGroup_t));
+  if (group) {
+    group->parent = parent_group;
+    group->key = name_key;
+    group->next = _paramsGroups;
+    _paramsGroups = group;
+  };
+  return group;
+}
+
+static void paramsGetName(paramsGroupHandle_t group, const char* key, char* buffer, size_t size)
+{
+  snprintf(buffer, size, "%s", key);
+  for (paramsGroupHandle_t item = group; item; item = item->parent) {
+    size_t len = strlen(item->key) + 1;
+    if (strlen(buffer) + len >= size) break;
+    memmove(buffer + len, buffer, strlen(buffer) + 1);
+    memcpy(buffer, item->key, len - 1);
+    buffer[len - 1] = '_';
+  };
+  for (char* c = buffer; *c; c++) {
+    *c = isalnum((unsigned char)*c) ? toupper((unsigned char)*c) : '_';
+  };
+}
+
+static void paramsSetValue(paramsEntryHandle_t entry, const char* text)
+{
+  switch (entry->type) {
+    case OPT_TYPE_I8:     *(int8_t*)entry->value = (int8_t)strtol(text, nullptr, 0); break;
+    case OPT_TYPE_U8:     *(uint8_t*)entry->value = (uint8_t)strtoul(text, nullptr, 0); break;
+    case OPT_TYPE_I16:    *(int16_t*)entry->value = (int16_t)strtol(text, nullptr, 0); break;
+    case OPT_TYPE_U16:    *(uint16_t*)entry->value = (uint16_t)strtoul(text, nullptr, 0); break;
+    case OPT_TYPE_I32:    *(int32_t*)entry->value = (int32_t)strtol(text, nullptr, 0); break;
+    case OPT_TYPE_U32:    *(uint32_t*)entry->value = (uint32_t)strtoul(text, nullptr, 0); break;
+    case OPT_TYPE_FLOAT:  *(float*)entry->value = strtof(text, nullptr); break;
+    case OPT_TYPE_STRING:
+      free(*(char**)entry->value);
+      *(char**)entry->value = strdup(text);
+      break;
+  };
+}
+
+paramsEntryHandle_t paramsRegisterValue(param_kind_t type_param, param_type_t type_value, param_handler_t* change_handler,
+  paramsGroupHandle_t parent_group, const char* name_key, const char* name_friendly, int qos, void* value)
+{
+  paramsEntry_t* entry = (paramsEntry_t*)calloc(1, sizeof(paramsEntry_t));
+  if (!entry) return nullptr;
+  entry->type = type_value;
+  entry->key = name_key;
+  entry->value = value;
+  entry->next = _paramsEntries;
+  _paramsEntries = entry;
+
+  char name[160];
+  paramsGetName(parent_group, name_key, name, sizeof(name));
+  const char* text = getenv(name);
+  if (text) {
+    paramsLock();
+    paramsSetValue(entry, text);
+    paramsUnlock();
+    rlog_i(logTAG, "Parameter [ %s ] is set to \"%s\"", name, text);
+  };
+  return entry;
+}
+
+#define PARAMS_LIMITS(type, entry, min_value, max_value) \
+  if (entry) { \
+    type* value = (type*)entry->value; \
+    if (*value < min_value) *value = min_value; \
+    if (*value > max_value) *value = max_value; \
+  };
+
+void paramsSetLimitsU8(paramsEntryHandle_t entry, uint8_t min_value, uint8_t max_value)
+{
+  PARAMS_LIMITS(uint8_t, entry, min_value, max_value);
+}
+
+void paramsSetLimitsU16(paramsEntryHandle_t entry, uint16_t min_value, uint16_t max_value)
+{
+  PARAMS_LIMITS(uint16_t, entry, min_value, max_value);
+}
+
+void paramsSetLimitsU32(paramsEntryHandle_t entry, uint32_t min_value, uint32_t max_value)
+{
+  PARAMS_LIMITS(uint32_t, entry, min_value, max_value);
+}
+
+void paramsSetLimitsFloat(paramsEntryHandle_t entry, float min_value, float max_value)
+{
+  PARAMS_LIMITS(float, entry, min_value, max_value);
+}
@@ -0,0 +1,96 @@
+/*
+   EN: Network services of the device: MQTT messages and requests to external services are written to stdout
+   RU: Сетевые сервисы устройства: сообщения MQTT и запросы к внешним сервисам выводятся в stdout
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "reMqtt.h"
+#include "reStates.h"
+#include "reWiFi.h"
+#include "reDataSend.h"
+#include "rStrings.h"
+#include "host.h"
+
+#ifndef CONFIG_HOST_MQTT_PREFIX
+#define CONFIG_HOST_MQTT_PREFIX "host"
+#endif // CONFIG_HOST_MQTT_PREFIX
+
+static pthread_mutex_t _outputLock = PTHREAD_MUTEX_INITIALIZER;
+static bool _outputEnabled = true;
+static host_output_sink_t _outputSink = nullptr;
+
+void hostOutputSetEnabled(bool enabled)
+{
+  _outputEnabled = enabled;
+}
+
+void hostOutputSetSink(host_output_sink_t sink)
+{
+  _outputSink = sink;
+}
+
+char* mqttGetTopicDevice1(bool primary, bool local, const char* topic)
+{
+  return malloc_stringf("%s/%s", CONFIG_HOST_MQTT_PREFIX, topic);
+}
+
+char* mqttGetSubTopic(const char* topic, const char* subtopic)
+{
+  return malloc_stringf("%s/%s", topic, subtopic);
+}
+
+bool mqttPublish(char* topic, char* payload, int qos, bool retained, bool free_topic, bool free_payload)
+{
+  if (topic && payload && _outputSink) {
+    _outputSink(topic, payload, strlen(payload));
+  } else if (topic && payload && _outputEnabled) {
+    pthread_mutex_lock(&_outputLock);
+    fprintf(stdout, "%s = %s\n", topic, payload);
+    fflush(stdout);
+    pthread_mutex_unlock(&_outputLock);
+  };
+  if (free_topic) free(topic);
+  if (free_payload) free(payload);
+  return topic && payload;
+}
+
+bool mqttIsConnected()
+{
+  return true;
+}
+
+bool statesMqttIsEnabled()
+{
+  return true;
+}
+
+wifi_ap_record_t wifiInfo()
+{
+  wifi_ap_record_t info;
+  memset(&info, 0, sizeof(info));
+  strcpy((char*)info.ssid, "host");
+  info.rssi = -50;
+  return info;
+}
+
+bool dsChannelInit(ext_data_service_t kind, uint32_t uid, const char* key, uint32_t min_interval, uint32_t err_interval)
+{
+  return true;
+}
+
+bool dsSend(ext_data_service_t kind, uint32_t uid, char* data, bool free_data)
+{
+  if (data && _outputSink) {
+    _outputSink(nullptr, data, strlen(data));
+  } else if (data && _outputEnabled) {
+    pthread_mutex_lock(&_outputLock);
+    fprintf(stdout, "ds/%d/%u = %s\n", (int)kind, uid, data);
+    fflush(stdout);
+    pthread_mutex_unlock(&_outputLock);
+  };
+  if (free_data) free(data);
+  return data;
+}
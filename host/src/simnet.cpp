@@ -0,0 +1,402 @@
+/*
+   EN: Deterministic network simulator: virtual ICMP sockets and resolver on the virtual clock
+   RU: Детерминированный симулятор сети: виртуальные сокеты ICMP и DNS на виртуальных часах
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include "lwip/lwip_host.h"
+#include "host.h"
+#include "simnet.h"
+
+// Virtual descriptors do not intersect with the standard ones and fit into fd_set
+#define SIM_SOCKET_FIRST 64
+#define SIM_SOCKETS_MAX 64
+#define SIM_QUEUE_SIZE 64
+#define SIM_PACKET_MAX (sizeof(struct ip_hdr) + sizeof(struct icmp_echo_hdr) + 256)
+#define SIM_DNS_MAX 32
+
+typedef struct {
+  char name[64];
+  ip_addr_t addr;
+  sim_host_profile_t profile;
+  bool burst;
+} sim_host_t;
+
+typedef struct {
+  int64_t time_us;
+  ip_addr_t from;
+  uint16_t len;
+  uint8_t data[SIM_PACKET_MAX];
+} sim_packet_t;
+
+typedef struct {
+  bool used;
+  uint8_t count;
+  sim_packet_t queue[SIM_QUEUE_SIZE];
+} sim_socket_t;
+
+typedef struct {
+  bool used;
+  sim_host_t* host;
+  dns_found_callback found;
+  void* callback_arg;
+} sim_dns_t;
+
+static uint64_t _simRandom = 1;
+static sim_host_t _simHosts[SIM_HOSTS_MAX];
+static uint8_t _simHostsCount = 0;
+static sim_socket_t _simSockets[SIM_SOCKETS_MAX];
+static sim_dns_t _simDns[SIM_DNS_MAX];
+static sim_net_stats_t _simStats;
+
+// ------------------------------------------------------------------------------------------------------------------------
+// ------------------------------------------------------- Random ---------------------------------------------------------
+// ------------------------------------------------------------------------------------------------------------------------
+
+double simNetRandom()
+{
+  // xorshift64*
+  _simRandom ^= _simRandom >> 12;
+  _simRandom ^= _simRandom << 25;
+  _simRandom ^= _simRandom >> 27;
+  return (double)((_simRandom * 0x2545F4914F6CDD1DULL) >> 11) / (double)(1ULL << 53);
+}
+
+static uint32_t simNetDelay(const sim_host_profile_t* profile)
+{
+  double delay = profile->delay_base_us;
+  switch (profile->delay) {
+    case SIM_DELAY_UNIFORM:
+      delay += simNetRandom() * profile->delay_spread_us;
+      break;
+    case SIM_DELAY_NORMAL:
+      // Box-Muller
+      delay += sqrt(-2.0 * log(1.0 - simNetRandom())) * cos(2.0 * M_PI * simNetRandom()) * profile->delay_spread_us;
+      break;
+    case SIM_DELAY_PARETO:
+      delay += (pow(1.0 - simNetRandom(), -1.0 / 1.5) - 1.0) * profile->delay_spread_us;
+      break;
+    default:
+      break;
+  };
+  if (delay < 0) return 0;
+  if (delay > 60000000.0) return 60000000;
+  return (uint32_t)delay;
+}
+
+// The state of the Gilbert-Elliott model changes with each packet
+static bool simNetLost(sim_host_t* host)
+{
+  const sim_host_profile_t* profile = &host->profile;
+  if (host->burst) {
+    if (simNetRandom() < profile->burst_end) host->burst = false;
+  } else {
+    if (simNetRandom() < profile->burst_start) host->burst = true;
+  };
+  return simNetRandom() < (host->burst ? profile->burst_loss : profile->loss);
+}
+
+// ------------------------------------------------------------------------------------------------------------------------
+// -------------------------------------------------------- Hosts ---------------------------------------------------------
+// ------------------------------------------------------------------------------------------------------------------------
+
+static sim_host_t* simNetFindName(const char* name)
+{
+  for (uint8_t i = 0; i < _simHostsCount; i++) {
+    if (strcasecmp(_simHosts[i].name, name) == 0) return &_simHosts[i];
+  };
+  return nullptr;
+}
+
+static sim_host_t* simNetFindAddr(const ip_addr_t* addr)
+{
+  for (uint8_t i = 0; i < _simHostsCount; i++) {
+    if (ip_addr_cmp(&_simHosts[i].addr, addr)) return &_simHosts[i];
+  };
+  return nullptr;
+}
+
+bool simNetHostSet(const char* name, const sim_host_profile_t* profile)
+{
+  sim_host_t* host = simNetFindName(name);
+  if (!host) {
+    if ((_simHostsCount >= SIM_HOSTS_MAX) || (strlen(name) >= sizeof(host->name))) return false;
+    host = &_simHosts[_simHostsCount];
+    memset(host, 0, sizeof(sim_host_t));
+    strcpy(host->name, name);
+    if (!ipaddr_aton(name, &host->addr)) {
+      char addr[16];
+      snprintf(addr, sizeof(addr), "10.0.%d.%d", (_simHostsCount + 1) / 256, (_simHostsCount + 1) % 256);
+      ipaddr_aton(addr, &host->addr);
+    };
+    _simHostsCount++;
+  };
+  host->profile = *profile;
+  return true;
+}
+
+void simNetGetStats(sim_net_stats_t* stats)
+{
+  *stats = _simStats;
+}
+
+// ------------------------------------------------------------------------------------------------------------------------
+// ------------------------------------------------------- Resolver -------------------------------------------------------
+// ------------------------------------------------------------------------------------------------------------------------
+
+static void simNetDnsAnswer(void* arg)
+{
+  sim_dns_t* request = (sim_dns_t*)arg;
+  request->used = false;
+  if (request->host && !request->host->profile.dns_fail) {
+    request->found(request->host->name, &request->host->addr, request->callback_arg);
+  } else {
+    _simStats.dns_failed++;
+    request->found(request->host ? request->host->name : "", nullptr, request->callback_arg);
+  };
+}
+
+static err_t simNetGetHostByName(const char* hostname, ip_addr_t* addr, dns_found_callback found, void* callback_arg)
+{
+  _simStats.dns_requests++;
+  for (uint8_t i = 0; i < SIM_DNS_MAX; i++) {
+    sim_dns_t* request = &_simDns[i];
+    if (!request->used) {
+      request->used = true;
+      request->host = simNetFindName(hostname);
+      request->found = found;
+      request->callback_arg = callback_arg;
+      uint32_t delay = request->host ? request->host->profile.dns_delay_us : 0;
+      if (!hostClockSchedule(hostClockNow() + delay, simNetDnsAnswer, request)) {
+        request->used = false;
+        return ERR_MEM;
+      };
+      return ERR_INPROGRESS;
+    };
+  };
+  return ERR_MEM;
+}
+
+// ------------------------------------------------------------------------------------------------------------------------
+// ------------------------------------------------------- Sockets --------------------------------------------------------
+// ------------------------------------------------------------------------------------------------------------------------
+
+static sim_socket_t* simNetSocket(int s)
+{
+  if ((s < SIM_SOCKET_FIRST) || (s >= SIM_SOCKET_FIRST + SIM_SOCKETS_MAX)) return nullptr;
+  sim_socket_t* sock = &_simSockets[s - SIM_SOCKET_FIRST];
+  return sock->used ? sock : nullptr;
+}
+
+static int simNetOpen(int domain, int type, int protocol)
+{
+  if ((domain != AF_INET) || (protocol != IP_PROTO_ICMP)) {
+    errno = EAFNOSUPPORT;
+    return -1;
+  };
+  for (int i = 0; i < SIM_SOCKETS_MAX; i++) {
+    if (!_simSockets[i].used) {
+      _simSockets[i].used = true;
+      _simSockets[i].count = 0;
+      return SIM_SOCKET_FIRST + i;
+    };
+  };
+  errno = EMFILE;
+  return -1;
+}
+
+static int simNetClose(int s)
+{
+  sim_socket_t* sock = simNetSocket(s);
+  if (!sock) {
+    errno = EBADF;
+    return -1;
+  };
+  sock->used = false;
+  return 0;
+}
+
+static ssize_t simNetSendTo(int s, const void* dataptr, size_t size, int flags, const struct sockaddr* to, socklen_t tolen)
+{
+  sim_socket_t* sock = simNetSocket(s);
+  if (!sock || !to || (to->sa_family != AF_INET) || (size < sizeof(struct icmp_echo_hdr))) {
+    errno = sock ? EINVAL : EBADF;
+    return -1;
+  };
+  _simStats.requests++;
+  size_t icmp_size = size + sizeof(struct ip_hdr) > SIM_PACKET_MAX ? SIM_PACKET_MAX - sizeof(struct ip_hdr) : size;
+
+  // The request or the reply is lost, an unknown host does not answer
+  ip_addr_t addr;
+  inet_addr_to_ip4addr(&addr, &((const struct sockaddr_in*)to)->sin_addr);
+  sim_host_t* host = simNetFindAddr(&addr);
+  if (!host || simNetLost(host) || (sock->count >= SIM_QUEUE_SIZE)) {
+    _simStats.lost++;
+    return size;
+  };
+
+  int64_t delay = simNetDelay(&host->profile);
+  if ((host->profile.reorder > 0) && (simNetRandom() < host->profile.reorder)) {
+    delay += host->profile.reorder_us;
+    _simStats.reordered++;
+  };
+
+  sim_packet_t* packet = &sock->queue[sock->count++];
+  packet->time_us = hostClockNow() + delay;
+  packet->from = host->addr;
+  packet->len = (uint16_t)(sizeof(struct ip_hdr) + icmp_size);
+  struct ip_hdr* iphdr = (struct ip_hdr*)packet->data;
+  memset(iphdr, 0, sizeof(struct ip_hdr));
+  iphdr->_v_hl = (4 << 4) | (sizeof(struct ip_hdr) / 4);
+  iphdr->_len = htons(packet->len);
+  iphdr->_ttl = host->profile.ttl;
+  iphdr->_proto = IP_PROTO_ICMP;
+  iphdr->src = host->addr;
+  struct icmp_echo_hdr* iecho = (struct icmp_echo_hdr*)(packet->data + sizeof(struct ip_hdr));
+  memcpy(iecho, dataptr, icmp_size);
+  iecho->type = ICMP_ER;
+  iecho->chksum = 0;
+  iecho->chksum = inet_chksum(iecho, (u16_t)icmp_size);
+  return size;
+}
+
+// Index of the earliest reply in the queue, or -1
+static int simNetFirst(sim_socket_t* sock)
+{
+  int first = -1;
+  for (int i = 0; i < sock->count; i++) {
+    if ((first < 0) || (sock->queue[i].time_us < sock->queue[first].time_us)) first = i;
+  };
+  return first;
+}
+
+static ssize_t simNetRecvFrom(int s, void* mem, size_t len, int flags, struct sockaddr* from, socklen_t* fromlen)
+{
+  sim_socket_t* sock = simNetSocket(s);
+  if (!sock) {
+    errno = EBADF;
+    return -1;
+  };
+  int first = simNetFirst(sock);
+  if ((first < 0) || (sock->queue[first].time_us > hostClockNow())) {
+    errno = EWOULDBLOCK;
+    return -1;
+  };
+
+  sim_packet_t* packet = &sock->queue[first];
+  size_t size = packet->len < len ? packet->len : len;
+  memcpy(mem, packet->data, size);
+  if (from && fromlen && (*fromlen >= sizeof(struct sockaddr_in))) {
+    struct sockaddr_in* from4 = (struct sockaddr_in*)from;
+    memset(from4, 0, sizeof(struct sockaddr_in));
+    from4->sin_family = AF_INET;
+    inet_addr_from_ip4addr(&from4->sin_addr, &packet->from);
+    *fromlen = sizeof(struct sockaddr_in);
+  };
+  *packet = sock->queue[--sock->count];
+  _simStats.replies++;
+  return size;
+}
+
+// Time of the earliest reply on the sockets of the set
+static int64_t simNetNextReply(int maxfdp1, fd_set* readset)
+{
+  int64_t next = INT64_MAX;
+  for (int s = SIM_SOCKET_FIRST; (s < maxfdp1) && (s < SIM_SOCKET_FIRST + SIM_SOCKETS_MAX); s++) {
+    sim_socket_t* sock = simNetSocket(s);
+    if (sock && FD_ISSET(s, readset)) {
+      int first = simNetFirst(sock);
+      if ((first >= 0) && (sock->queue[first].time_us < next)) next = sock->queue[first].time_us;
+    };
+  };
+  return next;
+}
+
+static int simNetSelect(int maxfdp1, fd_set* readset, fd_set* writeset, fd_set* exceptset, struct timeval* timeout)
+{
+  int64_t deadline = timeout ? hostClockNow() + (int64_t)timeout->tv_sec * 1000000 + timeout->tv_usec : INT64_MAX;
+  fd_set empty;
+  FD_ZERO(&empty);
+  if (!readset) readset = &empty;
+  while (1) {
+    int64_t now = hostClockNow();
+    int64_t next = simNetNextReply(maxfdp1, readset);
+    if (next <= now) break;
+    int64_t timer = hostClockNextTimer();
+    if (timer < next) next = timer;
+    if (next > deadline) {
+      hostClockAdvanceTo(deadline);
+      break;
+    };
+    if (next == INT64_MAX) {
+      errno = EINVAL;
+      return -1;
+    };
+    hostClockAdvanceTo(next);
+  };
+
+  // Only reading is supported
+  int ready = 0;
+  fd_set result;
+  FD_ZERO(&result);
+  for (int s = SIM_SOCKET_FIRST; (s < maxfdp1) && (s < SIM_SOCKET_FIRST + SIM_SOCKETS_MAX); s++) {
+    sim_socket_t* sock = simNetSocket(s);
+    if (sock && FD_ISSET(s, readset)) {
+      int first = simNetFirst(sock);
+      if ((first >= 0) && (sock->queue[first].time_us <= hostClockNow())) {
+        FD_SET(s, &result);
+        ready++;
+      };
+    };
+  };
+  *readset = result;
+  if (writeset) FD_ZERO(writeset);
+  if (exceptset) FD_ZERO(exceptset);
+  return ready;
+}
+
+static int simNetSetSockOpt(int s, int level, int optname, const void* optval, socklen_t optlen)
+{
+  return simNetSocket(s) ? 0 : -1;
+}
+
+static int simNetGetSockOpt(int s, int level, int optname, void* optval, socklen_t* optlen)
+{
+  if (!simNetSocket(s)) return -1;
+  if (optval && optlen && (*optlen >= sizeof(int))) {
+    *(int*)optval = 0;
+    *optlen = sizeof(int);
+  };
+  return 0;
+}
+
+static const host_net_backend_t _simBackend = {
+  .socket = simNetOpen,
+  .close = simNetClose,
+  .sendto = simNetSendTo,
+  .recvfrom = simNetRecvFrom,
+  .select = simNetSelect,
+  .setsockopt = simNetSetSockOpt,
+  .getsockopt = simNetGetSockOpt,
+  .gethostbyname = simNetGetHostByName
+};
+
+void simNetStart(uint64_t seed)
+{
+  _simRandom = seed ? seed : 1;
+  _simHostsCount = 0;
+  memset(_simSockets, 0, sizeof(_simSockets));
+  memset(_simDns, 0, sizeof(_simDns));
+  memset(&_simStats, 0, sizeof(_simStats));
+  hostClockSetVirtual(true);
+  hostNetSetBackend(&_simBackend);
+}
+
+void simNetStop()
+{
+  hostNetSetBackend(nullptr);
+  hostClockSetVirtual(false);
+}
@@ -0,0 +1,215 @@
+/*
+   EN: Simulation of the check cycles on the virtual network: pinger_sim [cycles] [seed]
+       Periods of normal operation alternate with faults (outage of all hosts, slowdown, failure of one host),
+       the detection latency and the false alarms of the state machine are measured. The result is printed in JSON.
+       Parameters of the pinger are set by the environment variables, for example PING_UNAVAILABLE_THRESHOLD=3
+   RU: Моделирование циклов проверки на виртуальной сети: pinger_sim [циклы] [seed]
+       Периоды нормальной работы чередуются со сбоями (отказ всех хостов, замедление, отказ одного хоста),
+       измеряются задержка обнаружения и ложные срабатывания. Результат выводится в JSON.
+       Параметры пингера задаются переменными окружения, например PING_UNAVAILABLE_THRESHOLD=3
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "project_config.h"
+#include "reEvents.h"
+#include "rePinger.h"
+#include "host.h"
+#include "simnet.h"
+
+typedef enum {
+  SIM_NORMAL = 0,
+  SIM_OUTAGE,
+  SIM_SLOWDOWN,
+  SIM_PARTIAL
+} sim_phase_t;
+
+#define SIM_HOSTS_COUNT 3
+
+static const char* _simNames[SIM_HOSTS_COUNT] = { "a.sim", "b.sim", "c.sim" };
+
+// Typical public servers: close and stable, far with bursts of losses, with a heavy tail and reordering
+static const sim_host_profile_t _simProfiles[SIM_HOSTS_COUNT] = {
+  { SIM_DELAY_NORMAL, 20000, 3000, 0.005f, 0.0f, 0.0f, 0.0f, 0.0f, 0, 20000, false, 58 },
+  { SIM_DELAY_NORMAL, 45000, 8000, 0.01f, 0.01f, 0.3f, 0.7f, 0.0f, 0, 30000, false, 54 },
+  { SIM_DELAY_PARETO, 35000, 10000, 0.01f, 0.0f, 0.0f, 0.0f, 0.05f, 20000, 50000, false, 120 }
+};
+
+typedef struct {
+  uint32_t count;
+  uint32_t detected;
+  int64_t latency_sum_us;
+  int64_t latency_max_us;
+} sim_detection_t;
+
+static sim_phase_t _simPhase = SIM_NORMAL;
+static int64_t _simPhaseStart = 0;
+static bool _simPhaseDetected = false;
+static sim_detection_t _simOutages = { };
+static sim_detection_t _simSlowdowns = { };
+static sim_detection_t _simRecoveries = { };
+static bool _simRecoveryPending = false;
+static int64_t _simRecoveryStart = 0;
+static uint32_t _simFalseUnavailable = 0;
+static uint32_t _simFalseSlowdown = 0;
+static uint32_t _simEvents = 0;
+
+static void simDetected(sim_detection_t* detection, int64_t start)
+{
+  int64_t latency = hostClockNow() - start;
+  detection->detected++;
+  detection->latency_sum_us += latency;
+  if (latency > detection->latency_max_us) detection->latency_max_us = latency;
+}
+
+static void simEventHandler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data)
+{
+  _simEvents++;
+  switch (event_id) {
+    case RE_PING_INET_UNAVAILABLE:
+      if (_simPhase == SIM_OUTAGE) {
+        if (!_simPhaseDetected) simDetected(&_simOutages, _simPhaseStart);
+        _simPhaseDetected = true;
+      } else {
+        _simFalseUnavailable++;
+      };
+      break;
+    case RE_PING_INET_SLOWDOWN:
+      if (_simPhase == SIM_SLOWDOWN) {
+        if (!_simPhaseDetected) simDetected(&_simSlowdowns, _simPhaseStart);
+        _simPhaseDetected = true;
+      } else if ((_simPhase == SIM_NORMAL) && !_simRecoveryPending) {
+        // Losses of one host out of three exceed the slowdown threshold, after an outage the filter is still recovering
+        _simFalseSlowdown++;
+      };
+      break;
+    case RE_PING_INET_AVAILABLE:
+      if (_simRecoveryPending && (_simPhase != SIM_OUTAGE)) {
+        simDetected(&_simRecoveries, _simRecoveryStart);
+        _simRecoveryPending = false;
+      };
+      break;
+    default:
+      break;
+  };
+}
+
+// The fault begins at the scheduled time, while the pinger may be waiting for the next check
+static void simSetPhase(sim_phase_t phase, int64_t start)
+{
+  if ((_simPhase == SIM_OUTAGE) && _simPhaseDetected) {
+    _simRecoveryPending = true;
+    _simRecoveryStart = start;
+    _simRecoveries.count++;
+  };
+  _simPhase = phase;
+  _simPhaseStart = start;
+  _simPhaseDetected = false;
+  if (phase == SIM_OUTAGE) _simOutages.count++;
+  if (phase == SIM_SLOWDOWN) _simSlowdowns.count++;
+  if (phase == SIM_OUTAGE) _simRecoveryPending = false;
+
+  uint8_t victim = (uint8_t)(simNetRandom() * SIM_HOSTS_COUNT);
+  for (uint8_t i = 0; i < SIM_HOSTS_COUNT; i++) {
+    sim_host_profile_t profile = _simProfiles[i];
+    if ((phase == SIM_OUTAGE) || ((phase == SIM_PARTIAL) && (i == victim))) {
+      profile.loss = 1.0f;
+      profile.burst_start = 0.0f;
+    } else if (phase == SIM_SLOWDOWN) {
+      profile.delay_base_us += 2 * CONFIG_PINGER_SLOWDOWN_DURATION * 1000;
+    };
+    simNetHostSet(_simNames[i], &profile);
+  };
+}
+
+static void simPrintDetection(const char* name, const sim_detection_t* detection, bool last)
+{
+  printf("\"%s\":{\"count\":%u,\"detected\":%u,\"latency_avg_ms\":%.1f,\"latency_max_ms\":%.1f}%s",
+    name, detection->count, detection->detected,
+    detection->detected ? detection->latency_sum_us / 1000.0 / detection->detected : 0.0,
+    detection->latency_max_us / 1000.0, last ? "" : ",");
+}
+
+// Decimal or hexadecimal number without a sign, the whole argument must be consumed
+static bool simParseArg(const char* arg, uint64_t* value)
+{
+  char* end = nullptr;
+  if ((arg == nullptr) || (arg[0] < '0') || (arg[0] > '9')) return false;
+  *value = strtoull(arg, &end, 0);
+  return (end != arg) && (*end == 0);
+}
+
+// Rate per period, zero if no time has passed
+static double simRate(double value, double period)
+{
+  return period > 0 ? value / period : 0.0;
+}
+
+int main(int argc, char* argv[])
+{
+  uint64_t cycles = 10000;
+  uint64_t seed = 1;
+  if ((argc > 3) 
+   || ((argc > 1) && (!simParseArg(argv[1], &cycles) || (cycles == 0) || (cycles > UINT32_MAX))) 
+   || ((argc > 2) && !simParseArg(argv[2], &seed))) {
+    fprintf(stderr, "Usage: %s [cycles] [seed]\n"
+                    "  cycles - number of check cycles, 1..%u, default 10000\n"
+                    "  seed   - seed of the random number generator, default 1\n", argv[0], UINT32_MAX);
+    return EXIT_FAILURE;
+  };
+  hostLogSetLevel(getenv("SIM_LOG") ? atoi(getenv("SIM_LOG")) : 0);
+  hostOutputSetEnabled(false);
+
+  simNetStart(seed);
+  hostRandomSeed(seed);
+  char hosts[128] = "";
+  for (uint8_t i = 0; i < SIM_HOSTS_COUNT; i++) {
+    simNetHostSet(_simNames[i], &_simProfiles[i]);
+    strcat(hosts, i ? "," : "");
+    strcat(hosts, _simNames[i]);
+  };
+  setenv("PING_HOSTS", hosts, 0);
+  eventHandlerRegister(RE_PING_EVENTS, ESP_EVENT_ANY_ID, simEventHandler, nullptr);
+  pingerCycleInit();
+
+  // Normal operation for 20..60 intervals of the available state, then a fault for 1..10 intervals. 
+  // The phases are measured in virtual time, so that the schedule of the checks does not stretch them
+  struct timespec wall_start, wall_end;
+  clock_gettime(CLOCK_MONOTONIC, &wall_start);
+  int64_t phaseUnit = (int64_t)CONFIG_PINGER_INTERVAL_AVAILABLE * 1000;
+  int64_t phaseEnd = hostClockNow() + (20 + (int64_t)(simNetRandom() * 40)) * phaseUnit;
+  for (uint64_t cycle = 0; cycle < cycles; cycle++) {
+    while (hostClockNow() >= phaseEnd) {
+      if (_simPhase == SIM_NORMAL) {
+        double kind = simNetRandom();
+        simSetPhase(kind < 0.5 ? SIM_OUTAGE : (kind < 0.75 ? SIM_SLOWDOWN : SIM_PARTIAL), phaseEnd);
+        phaseEnd += (1 + (int64_t)(simNetRandom() * 10)) * phaseUnit;
+      } else {
+        simSetPhase(SIM_NORMAL, phaseEnd);
+        phaseEnd += (20 + (int64_t)(simNetRandom() * 40)) * phaseUnit;
+      };
+    };
+    uint32_t interval = pingerCycleExec();
+    hostClockAdvanceTo(hostClockNow() + (int64_t)interval * 1000);
+  };
+  clock_gettime(CLOCK_MONOTONIC, &wall_end);
+  double wall = (wall_end.tv_sec - wall_start.tv_sec) + (wall_end.tv_nsec - wall_start.tv_nsec) / 1e9;
+
+  sim_net_stats_t stats;
+  simNetGetStats(&stats);
+  printf("{\"cycles\":%u,\"seed\":%llu,\"virtual_s\":%.1f,\"wall_s\":%.3f,\"cycles_per_s\":%.0f,\"probes_per_s\":%.0f,",
+    (unsigned)cycles, (unsigned long long)seed, hostClockNow() / 1e6, wall, simRate(cycles, wall), simRate(stats.requests, wall));
+  printf("\"network\":{\"requests_per_min\":%.1f,\"requests\":%llu,\"replies\":%llu,\"lost\":%llu,\"reordered\":%llu,\"dns_requests\":%llu,\"dns_failed\":%llu},",
+    simRate(stats.requests * 60e6, hostClockNow()), (unsigned long long)stats.requests, (unsigned long long)stats.replies, (unsigned long long)stats.lost,
+    (unsigned long long)stats.reordered, (unsigned long long)stats.dns_requests, (unsigned long long)stats.dns_failed);
+  simPrintDetection("outages", &_simOutages, false);
+  simPrintDetection("slowdowns", &_simSlowdowns, false);
+  simPrintDetection("recoveries", &_simRecoveries, false);
+  printf("\"false_unavailable\":%u,\"false_slowdown\":%u,\"events\":%u}\n", _simFalseUnavailable, _simFalseSlowdown, _simEvents);
+
+  pingerCycleFree();
+  simNetStop();
+  return EXIT_SUCCESS;
+}
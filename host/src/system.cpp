@@ -0,0 +1,238 @@
+/*
+   EN: ESP-IDF system functions, the reEsp32 and rStrings libraries for the host build
+   RU: Системные функции ESP-IDF, библиотеки reEsp32 и rStrings для сборки на хосте
+*/
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <malloc.h>
+#include <sys/random.h>
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "esp_random.h"
+#include "esp_heap_caps.h"
+#include "esp_partition.h"
+#include "reEsp32.h"
+#include "rStrings.h"
+#include "host.h"
+
+int rlogHostLevel = CONFIG_RLOG_PROJECT_LEVEL;
+
+void hostLogSetLevel(int level)
+{
+  rlogHostLevel = level;
+}
+
+// ------------------------------------------------------------------------------------------------------------------------
+// ------------------------------------------------------- ESP-IDF --------------------------------------------------------
+// ------------------------------------------------------------------------------------------------------------------------
+
+const char* esp_err_to_name(esp_err_t code)
+{
+  switch (code) {
+    case ESP_OK: return "ESP_OK";
+    case ESP_FAIL: return "ESP_FAIL";
+    case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_INVALID_SIZE: return "ESP_ERR_INVALID_SIZE";
+    case ESP_ERR_NOT_FOUND: return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_TIMEOUT: return "ESP_ERR_TIMEOUT";
+    default: return "UNKNOWN ERROR";
+  };
+}
+
+int64_t esp_timer_get_time(void)
+{
+  return hostClockNow();
+}
+
+static uint64_t _hostRandom = 0;
+
+void hostRandomSeed(uint64_t seed)
+{
+  _hostRandom = seed;
+}
+
+uint32_t esp_random(void)
+{
+  if (_hostRandom != 0) {
+    // xorshift64*
+    _hostRandom ^= _hostRandom >> 12;
+    _hostRandom ^= _hostRandom << 25;
+    _hostRandom ^= _hostRandom >> 27;
+    return (uint32_t)((_hostRandom * 2685821657736338717ULL) >> 32);
+  };
+  uint32_t value = 0;
+  if (getrandom(&value, sizeof(value), 0) != sizeof(value)) {
+    value = (uint32_t)rand();
+  };
+  return value;
+}
+
+size_t heap_caps_get_total_size(uint32_t caps)
+{
+  struct mallinfo2 mi = mallinfo2();
+  return mi.arena + mi.hblkhd;
+}
+
+size_t heap_caps_get_free_size(uint32_t caps)
+{
+  struct mallinfo2 mi = mallinfo2();
+  return mi.fordblks;
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t caps)
+{
+  return heap_caps_get_free_size(caps);
+}
+
+size_t heap_caps_get_allocated_size(void* ptr)
+{
+  return ptr ? malloc_usable_size(ptr) : 0;
+}
+
+// ------------------------------------------------------------------------------------------------------------------------
+// ------------------------------------------------------ Partitions ------------------------------------------------------
+// ------------------------------------------------------------------------------------------------------------------------
+
+#define HOST_PARTITIONS_MAX 4
+
+static esp_partition_t _partitions[HOST_PARTITIONS_MAX];
+static uint8_t* _partitionsData[HOST_PARTITIONS_MAX];
+
+// Any requested data partition exists, it is created on the first request
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype, const char* label)
+{
+  if ((type != ESP_PARTITION_TYPE_DATA) || !label) return nullptr;
+  for (int i = 0; i < HOST_PARTITIONS_MAX; i++) {
+    if (_partitionsData[i] && (strcmp(_partitions[i].label, label) == 0)) return &_partitions[i];
+  };
+  for (int i = 0; i < HOST_PARTITIONS_MAX; i++) {
+    if (!_partitionsData[i]) {
+      _partitionsData[i] = (uint8_t*)malloc(CONFIG_HOST_PARTITION_SIZE);
+      if (!_partitionsData[i]) return nullptr;
+      memset(_partitionsData[i], 0xFF, CONFIG_HOST_PARTITION_SIZE);
+      _partitions[i].type = type;
+      _partitions[i].subtype = subtype;
+      _partitions[i].address = i * CONFIG_HOST_PARTITION_SIZE;
+      _partitions[i].size = CONFIG_HOST_PARTITION_SIZE;
+      strncpy(_partitions[i].label, label, sizeof(_partitions[i].label) - 1);
+      return &_partitions[i];
+    };
+  };
+  return nullptr;
+}
+
+static uint8_t* hostPartitionData(const esp_partition_t* partition, size_t offset, size_t size)
+{
+  if (!partition || (offset + size > partition->size)) return nullptr;
+  return _partitionsData[partition - _partitions] + offset;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t* partition, size_t src_offset, void* dst, size_t size)
+{
+  uint8_t* data = hostPartitionData(partition, src_offset, size);
+  if (!data) return ESP_ERR_INVALID_SIZE;
+  memcpy(dst, data, size);
+  return ESP_OK;
+}
+
+// As in flash memory, the bits can only be reset by writing
+esp_err_t esp_partition_write(const esp_partition_t* partition, size_t dst_offset, const void* src, size_t size)
+{
+  uint8_t* data = hostPartitionData(partition, dst_offset, size);
+  if (!data) return ESP_ERR_INVALID_SIZE;
+  for (size_t i = 0; i < size; i++) {
+    data[i] &= ((const uint8_t*)src)[i];
+  };
+  return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t* partition, size_t offset, size_t size)
+{
+  uint8_t* data = hostPartitionData(partition, offset, size);
+  if (!data || (offset % 4096) || (size % 4096)) return ESP_ERR_INVALID_ARG;
+  memset(data, 0xFF, size);
+  return ESP_OK;
+}
+
+// ------------------------------------------------------------------------------------------------------------------------
+// -------------------------------------------------------- reEsp32 -------------------------------------------------------
+// ------------------------------------------------------------------------------------------------------------------------
+
+void* esp_malloc(size_t size)
+{
+  return malloc(size);
+}
+
+void* esp_calloc(size_t count, size_t size)
+{
+  return calloc(count, size);
+}
+
+bool esp_heap_free_check()
+{
+  return true;
+}
+
+// ------------------------------------------------------------------------------------------------------------------------
+// ------------------------------------------------------- rStrings -------------------------------------------------------
+// ------------------------------------------------------------------------------------------------------------------------
+
+char* malloc_string(const char* source)
+{
+  return source ? strdup(source) : nullptr;
+}
+
+char* malloc_stringf(const char* format, ...)
+{
+  char* ret = nullptr;
+  va_list args;
+  va_start(args, format);
+  if (vasprintf(&ret, format, args) < 0) ret = nullptr;
+  va_end(args);
+  return ret;
+}
+
+char* malloc_timestr(const char* format, time_t value)
+{
+  char buffer[64];
+  struct tm timeinfo;
+  localtime_r(&value, &timeinfo);
+  if (strftime(buffer, sizeof(buffer), format, &timeinfo) == 0) return nullptr;
+  return strdup(buffer);
+}
+
+char* concat_strings_div(char* str1, char* str2, const char* divider)
+{
+  if (!str1) return malloc_string(str2);
+  if (!str2) return malloc_string(str1);
+  return malloc_stringf("%s%s%s", str1, divider ? divider : "", str2);
+}
+
+char* _ui64toa(uint64_t value, char* buffer, int radix)
+{
+  char digits[65];
+  int len = 0;
+  do {
+    int digit = (int)(value % radix);
+    digits[len++] = digit < 10 ? '0' + digit : 'a' + digit - 10;
+    value /= radix;
+  } while (value > 0);
+  for (int i = 0; i < len; i++) {
+    buffer[i] = digits[len - i - 1];
+  };
+  buffer[len] = 0;
+  return buffer;
+}
+
+size_t time2str(const char* format, time_t* value, char* buffer, size_t buffer_size)
+{
+  struct tm timeinfo;
+  localtime_r(value, &timeinfo);
+  return strftime(buffer, buffer_size, format, &timeinfo);
+}
@@ -0,0 +1,248 @@
+/*
+   EN: Test of the CBOR document: the data is published in JSON and CBOR by the same library build, the CBOR document
+       is decoded and compared with the source data, full and partial documents. For each data set, one line of JSON
+       is printed with the sizes of both documents: pinger_test_cbor
+   RU: Тест документа CBOR: данные публикуются в JSON и CBOR одной сборкой библиотеки, документ CBOR декодируется
+       и сравнивается с исходными данными, полный и частичный документы. Для каждого набора данных выводится одна
+       строка JSON с размерами обоих документов: pinger_test_cbor
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "project_config.h"
+#include "rePinger.h"
+#include "rePingerMqtt.h"
+#include "rePingerCbor.h"
+#include "host.h"
+
+#if !CONFIG_MQTT_PINGER_AS_JSON || !CONFIG_MQTT_PINGER_AS_CBOR || CONFIG_MQTT_PINGER_DELTA
+#error "The test requires CONFIG_MQTT_PINGER_AS_JSON = 1, CONFIG_MQTT_PINGER_AS_CBOR = 1 and CONFIG_MQTT_PINGER_DELTA = 0"
+#endif // CONFIG_MQTT_PINGER_AS_JSON
+
+typedef enum {
+  TEST_TYPICAL = 0,     // Three hosts, all available
+  TEST_DEGRADED,        // Three hosts, one is unavailable, internet is slowed
+  TEST_OUTAGE,          // Three hosts, all are unavailable
+  TEST_MAXIMUM,         // CONFIG_PINGER_HOSTS_MAX hosts
+  TEST_QUORUM,          // Three hosts, the last one is skipped by the quorum
+  TEST_SETS_COUNT
+} test_set_t;
+
+static const char* _testSetNames[TEST_SETS_COUNT] = { "typical", "degraded", "outage", "maximum", "quorum" };
+static char _testHostNames[CONFIG_PINGER_HOSTS_MAX][32];
+
+static size_t _jsonSize = 0;
+static uint8_t _cborBuffer[PINGER_CBOR_SIZE_MAX];
+static size_t _cborSize = 0;
+static uint32_t _failures = 0;
+
+static void testSink(const char* topic, const char* payload, size_t size)
+{
+  if (topic && (strcmp(topic, mqttTopicPingerGet()) == 0)) _jsonSize = size;
+}
+
+static bool testRawPublish(const char* topic, const uint8_t* payload, size_t size, int qos, bool retained)
+{
+  _cborSize = size <= sizeof(_cborBuffer) ? size : 0;
+  if (_cborSize > 0) memcpy(_cborBuffer, payload, size);
+  return true;
+}
+
+static void testFillData(pinger_publish_data_t* data, test_set_t set)
+{
+  memset(data, 0, sizeof(pinger_publish_data_t));
+  data->hosts_count = set == TEST_MAXIMUM ? CONFIG_PINGER_HOSTS_MAX : 3;
+  for (uint8_t i = 0; i < data->hosts_count; i++) {
+    ping_host_data_t* host = &data->hosts[i];
+    pinger_host_stats_t* stats = &data->hosts_stats[i];
+    bool down = (set == TEST_OUTAGE) || ((set == TEST_DEGRADED) && (i == 1));
+    host->host_name = _testHostNames[i];
+    host->state = down ? PING_UNAVAILABLE : PING_OK;
+    host->transmitted = 10;
+    host->received = down ? 0 : 9 + i % 2;
+    host->loss = 100.0f * (host->transmitted - host->received) / host->transmitted;
+    host->duration_ms = down ? 0 : 15 + 7 * i;
+    host->total_time_ms = host->duration_ms * host->received;
+    host->ttl = down ? 0 : 56 + i;
+    host->time_unavailable = down ? 1700000000 + i : 0;
+    stats->duration_us = host->duration_ms * 1000 + 321;
+    stats->rtt_p50_us = down ? 0 : stats->duration_us - 500;
+    stats->rtt_p95_us = down ? 0 : stats->duration_us + 4000;
+    stats->rtt_p99_us = down ? 0 : stats->duration_us + 9000;
+    stats->rtt_mdev_us = down ? 0 : 1200 + i;
+    stats->jitter_us = down ? 0 : 800 + i;
+    stats->replies_late = i;
+    stats->late_rtt_us = i > 0 ? 1500000 + i : 0;
+    stats->replies_duplicate = i % 2;
+    stats->replies_reordered = i % 3;
+    if ((set == TEST_QUORUM) && (i == data->hosts_count - 1)) {
+      memset(host, 0, sizeof(ping_host_data_t));
+      memset(stats, 0, sizeof(pinger_host_stats_t));
+      host->host_name = _testHostNames[i];
+      stats->skipped = true;
+    };
+  };
+  data->inet.state = set == TEST_OUTAGE ? PING_UNAVAILABLE : (set == TEST_DEGRADED ? PING_SLOWDOWN : PING_OK);
+  data->inet.hosts_count = data->hosts_count;
+  data->inet_stats.hosts_checked = set == TEST_QUORUM ? data->hosts_count - 1 : data->hosts_count;
+  data->inet.duration_ms_min = data->hosts[0].duration_ms;
+  data->inet.duration_ms_max = data->hosts[data->hosts_count - 1].duration_ms;
+  data->inet.duration_ms_total = (data->inet.duration_ms_min + data->inet.duration_ms_max) / 2;
+  data->inet.loss_min = set == TEST_OUTAGE ? 100.0f : 0.0f;
+  data->inet.loss_max = set == TEST_TYPICAL ? 10.0f : 100.0f;
+  data->inet.loss_total = set == TEST_OUTAGE ? 100.0f : (set == TEST_DEGRADED ? 33.3f : 5.0f);
+  data->inet.time_unavailable = set == TEST_OUTAGE ? 1700000100 : 0;
+  data->inet.count_unavailable = set == TEST_OUTAGE ? 7 : 0;
+  data->inet_stats.rtt_mdev_us = 1500;
+  data->inet_stats.jitter_us = 900;
+}
+
+#define TEST_CHECK(name, cond) \
+  if (!(cond)) { \
+    fprintf(stderr, "%s: field %s does not match\n", label, name); \
+    _failures++; \
+  }
+
+static void testCompareInet(const char* label, const pinger_publish_data_t* src, const pinger_publish_data_t* dst)
+{
+  TEST_CHECK("inet.state", dst->inet.state == src->inet.state);
+  TEST_CHECK("inet.hosts_count", dst->inet.hosts_count == src->inet.hosts_count);
+  TEST_CHECK("inet.hosts_checked", dst->inet_stats.hosts_checked == src->inet_stats.hosts_checked);
+  TEST_CHECK("inet.duration_ms_min", dst->inet.duration_ms_min == src->inet.duration_ms_min);
+  TEST_CHECK("inet.duration_ms_max", dst->inet.duration_ms_max == src->inet.duration_ms_max);
+  TEST_CHECK("inet.duration_ms_total", dst->inet.duration_ms_total == src->inet.duration_ms_total);
+  TEST_CHECK("inet.loss_min", dst->inet.loss_min == src->inet.loss_min);
+  TEST_CHECK("inet.loss_max", dst->inet.loss_max == src->inet.loss_max);
+  TEST_CHECK("inet.loss_total", dst->inet.loss_total == src->inet.loss_total);
+  TEST_CHECK("inet.time_unavailable", dst->inet.time_unavailable == src->inet.time_unavailable);
+  TEST_CHECK("inet.count_unavailable", dst->inet.count_unavailable == src->inet.count_unavailable);
+  TEST_CHECK("inet.rtt_mdev_us", dst->inet_stats.rtt_mdev_us == src->inet_stats.rtt_mdev_us);
+  TEST_CHECK("inet.jitter_us", dst->inet_stats.jitter_us == src->inet_stats.jitter_us);
+}
+
+static void testCompareHost(const char* label, const pinger_publish_data_t* src, const pinger_publish_data_t* dst, uint8_t i)
+{
+  const ping_host_data_t* s = &src->hosts[i];
+  const ping_host_data_t* d = &dst->hosts[i];
+  const pinger_host_stats_t* ss = &src->hosts_stats[i];
+  const pinger_host_stats_t* ds = &dst->hosts_stats[i];
+  TEST_CHECK("host.name", d->host_name && (strcmp(d->host_name, s->host_name) == 0));
+  TEST_CHECK("host.skipped", ds->skipped == ss->skipped);
+  if (ss->skipped) {
+    TEST_CHECK("host.transmitted", d->transmitted == 0);
+    return;
+  };
+  TEST_CHECK("host.state", d->state == s->state);
+  TEST_CHECK("host.transmitted", d->transmitted == s->transmitted);
+  TEST_CHECK("host.received", d->received == s->received);
+  TEST_CHECK("host.ttl", d->ttl == s->ttl);
+  TEST_CHECK("host.duration_ms", d->duration_ms == s->duration_ms);
+  TEST_CHECK("host.loss", d->loss == s->loss);
+  TEST_CHECK("host.time_unavailable", d->time_unavailable == s->time_unavailable);
+  TEST_CHECK("host.rtt_p50_us", ds->rtt_p50_us == ss->rtt_p50_us);
+  TEST_CHECK("host.rtt_p95_us", ds->rtt_p95_us == ss->rtt_p95_us);
+  TEST_CHECK("host.rtt_p99_us", ds->rtt_p99_us == ss->rtt_p99_us);
+  TEST_CHECK("host.rtt_mdev_us", ds->rtt_mdev_us == ss->rtt_mdev_us);
+  TEST_CHECK("host.jitter_us", ds->jitter_us == ss->jitter_us);
+  TEST_CHECK("host.replies_late", ds->replies_late == ss->replies_late);
+  TEST_CHECK("host.late_rtt_us", ds->late_rtt_us == ss->late_rtt_us);
+  TEST_CHECK("host.replies_duplicate", ds->replies_duplicate == ss->replies_duplicate);
+  TEST_CHECK("host.replies_reordered", ds->replies_reordered == ss->replies_reordered);
+}
+
+// Full document, as it is published
+static void testFull(test_set_t set)
+{
+  const char* label = _testSetNames[set];
+  pinger_publish_data_t src, dst;
+  bool parts[CONFIG_PINGER_HOSTS_MAX + 1];
+  char names[CONFIG_PINGER_HOSTS_MAX * 32];
+  uint32_t failures = _failures;
+
+  testFillData(&src, set);
+  _jsonSize = 0;
+  _cborSize = 0;
+  pingerMqttPublish(&src);
+  if ((_jsonSize == 0) || (_cborSize == 0)) {
+    fprintf(stderr, "%s: document was not published\n", label);
+    _failures++;
+  } else {
+    memset(&dst, 0, sizeof(dst));
+    if (!pingerCborDecode(_cborBuffer, _cborSize, &dst, parts, names, sizeof(names))) {
+      fprintf(stderr, "%s: document was not decoded\n", label);
+      _failures++;
+    } else {
+      TEST_CHECK("hosts_count", dst.hosts_count == src.hosts_count);
+      for (uint8_t i = 0; i <= src.hosts_count; i++) {
+        TEST_CHECK("parts", parts[i]);
+      };
+      testCompareInet(label, &src, &dst);
+      for (uint8_t i = 0; i < src.hosts_count; i++) {
+        testCompareHost(label, &src, &dst, i);
+      };
+    };
+  };
+
+  printf("{\"test\":\"cbor_roundtrip\",\"data\":\"%s\",\"hosts\":%u,\"json_bytes\":%u,\"cbor_bytes\":%u,\"failures\":%u}\n",
+    label, src.hosts_count, (unsigned)_jsonSize, (unsigned)_cborSize, _failures - failures);
+}
+
+// Partial document: only the selected subtrees are present, the other fields of the target are not changed
+static void testPartial(test_set_t set)
+{
+  const char* label = _testSetNames[set];
+  pinger_publish_data_t src, dst;
+  bool select[CONFIG_PINGER_HOSTS_MAX + 1];
+  bool parts[CONFIG_PINGER_HOSTS_MAX + 1];
+  char names[CONFIG_PINGER_HOSTS_MAX * 32];
+
+  testFillData(&src, set);
+  for (uint8_t i = 0; i <= src.hosts_count; i++) {
+    select[i] = (i % 2) == 1;
+  };
+  size_t size = pingerCborEncode(_cborBuffer, sizeof(_cborBuffer), &src, select);
+  TEST_CHECK("size", (size > 0) && (size == pingerCborEncode(nullptr, 0, &src, select)));
+  memset(&dst, 0, sizeof(dst));
+  if (!pingerCborDecode(_cborBuffer, size, &dst, parts, names, sizeof(names))) {
+    fprintf(stderr, "%s: partial document was not decoded\n", label);
+    _failures++;
+    return;
+  };
+  for (uint8_t i = 0; i <= src.hosts_count; i++) {
+    TEST_CHECK("parts", parts[i] == select[i]);
+  };
+  TEST_CHECK("inet.state", dst.inet.state == PING_OK);
+  TEST_CHECK("inet.duration_ms_min", dst.inet.duration_ms_min == 0);
+  for (uint8_t i = 0; i < src.hosts_count; i++) {
+    if (select[i + 1]) {
+      testCompareHost(label, &src, &dst, i);
+    } else {
+      TEST_CHECK("host.name", dst.hosts[i].host_name == nullptr);
+      TEST_CHECK("host.transmitted", dst.hosts[i].transmitted == 0);
+    };
+  };
+
+  // A document that is cut off is rejected
+  TEST_CHECK("truncated", !pingerCborDecode(_cborBuffer, size - 1, &dst, nullptr, names, sizeof(names)));
+}
+
+int main(int argc, char* argv[])
+{
+  hostLogSetLevel(0);
+  hostOutputSetSink(testSink);
+  for (uint8_t i = 0; i < CONFIG_PINGER_HOSTS_MAX; i++) {
+    snprintf(_testHostNames[i], sizeof(_testHostNames[i]), "host%u.example.com", i + 1);
+  };
+
+  pingerMqttSetRawPublisher(testRawPublish);
+  mqttTopicPingerCreate(true);
+  for (uint8_t set = 0; set < TEST_SETS_COUNT; set++) {
+    testFull((test_set_t)set);
+    testPartial((test_set_t)set);
+  };
+  mqttTopicPingerFree();
+
+  printf("{\"test\":\"cbor_roundtrip\",\"failures\":%u}\n", _failures);
+  return _failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
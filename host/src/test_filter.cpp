@@ -0,0 +1,70 @@
+/*
+   EN: Test of the median filter: the sliding median over random windows is compared with the median of a sorted copy 
+       of the window. The window size is set at compile time, so each size is a separate executable: pinger_test_filter_N [seed]
+   RU: Тест медианного фильтра: скользящая медиана на случайных окнах сравнивается с медианой отсортированной копии 
+       окна. Размер окна задается при компиляции, поэтому для каждого размера своя программа: pinger_test_filter_N [seed]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "rePingerFilter.h"
+
+#if CONFIG_PINGER_FILTER_MODE != PINGER_FILTER_MEDIAN
+#error "The test requires CONFIG_PINGER_FILTER_MODE = PINGER_FILTER_MEDIAN"
+#endif // CONFIG_PINGER_FILTER_MODE
+
+#define TEST_RUNS 200
+#define TEST_STEPS 1000
+
+// Reference: median of the sorted copy, the average of the two middle values for an even count
+static float testMedian(const float* window, uint16_t count)
+{
+  float sorted[CONFIG_PINGER_FILTER_SIZE];
+  for (uint16_t i = 0; i < count; i++) {
+    uint16_t j = i;
+    while ((j > 0) && (sorted[j - 1] > window[i])) {
+      sorted[j] = sorted[j - 1];
+      j--;
+    };
+    sorted[j] = window[i];
+  };
+  if (count & 1) return sorted[count / 2];
+  return (sorted[count / 2] + sorted[count / 2 - 1]) / 2;
+}
+
+int main(int argc, char* argv[])
+{
+  unsigned seed = argc > 1 ? (unsigned)strtoul(argv[1], nullptr, 0) : 1;
+  srand(seed);
+
+  uint32_t checks = 0;
+  uint32_t failures = 0;
+  for (uint32_t run = 0; run < TEST_RUNS; run++) {
+    pinger_filter_t filter;
+    pingerFilterReset(&filter);
+    float window[CONFIG_PINGER_FILTER_SIZE];
+    uint16_t count = 0;
+    uint16_t index = 0;
+    // A narrow range gives many equal values, a wide one - distinct values
+    int range = (run & 1) ? 8 : 100000;
+    for (uint32_t step = 0; step < TEST_STEPS; step++) {
+      float value = (float)(rand() % range) / 4;
+      window[index] = value;
+      if (++index >= CONFIG_PINGER_FILTER_SIZE) index = 0;
+      if (count < CONFIG_PINGER_FILTER_SIZE) count++;
+
+      float expected = testMedian(window, count);
+      float actual = pingerFilterUpdate(&filter, value);
+      checks++;
+      if (actual != expected) {
+        if (failures++ < 10) {
+          printf("run %u, step %u: median %g, expected %g\n", run, step, actual, expected);
+        };
+      };
+    };
+  };
+
+  printf("{\"test\":\"filter_median\",\"size\":%d,\"seed\":%u,\"checks\":%u,\"failures\":%u}\n", 
+    CONFIG_PINGER_FILTER_SIZE, seed, checks, failures);
+  return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
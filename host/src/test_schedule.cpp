@@ -0,0 +1,121 @@
+/*
+   EN: Test of the mixed schedule on the virtual network: the gateway is checked on its own schedule, two public hosts
+       by the internet check round. First the gateway responds and the public hosts do not: the state of the internet
+       must not change between the rounds. Then the gateway fails too: its own event and the outage must be posted.
+       The result is printed in JSON: pinger_test_schedule [seed]
+   RU: Тест смешанного расписания на виртуальной сети: шлюз проверяется по своему расписанию, два публичных хоста -
+       кругом проверки интернета. Сначала шлюз отвечает, а публичные хосты нет: состояние интернета не должно меняться
+       между кругами. Затем отказывает и шлюз: должны быть отправлены его собственное событие и событие отказа.
+       Результат выводится в JSON: pinger_test_schedule [seed]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "project_config.h"
+#include "reEvents.h"
+#include "rePinger.h"
+#include "rePingerMqtt.h"
+#include "host.h"
+#include "simnet.h"
+
+#define TEST_GATEWAY "gw.sim"
+#define TEST_PHASE_US (2000LL * 1000000)
+
+static const sim_host_profile_t _testUp = { SIM_DELAY_NORMAL, 5000, 1000, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0, 1000, false, 64 };
+static const sim_host_profile_t _testDown = { SIM_DELAY_NORMAL, 30000, 5000, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0, 20000, false, 54 };
+
+static uint32_t _inetEvents = 0;
+static ping_state_t _inetState = PING_OK;
+static uint32_t _gatewayUnavailable = 0;
+static uint32_t _publications = 0;
+
+static void testEventHandler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data)
+{
+  switch (event_id) {
+    case RE_PING_INET_AVAILABLE:
+    case RE_PING_INET_SLOWDOWN:
+    case RE_PING_INET_UNAVAILABLE:
+      _inetEvents++;
+      _inetState = event_id == RE_PING_INET_AVAILABLE ? PING_OK : (event_id == RE_PING_INET_SLOWDOWN ? PING_SLOWDOWN : PING_UNAVAILABLE);
+      break;
+    case RE_PING_HOST_UNAVAILABLE:
+      if (strcmp(((ping_host_data_t*)event_data)->host_name, TEST_GATEWAY) == 0) _gatewayUnavailable++;
+      break;
+    default:
+      break;
+  };
+}
+
+static void testSink(const char* topic, const char* payload, size_t size)
+{
+  if (topic && (strcmp(topic, mqttTopicPingerGet()) == 0)) _publications++;
+}
+
+// Cycles until the virtual time passes the end of the phase
+static uint32_t testRun(int64_t end)
+{
+  uint32_t cycles = 0;
+  while (hostClockNow() < end) {
+    uint32_t interval = pingerCycleExec();
+    hostClockAdvanceTo(hostClockNow() + (int64_t)interval * 1000);
+    cycles++;
+  };
+  return cycles;
+}
+
+int main(int argc, char* argv[])
+{
+  uint64_t seed = argc > 1 ? strtoull(argv[1], nullptr, 0) : 1;
+  hostLogSetLevel(0);
+  hostOutputSetSink(testSink);
+  simNetStart(seed);
+  hostRandomSeed(seed);
+  simNetHostSet(TEST_GATEWAY, &_testUp);
+  simNetHostSet("b.sim", &_testDown);
+  simNetHostSet("c.sim", &_testDown);
+  setenv("PING_HOSTS", TEST_GATEWAY "/5,b.sim,c.sim", 1);
+  eventHandlerRegister(RE_PING_EVENTS, ESP_EVENT_ANY_ID, testEventHandler, nullptr);
+  mqttTopicPingerCreate(true);
+  pingerCycleInit();
+  uint32_t failures = 0;
+
+  // The state of the internet is determined by the first round and does not change afterwards
+  uint32_t cycles = testRun(hostClockNow() + TEST_PHASE_US);
+  if (_inetEvents > 1) {
+    fprintf(stderr, "Internet state changed %u times while the network did not change\n", _inetEvents);
+    failures++;
+  };
+  if (_publications >= cycles) {
+    fprintf(stderr, "Results were published on every cycle (%u of %u), not only by the rounds\n", _publications, cycles);
+    failures++;
+  };
+  if (_gatewayUnavailable > 0) {
+    fprintf(stderr, "Gateway was reported unavailable while it responded\n");
+    failures++;
+  };
+  printf("{\"test\":\"schedule_stable\",\"cycles\":%u,\"publications\":%u,\"inet_events\":%u,\"failures\":%u}\n",
+    cycles, _publications, _inetEvents, failures);
+
+  // The gateway fails as well: it is reported by its own schedule, and the internet is unavailable
+  uint32_t stable = failures;
+  simNetHostSet(TEST_GATEWAY, &_testDown);
+  _inetEvents = 0;
+  _publications = 0;
+  cycles = testRun(hostClockNow() + TEST_PHASE_US);
+  if (_gatewayUnavailable != 1) {
+    fprintf(stderr, "Gateway was reported unavailable %u times instead of once\n", _gatewayUnavailable);
+    failures++;
+  };
+  if ((_inetEvents == 0) || (_inetState != PING_UNAVAILABLE)) {
+    fprintf(stderr, "Outage was not reported\n");
+    failures++;
+  };
+  printf("{\"test\":\"schedule_outage\",\"cycles\":%u,\"publications\":%u,\"inet_events\":%u,\"failures\":%u}\n",
+    cycles, _publications, _inetEvents, failures - stable);
+
+  pingerCycleFree();
+  mqttTopicPingerFree();
+  simNetStop();
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -12,6 +12,91 @@
 #include "time.h"
 #include "project_config.h"
 #include "def_consts.h"
+#include "reEvents.h"
+
+// Maximum number of public servers for checking Internet access
+#ifndef CONFIG_PINGER_HOSTS_MAX
+#define CONFIG_PINGER_HOSTS_MAX 16
+#endif // CONFIG_PINGER_HOSTS_MAX
+
+// Maximum length of the host name
+#ifndef CONFIG_PINGER_HOSTNAME_MAX
+#define CONFIG_PINGER_HOSTNAME_MAX 64
+#endif // CONFIG_PINGER_HOSTNAME_MAX
+
+// Default list of public servers (separated by commas), can be changed via parameters. A host may have its own schedule 
+// "host/interval/count/priority": interval in seconds (0 - with the internet check), number of requests (0 - from the parameters), 
+// priority of the host among those due at the same time
+#ifndef CONFIG_PINGER_HOSTS
+  #if defined(CONFIG_PINGER_HOST_3)
+    #define CONFIG_PINGER_HOSTS CONFIG_PINGER_HOST_1 "," CONFIG_PINGER_HOST_2 "," CONFIG_PINGER_HOST_3
+  #elif defined(CONFIG_PINGER_HOST_2)
+    #define CONFIG_PINGER_HOSTS CONFIG_PINGER_HOST_1 "," CONFIG_PINGER_HOST_2
+  #elif defined(CONFIG_PINGER_HOST_1)
+    #define CONFIG_PINGER_HOSTS CONFIG_PINGER_HOST_1
+  #else
+    #define CONFIG_PINGER_HOSTS ""
+  #endif
+#endif // CONFIG_PINGER_HOSTS
+
+// Additional statistics of the host, which are not included in the event data
+typedef struct {
+  uint32_t duration_us;       // Average response time in the last batch, us
+  uint32_t rtt_p50_us;        // Rolling percentiles of the response time, us
+  uint32_t rtt_p95_us;
+  uint32_t rtt_p99_us;
+  uint32_t rtt_mdev_us;       // Standard deviation of the response time in the last batch, us
+  uint32_t jitter_us;         // Interarrival jitter (RFC 3550), us
+  // Counters since the host was added to the list. A late reply is not taken into account in the loss of its batch
+  uint32_t replies_late;      // Replies that came after their request was counted as lost
+  uint32_t replies_duplicate; // Repeated replies to the same request
+  uint32_t replies_reordered; // Replies that came after a reply to a later request
+  uint32_t late_rtt_us;       // Response time of the last late reply, us
+  bool skipped;               // No result in this round (skipped by the quorum or not checked yet), only the name is valid
+} pinger_host_stats_t;
+
+// Additional statistics of the internet access, the variation is averaged over the hosts that responded
+typedef struct {
+  uint32_t rtt_mdev_us;
+  uint32_t jitter_us;
+  uint8_t hosts_checked;      // Hosts whose results were used in the evaluation, of inet.hosts_count in the list
+} pinger_inet_stats_t;
+
+typedef struct {
+  ping_inet_data_t inet;
+  pinger_inet_stats_t inet_stats;
+  uint8_t hosts_count;
+  ping_host_data_t hosts[CONFIG_PINGER_HOSTS_MAX];
+  pinger_host_stats_t hosts_stats[CONFIG_PINGER_HOSTS_MAX];
+} pinger_publish_data_t;
+
+// Timing of the phases of the check cycle, for diagnostics. When disabled, the timers are not compiled at all
+#ifndef CONFIG_PINGER_PHASE_TIMING
+#define CONFIG_PINGER_PHASE_TIMING 0
+#endif // CONFIG_PINGER_PHASE_TIMING
+
+// Number of the last check cycles over which the maximum time of the phases is taken
+#ifndef CONFIG_PINGER_PHASE_WINDOW
+#define CONFIG_PINGER_PHASE_WINDOW 16
+#endif // CONFIG_PINGER_PHASE_WINDOW
+
+#if CONFIG_PINGER_PHASE_TIMING
+typedef enum {
+  PINGER_PHASE_DNS = 0,       // Name resolution (waiting for hosts without a known address)
+  PINGER_PHASE_SOCKET,        // Attaching the hosts to the shared sockets, opening them if needed
+  PINGER_PHASE_PROBES,        // Sending requests, waiting for replies and calculating the results
+  PINGER_PHASE_EVENTS,        // Posting events to the event loop
+  PINGER_PHASE_PUBLISH,       // Publishing results (MQTT, open-monitoring)
+  PINGER_PHASE_CYCLE,         // Entire check cycle
+  PINGER_PHASE_MAX
+} pinger_phase_t;
+
+typedef struct {
+  uint32_t cycles;
+  uint32_t last_us[PINGER_PHASE_MAX];   // Time of the phases in the last cycle, us
+  uint32_t max_us[PINGER_PHASE_MAX];    // Maximum over the last CONFIG_PINGER_PHASE_WINDOW cycles, us
+} pinger_phases_t;
+#endif // CONFIG_PINGER_PHASE_TIMING
 
 #ifdef __cplusplus
 extern "C" {
@@ -24,6 +109,23 @@ bool pingerTaskDelete();
 
 bool pingerEventHandlerRegister();
 
+/**
+ * Checks without the task, in the calling thread (host build, network simulator):
+ * pingerCycleInit() - once before the first check, pingerCycleExec() - check of the targets that are due 
+ * (the internet check round and the hosts on their own schedule) with publication of the results, returns the time 
+ * until the nearest target is due in ms. pingerCycleRestart() - the next result is 
+ * considered the first one (after a pause)
+ **/
+bool pingerCycleInit();
+uint32_t pingerCycleExec();
+void pingerCycleRestart();
+void pingerCycleFree();
+
+#if CONFIG_PINGER_PHASE_TIMING
+// Copy of the phase timers at the end of the last check cycle
+void pingerPhasesGet(pinger_phases_t* phases);
+#endif // CONFIG_PINGER_PHASE_TIMING
+
 #ifdef __cplusplus
 }
 #endif
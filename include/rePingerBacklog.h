@@ -0,0 +1,79 @@
+/*
+   EN: Storage of ping results while the MQTT broker is not available, for publication after reconnection
+   RU: Хранение результатов пинга на время недоступности MQTT брокера для публикации после восстановления связи
+   --------------------------
+   (с) 2021 Разживин Александр | Razzhivin Alexander
+   kotyara12@yandex.ru | https://kotyara12.ru | tg: @kotyara1971
+*/
+
+#ifndef __RE_PINGERBACKLOG_H__
+#define __RE_PINGERBACKLOG_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "project_config.h"
+#include "def_consts.h"
+#include "rePinger.h"
+
+// Results are accumulated while they cannot be published and are sent in batches after reconnection
+#ifndef CONFIG_MQTT_PINGER_BACKLOG
+#define CONFIG_MQTT_PINGER_BACKLOG 0
+#endif // CONFIG_MQTT_PINGER_BACKLOG
+
+#if CONFIG_MQTT_PINGER_BACKLOG
+
+// Number of records in RAM
+#ifndef CONFIG_MQTT_PINGER_BACKLOG_SIZE
+#define CONFIG_MQTT_PINGER_BACKLOG_SIZE 64
+#endif // CONFIG_MQTT_PINGER_BACKLOG_SIZE
+
+/**
+ * When the ring in RAM is full, the oldest records are moved to the data partition with the specified label
+ * (for example, "pinger", at least two sectors). If the label is not defined, the oldest records are lost.
+ * Previous contents of the partition are ignored: records are not restored after a restart
+ **/
+// #define CONFIG_MQTT_PINGER_BACKLOG_PARTITION "pinger"
+
+// State of a host without a result in the cycle (skipped by the quorum or not checked yet)
+#define PINGER_BACKLOG_SKIPPED 0xFF
+
+// Compact result of one check cycle: durations in ms, losses in hundredths of a percent
+typedef struct {
+  uint32_t time;
+  uint16_t duration_ms;
+  uint16_t loss;
+  uint8_t state;
+  uint8_t hosts_count;
+  struct {
+    uint16_t duration_ms;
+    uint16_t loss;
+    uint8_t state;
+  } hosts[CONFIG_PINGER_HOSTS_MAX];
+} pinger_record_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool pingerBacklogInit();
+
+// Add a record, the oldest one is discarded if there is no space left
+void pingerBacklogPut(const pinger_publish_data_t* data);
+
+// Number of stored records
+uint32_t pingerBacklogCount();
+
+// Read the record with the specified index starting from the oldest one
+bool pingerBacklogPeek(uint32_t index, pinger_record_t* record);
+
+// Remove the oldest records, after they have been published
+void pingerBacklogDrop(uint32_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CONFIG_MQTT_PINGER_BACKLOG
+
+#endif // __RE_PINGERBACKLOG_H__
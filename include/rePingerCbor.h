@@ -0,0 +1,88 @@
+/*
+   EN: Compact binary encoding of ping results (CBOR, RFC 8949) without memory allocations
+   RU: Компактное двоичное кодирование результатов пинга (CBOR, RFC 8949) без выделения памяти
+   --------------------------
+   (с) 2021 Разживин Александр | Razzhivin Alexander
+   kotyara12@yandex.ru | https://kotyara12.ru | tg: @kotyara1971
+*/
+
+#ifndef __RE_PINGERCBOR_H__
+#define __RE_PINGERCBOR_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "project_config.h"
+#include "def_consts.h"
+#include "rePinger.h"
+
+/**
+ * Document structure: map { 0: internet, 1..N: host N }, all keys are integers.
+ * Numbers have a fixed width regardless of the value: states and TTL - uint8, counters,
+ * durations (ms) and RTT statistics (us) - uint32, losses - float32, timestamps - uint64.
+ * The timestamp (and the counter for the internet) is present only in the PING_UNAVAILABLE and PING_FAILED states.
+ * A host without a result in this round has only the name and the "skipped" flag
+ **/
+
+// Maximum document size: internet ~105 bytes, host ~115 bytes plus the name
+#define PINGER_CBOR_SIZE_MAX (128 + CONFIG_PINGER_HOSTS_MAX * (120 + CONFIG_PINGER_HOSTNAME_MAX))
+
+typedef enum {
+  PINGER_CBOR_INET_STATE = 0,
+  PINGER_CBOR_INET_DURATION_MIN,
+  PINGER_CBOR_INET_DURATION_MAX,
+  PINGER_CBOR_INET_DURATION_TOTAL,
+  PINGER_CBOR_INET_LOSS_MIN,
+  PINGER_CBOR_INET_LOSS_MAX,
+  PINGER_CBOR_INET_LOSS_TOTAL,
+  PINGER_CBOR_INET_RTT_MDEV,
+  PINGER_CBOR_INET_JITTER,
+  PINGER_CBOR_INET_TIME_UNAVAILABLE,
+  PINGER_CBOR_INET_COUNT_UNAVAILABLE,
+  PINGER_CBOR_INET_HOSTS_COUNT,
+  PINGER_CBOR_INET_HOSTS_CHECKED
+} pinger_cbor_inet_key_t;
+
+typedef enum {
+  PINGER_CBOR_HOST_NAME = 0,
+  PINGER_CBOR_HOST_STATE,
+  PINGER_CBOR_HOST_TRANSMITTED,
+  PINGER_CBOR_HOST_RECEIVED,
+  PINGER_CBOR_HOST_TTL,
+  PINGER_CBOR_HOST_DURATION,
+  PINGER_CBOR_HOST_LOSS,
+  PINGER_CBOR_HOST_RTT_P50,
+  PINGER_CBOR_HOST_RTT_P95,
+  PINGER_CBOR_HOST_RTT_P99,
+  PINGER_CBOR_HOST_RTT_MDEV,
+  PINGER_CBOR_HOST_JITTER,
+  PINGER_CBOR_HOST_TIME_UNAVAILABLE,
+  PINGER_CBOR_HOST_REPLIES_LATE,
+  PINGER_CBOR_HOST_REPLIES_LATE_RTT,
+  PINGER_CBOR_HOST_REPLIES_DUPLICATE,
+  PINGER_CBOR_HOST_REPLIES_REORDERED,
+  PINGER_CBOR_HOST_SKIPPED
+} pinger_cbor_host_key_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Encode the data into the buffer. Subtrees: 0 - internet, 1.. - hosts, if "parts" is not specified, the full document is encoded.
+ * Returns the length of the document, or 0 if the buffer is too small. With buffer = nullptr, only the required size is calculated
+ **/
+size_t pingerCborEncode(uint8_t* buffer, size_t size, pinger_publish_data_t* data, const bool* parts);
+
+/**
+ * Decode the document. Fields that are absent in the document are not changed, "hosts_count" is increased to the last host found.
+ * Host names are copied to "names" and terminated with zero.
+ * Subtrees that are present in the document are marked in "parts" (optional, CONFIG_PINGER_HOSTS_MAX + 1 elements)
+ **/
+bool pingerCborDecode(const uint8_t* buffer, size_t size, pinger_publish_data_t* data, bool* parts, char* names, size_t names_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __RE_PINGERCBOR_H__
@@ -0,0 +1,62 @@
+/*
+   EN: Cache of IP addresses of checked hosts with asynchronous resolution
+   RU: Кэш IP-адресов проверяемых хостов с асинхронным разрешением имен
+   --------------------------
+   (с) 2021 Разживин Александр | Razzhivin Alexander
+   kotyara12@yandex.ru | https://kotyara12.ru | tg: @kotyara1971
+*/
+
+#ifndef __RE_PINGERDNS_H__
+#define __RE_PINGERDNS_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "project_config.h"
+#include "def_consts.h"
+#include "freertos/FreeRTOS.h"
+#include "lwip/ip_addr.h"
+#include "rePinger.h"
+
+// Number of cache entries: public servers and MQTT brokers
+#ifndef CONFIG_PINGER_DNS_CACHE_SIZE
+#define CONFIG_PINGER_DNS_CACHE_SIZE (CONFIG_PINGER_HOSTS_MAX + 2)
+#endif // CONFIG_PINGER_DNS_CACHE_SIZE
+
+// Maximum waiting time for hosts whose address is not yet known at all, ms. Other hosts are never waited for
+#ifndef CONFIG_PINGER_DNS_TIMEOUT
+#define CONFIG_PINGER_DNS_TIMEOUT 3000
+#endif // CONFIG_PINGER_DNS_TIMEOUT
+
+// Minimum interval between repeated requests for the same host, ms
+#ifndef CONFIG_PINGER_DNS_RETRY
+#define CONFIG_PINGER_DNS_RETRY 10000
+#endif // CONFIG_PINGER_DNS_RETRY
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool pingerDnsInit();
+void pingerDnsFree();
+
+/**
+ * Start resolving the host name in the background if the cached address is missing or expired
+ * (CONFIG_PINGER_IP_VALIDITY), or if "refresh" is set. Does not block
+ **/
+void pingerDnsRequest(const char* hostname, bool refresh);
+
+/**
+ * Wait until the hosts without any known address are resolved, but no longer than "timeout"
+ **/
+void pingerDnsWait(TickType_t timeout);
+
+/**
+ * Get the cached address of the host. An expired address is returned too, while it is being refreshed
+ **/
+bool pingerDnsGet(const char* hostname, ip_addr_t* addr, TickType_t* resolved);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __RE_PINGERDNS_H__
@@ -0,0 +1,58 @@
+/*
+   EN: Smoothing filters of ping results with a sliding window
+   RU: Фильтры для сглаживания результатов пинга со скользящим окном
+   --------------------------
+   (с) 2021 Разживин Александр | Razzhivin Alexander
+   kotyara12@yandex.ru | https://kotyara12.ru | tg: @kotyara1971
+*/
+
+#ifndef __RE_PINGERFILTER_H__
+#define __RE_PINGERFILTER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "project_config.h"
+#include "def_consts.h"
+
+// Filter mode: 0 - disabled, 1 - average, 2 - median, 3 - exponential moving average (EWMA)
+#define PINGER_FILTER_NONE    0
+#define PINGER_FILTER_AVERAGE 1
+#define PINGER_FILTER_MEDIAN  2
+#define PINGER_FILTER_EWMA    3
+
+#if (CONFIG_PINGER_FILTER_MODE > 0) && (CONFIG_PINGER_FILTER_SIZE > 0)
+
+#if CONFIG_PINGER_FILTER_SIZE > 16383
+#error "CONFIG_PINGER_FILTER_SIZE is too large"
+#endif // CONFIG_PINGER_FILTER_SIZE
+
+typedef struct {
+  uint16_t count;                                 // Number of values in the window
+  #if CONFIG_PINGER_FILTER_MODE == PINGER_FILTER_AVERAGE
+    uint16_t index;                               // Position of the oldest value in the ring
+    float values[CONFIG_PINGER_FILTER_SIZE];      // Values in the order of arrival
+    double sum;                                   // Running sum of the window
+  #elif CONFIG_PINGER_FILTER_MODE == PINGER_FILTER_MEDIAN
+    uint16_t index;                               // Position of the oldest value in the ring
+    float values[CONFIG_PINGER_FILTER_SIZE];      // Values in the order of arrival
+    int16_t pos[CONFIG_PINGER_FILTER_SIZE];       // Position of each value in the heaps
+    uint16_t heap[CONFIG_PINGER_FILTER_SIZE];     // Max-heap (left), median, min-heap (right) of value indexes
+  #elif CONFIG_PINGER_FILTER_MODE == PINGER_FILTER_EWMA
+    float value;                                  // Current smoothed value
+  #endif // CONFIG_PINGER_FILTER_MODE
+} pinger_filter_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void pingerFilterReset(pinger_filter_t* filter);
+float pingerFilterUpdate(pinger_filter_t* filter, float value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CONFIG_PINGER_FILTER_MODE
+
+#endif // __RE_PINGERFILTER_H__
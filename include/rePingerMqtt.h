@@ -10,21 +10,113 @@
 #define __RE_PINGERMQTT_H__
 
 #include "reEvents.h"
+#include "rePinger.h"
+#include "rePingerRes.h"
 #include "project_config.h"
 #include "def_consts.h"
 
 #if CONFIG_MQTT_PINGER_ENABLE
 
+// Format of response time percentiles, in milliseconds
+#ifndef CONFIG_FORMAT_PING_RTT_VALUE
+#define CONFIG_FORMAT_PING_RTT_VALUE "%.1f"
+#endif // CONFIG_FORMAT_PING_RTT_VALUE
+
+// Change-driven publishing: a value is published only if it has changed beyond the deadband, 
+// state changes are published immediately. In JSON mode, only the changed subtrees are sent
+#ifndef CONFIG_MQTT_PINGER_DELTA
+#define CONFIG_MQTT_PINGER_DELTA 0
+#endif // CONFIG_MQTT_PINGER_DELTA
+
+// Absolute deadbands: response time in ms, losses in %, RTT statistics in ms
+#ifndef CONFIG_MQTT_PINGER_DEADBAND_DURATION
+#define CONFIG_MQTT_PINGER_DEADBAND_DURATION 5
+#endif // CONFIG_MQTT_PINGER_DEADBAND_DURATION
+#ifndef CONFIG_MQTT_PINGER_DEADBAND_LOSS
+#define CONFIG_MQTT_PINGER_DEADBAND_LOSS 1.0
+#endif // CONFIG_MQTT_PINGER_DEADBAND_LOSS
+#ifndef CONFIG_MQTT_PINGER_DEADBAND_RTT
+#define CONFIG_MQTT_PINGER_DEADBAND_RTT 2.0
+#endif // CONFIG_MQTT_PINGER_DEADBAND_RTT
+
+// Relative deadband in % of the last published value, the larger of the two deadbands is used
+#ifndef CONFIG_MQTT_PINGER_DEADBAND_RELATIVE
+#define CONFIG_MQTT_PINGER_DEADBAND_RELATIVE 10
+#endif // CONFIG_MQTT_PINGER_DEADBAND_RELATIVE
+
+// Maximum interval between publications of an unchanged value, s
+#ifndef CONFIG_MQTT_PINGER_HEARTBEAT
+#define CONFIG_MQTT_PINGER_HEARTBEAT 900
+#endif // CONFIG_MQTT_PINGER_HEARTBEAT
+
+// Size of the buffer of the JSON document, it is allocated once for the maximum number of hosts. 
+// A document that does not fit into it is not published
+#ifndef CONFIG_MQTT_PINGER_JSON_SIZE_MAX
+#define CONFIG_MQTT_PINGER_JSON_SIZE_MAX (512 + CONFIG_PINGER_HOSTS_MAX * (640 + CONFIG_PINGER_HOSTNAME_MAX))
+#endif // CONFIG_MQTT_PINGER_JSON_SIZE_MAX
+
+// Binary document (CBOR) in a subtopic, in addition to or instead of the JSON document
+#ifndef CONFIG_MQTT_PINGER_AS_CBOR
+#define CONFIG_MQTT_PINGER_AS_CBOR 0
+#endif // CONFIG_MQTT_PINGER_AS_CBOR
+#ifndef CONFIG_MQTT_PINGER_CBOR_TOPIC
+#define CONFIG_MQTT_PINGER_CBOR_TOPIC "cbor"
+#endif // CONFIG_MQTT_PINGER_CBOR_TOPIC
+
+// Backlog (CONFIG_MQTT_PINGER_BACKLOG, see rePingerBacklog.h): records per message and messages per check cycle
+#ifndef CONFIG_MQTT_PINGER_BACKLOG_TOPIC
+#define CONFIG_MQTT_PINGER_BACKLOG_TOPIC "backlog"
+#endif // CONFIG_MQTT_PINGER_BACKLOG_TOPIC
+#ifndef CONFIG_MQTT_PINGER_BACKLOG_BATCH
+#define CONFIG_MQTT_PINGER_BACKLOG_BATCH 16
+#endif // CONFIG_MQTT_PINGER_BACKLOG_BATCH
+#ifndef CONFIG_MQTT_PINGER_BACKLOG_MESSAGES
+#define CONFIG_MQTT_PINGER_BACKLOG_MESSAGES 4
+#endif // CONFIG_MQTT_PINGER_BACKLOG_MESSAGES
+
+// Diagnostics: time of the phases of the check cycle (CONFIG_PINGER_PHASE_TIMING) in a subtopic, in us
+#ifndef CONFIG_MQTT_PINGER_PHASES
+#define CONFIG_MQTT_PINGER_PHASES 0
+#endif // CONFIG_MQTT_PINGER_PHASES
+#ifndef CONFIG_MQTT_PINGER_PHASES_TOPIC
+#define CONFIG_MQTT_PINGER_PHASES_TOPIC "diag"
+#endif // CONFIG_MQTT_PINGER_PHASES_TOPIC
+
+// Resource counters (CONFIG_PINGER_RESOURCES, see rePingerRes.h) in a subtopic, not more often than the interval in seconds
+#ifndef CONFIG_MQTT_PINGER_RESOURCES
+#define CONFIG_MQTT_PINGER_RESOURCES 0
+#endif // CONFIG_MQTT_PINGER_RESOURCES
+#ifndef CONFIG_MQTT_PINGER_RESOURCES_TOPIC
+#define CONFIG_MQTT_PINGER_RESOURCES_TOPIC "resources"
+#endif // CONFIG_MQTT_PINGER_RESOURCES_TOPIC
+#ifndef CONFIG_MQTT_PINGER_RESOURCES_INTERVAL
+#define CONFIG_MQTT_PINGER_RESOURCES_INTERVAL 300
+#endif // CONFIG_MQTT_PINGER_RESOURCES_INTERVAL
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#if CONFIG_MQTT_PINGER_AS_CBOR
+/**
+ * mqttPublish() determines the length of the payload by the terminating zero, so binary data is sent 
+ * through a function that the application provides, for example, on top of esp_mqtt_client_publish()
+ **/
+typedef bool (*pinger_mqtt_raw_publish_t)(const char* topic, const uint8_t* payload, size_t size, int qos, bool retained);
+void pingerMqttSetRawPublisher(pinger_mqtt_raw_publish_t publisher);
+#endif // CONFIG_MQTT_PINGER_AS_CBOR
 
 char* mqttTopicPingerCreate(const bool primary);
 char* mqttTopicPingerGet();
 void  mqttTopicPingerFree();
 
-void pingerMqttPublish(ping_publish_data_t* data);
+void pingerMqttPublish(pinger_publish_data_t* data);
+#if CONFIG_PINGER_PHASE_TIMING && CONFIG_MQTT_PINGER_PHASES
+void pingerMqttPublishPhases(const pinger_phases_t* phases);
+#endif // CONFIG_MQTT_PINGER_PHASES
+#if CONFIG_PINGER_RESOURCES && CONFIG_MQTT_PINGER_RESOURCES
+void pingerMqttPublishResources(const pinger_resources_t* resources);
+#endif // CONFIG_MQTT_PINGER_RESOURCES
 
 bool pingerMqttRegister();
 
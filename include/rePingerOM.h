@@ -17,6 +17,7 @@
 #include "rStrings.h"
 #include "reEvents.h"
 #include "reDataSend.h"
+#include "rePinger.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -36,15 +37,10 @@ extern "C" {
  * #endif // CONFIG_OPENMON_PINGER_HEAP_FREE
  * 
  * #if CONFIG_OPENMON_PINGER_HOSTS
- * Статус хоста 1 (целое)
- * Задержка хоста 1 (целое)
- * Потери хоста 1 (число с запятой)
- * Статус хоста 2 (целое)           - если задан хост 2
- * Задержка хоста 2 (целое)         - если задан хост 2
- * Потери хоста 2 (число с запятой) - если задан хост 2
- * Статус хоста 3 (целое)           - если задан хост 3
- * Задержка хоста 3 (целое)         - если задан хост 3
- * Потери хоста 3 (число с запятой) - если задан хост 3
+ * Для каждого хоста из списка, в порядке списка:
+ * Статус хоста N (целое)
+ * Задержка хоста N (целое)
+ * Потери хоста N (число с запятой)
  * #endif // CONFIG_OPENMON_PINGER_HOSTS
  * 
  * Статус интернета (целое)
@@ -55,12 +51,17 @@ extern "C" {
  * Минимальные потери (число с запятой)
  * Максимальные потери (число с запятой)
  * 
+ * #if CONFIG_OPENMON_PINGER_JITTER
+ * Отклонение задержки, мс (число с запятой)
+ * Джиттер, мс (число с запятой)
+ * #endif // CONFIG_OPENMON_PINGER_JITTER
+ * 
  * ! Данные будут отправлены на сервер именно в этом порядке !
  * 
  **/
 
 void pingerOpenMonInit();
-void pingerOpenMonPublish(ping_publish_data_t* data);
+void pingerOpenMonPublish(pinger_publish_data_t* data);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,95 @@
+/*
+   EN: Accounting of the resources used by the pinger: heap blocks of the module, stack of the task, sockets, DNS lookups
+   RU: Учет ресурсов, используемых пингером: блоки кучи модуля, стек задачи, сокеты, запросы DNS
+   --------------------------
+   (с) 2021 Разживин Александр | Razzhivin Alexander
+   kotyara12@yandex.ru | https://kotyara12.ru | tg: @kotyara1971
+*/
+
+#ifndef __RE_PINGERRES_H__
+#define __RE_PINGERRES_H__
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "project_config.h"
+#include "def_consts.h"
+#include "reEsp32.h"
+
+// Resource counters, 0 - disabled: the macros below are replaced by the usual calls
+#ifndef CONFIG_PINGER_RESOURCES
+#define CONFIG_PINGER_RESOURCES 0
+#endif // CONFIG_PINGER_RESOURCES
+
+#if CONFIG_PINGER_RESOURCES
+
+typedef struct {
+  uint32_t cycles;
+  // Heap blocks of the module: own allocations and strings allocated for it by other libraries
+  uint32_t allocs;
+  uint32_t frees;
+  uint32_t alloc_bytes;
+  uint32_t used_blocks;
+  uint32_t used_bytes;
+  // Last check cycle
+  uint32_t cycle_allocs;
+  uint32_t cycle_frees;
+  uint32_t cycle_alloc_bytes;
+  int32_t cycle_heap_delta;     // Change of the free heap of the system during the cycle (other tasks are included)
+  uint32_t heap_free_min;       // Minimum free heap of the system at the end of a cycle
+  uint32_t stack_free_min;      // Stack high-water mark of the task executing the checks, bytes (0 - unknown)
+  // Sockets
+  uint32_t sockets_open;
+  uint32_t sockets_open_max;
+  uint32_t sockets_opened;
+  // Name resolution
+  uint32_t dns_lookups;         // Requests to the resolver
+  uint32_t dns_failed;          // Requests that were rejected at once or were answered without an address
+} pinger_resources_t;
+
+#define PINGER_MALLOC(size) pingerResMalloc(size)
+#define PINGER_CALLOC(count, size) pingerResCalloc(count, size)
+#define PINGER_TRACK(ptr) pingerResTrack(ptr)
+#define PINGER_FREE(ptr) pingerResFree(ptr)
+#define PINGER_RES_SOCKET(opened) pingerResSocket(opened)
+#define PINGER_RES_DNS(failed) pingerResDns(failed)
+
+#else
+
+#define PINGER_MALLOC(size) esp_malloc(size)
+#define PINGER_CALLOC(count, size) esp_calloc(count, size)
+#define PINGER_TRACK(ptr) (ptr)
+#define PINGER_FREE(ptr) free(ptr)
+#define PINGER_RES_SOCKET(opened)
+#define PINGER_RES_DNS(failed)
+
+#endif // CONFIG_PINGER_RESOURCES
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if CONFIG_PINGER_RESOURCES
+
+void* pingerResMalloc(size_t size);
+void* pingerResCalloc(size_t count, size_t size);
+// Count a block allocated by another library (malloc_string(), mqttGetSubTopic()), which the module will free
+char* pingerResTrack(char* ptr);
+void pingerResFree(void* ptr);
+
+void pingerResSocket(bool opened);
+void pingerResDns(bool failed);
+
+// Boundaries of the check cycle, are called from the task executing the checks
+void pingerResCycleBegin();
+void pingerResCycleEnd();
+
+void pingerResourcesGet(pinger_resources_t* resources);
+
+#endif // CONFIG_PINGER_RESOURCES
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __RE_PINGERRES_H__
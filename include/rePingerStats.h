@@ -0,0 +1,50 @@
+/*
+   EN: Streaming statistics of the response time with constant memory
+   RU: Потоковая статистика времени отклика с постоянным расходом памяти
+   --------------------------
+   (с) 2021 Разживин Александр | Razzhivin Alexander
+   kotyara12@yandex.ru | https://kotyara12.ru | tg: @kotyara1971
+*/
+
+#ifndef __RE_PINGERSTATS_H__
+#define __RE_PINGERSTATS_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "project_config.h"
+#include "def_consts.h"
+
+// Number of sub-buckets per octave as a power of two: 2 gives 4 sub-buckets and an error of no more than 12.5%
+#ifndef CONFIG_PINGER_HISTOGRAM_SUB_BITS
+#define CONFIG_PINGER_HISTOGRAM_SUB_BITS 2
+#endif // CONFIG_PINGER_HISTOGRAM_SUB_BITS
+
+// When the number of samples reaches this value, all counters are halved, so old samples gradually lose weight
+#ifndef CONFIG_PINGER_HISTOGRAM_WINDOW
+#define CONFIG_PINGER_HISTOGRAM_WINDOW 1000
+#endif // CONFIG_PINGER_HISTOGRAM_WINDOW
+
+// Values are limited to 2^27 us (134 seconds)
+#define PINGER_HISTOGRAM_VALUE_BITS 27
+#define PINGER_HISTOGRAM_SUB_COUNT (1 << CONFIG_PINGER_HISTOGRAM_SUB_BITS)
+#define PINGER_HISTOGRAM_BUCKETS ((PINGER_HISTOGRAM_VALUE_BITS - CONFIG_PINGER_HISTOGRAM_SUB_BITS + 1) * PINGER_HISTOGRAM_SUB_COUNT)
+
+// Histogram with logarithmic buckets
+typedef struct {
+  uint16_t total;
+  uint16_t buckets[PINGER_HISTOGRAM_BUCKETS];
+} pinger_histogram_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void pingerHistogramReset(pinger_histogram_t* hist);
+void pingerHistogramAdd(pinger_histogram_t* hist, uint32_t value);
+uint32_t pingerHistogramQuantile(const pinger_histogram_t* hist, float quantile);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __RE_PINGERSTATS_H__
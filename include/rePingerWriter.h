@@ -0,0 +1,41 @@
+/*
+   EN: Formatting of text messages into a single buffer without memory allocations
+   RU: Формирование текстовых сообщений в едином буфере без выделения памяти
+   --------------------------
+   (с) 2021 Разживин Александр | Razzhivin Alexander
+   kotyara12@yandex.ru | https://kotyara12.ru | tg: @kotyara1971
+*/
+
+#ifndef __RE_PINGERWRITER_H__
+#define __RE_PINGERWRITER_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct {
+  char* buffer;
+  size_t size;
+  size_t length;      // Length of the text, including the part that did not fit into the buffer
+} pinger_writer_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void pingerWriterInit(pinger_writer_t* writer, char* buffer, size_t size);
+void pingerWriterPuts(pinger_writer_t* writer, const char* text);
+// Appends a single character, including zero, which separates strings stored one after another
+void pingerWriterPutc(pinger_writer_t* writer, char c);
+void pingerWriterPrintf(pinger_writer_t* writer, const char* format, ...) __attribute__ ((format (printf, 2, 3)));
+
+// The text fit into the buffer entirely
+bool pingerWriterOk(const pinger_writer_t* writer);
+// Buffer size required for the text, including the terminating zero
+size_t pingerWriterRequired(const pinger_writer_t* writer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __RE_PINGERWRITER_H__
@@ -1,9 +1,14 @@
+#include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <math.h>
 #include "project_config.h"
 #include "def_consts.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "esp_system.h"
 #include "lwip/opt.h"
 #include "lwip/init.h"
 #include "lwip/mem.h"
@@ -19,6 +24,10 @@
 #include "lwip/sockets.h"
 #include "rLog.h"
 #include "rePinger.h"
+#include "rePingerStats.h"
+#include "rePingerFilter.h"
+#include "rePingerDns.h"
+#include "rePingerRes.h"
 #include "reEvents.h"
 #include "reWiFi.h"
 #include "reEsp32.h"
@@ -49,10 +58,85 @@ static const uint8_t PING_STOP  = BIT1;
 #define PING_SET_MIN(value_a, min_a, value_b, limit_b) if ((value_a < min_a) & (value_b < limit_b)) { min_a = value_a; }
 #define PING_SET_MAX(value_a, max_b) if (value_a > max_b) { max_b = value_a; }
 
-#define PING_TIME_DIFF_MS(_end, _start) ((uint32_t)(((_end).tv_sec - (_start).tv_sec) * 1000 + ((_end).tv_usec - (_start).tv_usec) / 1000))
+// Maximum number of echo requests in one batch (limited by the bit masks of the probe states)
+#define PING_PROBES_MAX 32
+#define PING_PROBE_BIT(n) ((uint32_t)1 << (n))
+
+#ifndef CONFIG_PINGER_PARAM_WINDOW
+#define CONFIG_PINGER_PARAM_WINDOW 1
+#endif // CONFIG_PINGER_PARAM_WINDOW
+#ifndef CONFIG_PINGER_PARAM_WINDOW_KEY
+#define CONFIG_PINGER_PARAM_WINDOW_KEY "window"
+#endif // CONFIG_PINGER_PARAM_WINDOW_KEY
+#ifndef CONFIG_PINGER_PARAM_WINDOW_FRIENDLY
+#define CONFIG_PINGER_PARAM_WINDOW_FRIENDLY "Maximum number of outstanding requests"
+#endif // CONFIG_PINGER_PARAM_WINDOW_FRIENDLY
+#ifndef CONFIG_PINGER_PARAM_SPACING
+#define CONFIG_PINGER_PARAM_SPACING 0
+#endif // CONFIG_PINGER_PARAM_SPACING
+#ifndef CONFIG_PINGER_PARAM_SPACING_KEY
+#define CONFIG_PINGER_PARAM_SPACING_KEY "spacing"
+#endif // CONFIG_PINGER_PARAM_SPACING_KEY
+#ifndef CONFIG_PINGER_PARAM_SPACING_FRIENDLY
+#define CONFIG_PINGER_PARAM_SPACING_FRIENDLY "Interval between requests"
+#endif // CONFIG_PINGER_PARAM_SPACING_FRIENDLY
+// Quorum: the check stops as soon as this number of hosts came to the same result, the rest of the hosts are skipped. 0 - all hosts are checked
+#ifndef CONFIG_PINGER_PARAM_QUORUM
+#define CONFIG_PINGER_PARAM_QUORUM 0
+#endif // CONFIG_PINGER_PARAM_QUORUM
+#ifndef CONFIG_PINGER_PARAM_QUORUM_KEY
+#define CONFIG_PINGER_PARAM_QUORUM_KEY "quorum"
+#endif // CONFIG_PINGER_PARAM_QUORUM_KEY
+#ifndef CONFIG_PINGER_PARAM_QUORUM_FRIENDLY
+#define CONFIG_PINGER_PARAM_QUORUM_FRIENDLY "Number of hosts sufficient for the result"
+#endif // CONFIG_PINGER_PARAM_QUORUM_FRIENDLY
+// Adaptive timeout of the requests to each host (RFC 6298): SRTT + K * RTTVAR, not less than CONFIG_PINGER_RTO_MIN ms 
+// and not more than the timeout from the parameters. 0 - all requests wait for the full timeout
+#ifndef CONFIG_PINGER_RTO_ADAPTIVE
+#define CONFIG_PINGER_RTO_ADAPTIVE 0
+#endif // CONFIG_PINGER_RTO_ADAPTIVE
+#ifndef CONFIG_PINGER_RTO_MIN
+#define CONFIG_PINGER_RTO_MIN 50
+#endif // CONFIG_PINGER_RTO_MIN
+#ifndef CONFIG_PINGER_RTO_K
+#define CONFIG_PINGER_RTO_K 4
+#endif // CONFIG_PINGER_RTO_K
+// Adaptive schedule: while a change of the state is not confirmed, the check is repeated after this interval, ms, 
+// then the interval is doubled up to "interval_available" or "interval_unavailable". 0 - fixed intervals
+#ifndef CONFIG_PINGER_INTERVAL_CONFIRM
+#define CONFIG_PINGER_INTERVAL_CONFIRM 0
+#endif // CONFIG_PINGER_INTERVAL_CONFIRM
+#ifndef CONFIG_PINGER_PARAM_INTERVAL_CONFIRM_KEY
+#define CONFIG_PINGER_PARAM_INTERVAL_CONFIRM_KEY "interval_confirm"
+#endif // CONFIG_PINGER_PARAM_INTERVAL_CONFIRM_KEY
+#ifndef CONFIG_PINGER_PARAM_INTERVAL_CONFIRM_FRIENDLY
+#define CONFIG_PINGER_PARAM_INTERVAL_CONFIRM_FRIENDLY "Interval: confirmation"
+#endif // CONFIG_PINGER_PARAM_INTERVAL_CONFIRM_FRIENDLY
+// Random deviation of the intervals, %, so that many devices do not check in lockstep. 0 - no deviation
+#ifndef CONFIG_PINGER_INTERVAL_JITTER
+#define CONFIG_PINGER_INTERVAL_JITTER 0
+#endif // CONFIG_PINGER_INTERVAL_JITTER
+#ifndef CONFIG_PINGER_PARAM_HOSTS_KEY
+#define CONFIG_PINGER_PARAM_HOSTS_KEY "hosts"
+#endif // CONFIG_PINGER_PARAM_HOSTS_KEY
+#ifndef CONFIG_PINGER_PARAM_HOSTS_FRIENDLY
+#define CONFIG_PINGER_PARAM_HOSTS_FRIENDLY "Public servers"
+#endif // CONFIG_PINGER_PARAM_HOSTS_FRIENDLY
+
+// ICMP identifiers of the hosts: public servers get 7001..7999, MQTT brokers 8101 and 8102
+#define PING_HOST_ID_FIRST 7001
+#define PING_HOST_ID_LAST  7999
+
+// Slots of MQTT brokers follow the slots of public servers in the host table
+#define PING_BROKERS_MAX 2
+// Own interval of the MQTT broker checks, ms, 0 - after each internet check
+#ifndef CONFIG_PINGER_BROKER_INTERVAL
+#define CONFIG_PINGER_BROKER_INTERVAL 0
+#endif // CONFIG_PINGER_BROKER_INTERVAL
+#define PING_TARGETS_MAX (CONFIG_PINGER_HOSTS_MAX + PING_BROKERS_MAX)
 
 typedef struct {
-    const char* host_name;
+    char host_name[CONFIG_PINGER_HOSTNAME_MAX];
     ip_addr_t host_addr;
     TickType_t host_resolved;
     int sock;
@@ -61,21 +145,53 @@ typedef struct {
     uint32_t icmp_pkt_size;
     uint32_t transmitted;
     uint32_t received;
-    uint32_t elapsed_time_ms;
-    uint32_t total_time_ms;
+    uint32_t elapsed_time_us;
+    uint32_t total_time_us;
+    uint32_t total_duration_us;
     uint32_t total_duration_ms;
+    uint32_t total_mdev_us;
+    float rtt_mean_us;
+    float rtt_m2;
+    uint32_t rtt_last_us;
+    float jitter_us;
+    uint32_t srtt_us;           // Smoothed response time and its variation (RFC 6298), 0 - no samples yet
+    uint32_t rttvar_us;
+    uint32_t rto_us;            // Timeout of the requests, 0 - the full timeout
     float total_loss;
     uint8_t tos;
     uint8_t ttl;
     ping_state_t total_state;
+    re_ping_event_id_t evid_available;
+    re_ping_event_id_t evid_unavailable;
     uint32_t limit_unavailable;
     uint32_t count_unavailable;
     time_t time_unavailable;
     bool notify_unavailable; 
+    bool active;
+    bool checked;               // The host was checked in the current cycle (it was due and was not skipped by the quorum)
+    bool known;                 // The result of at least one check is available
+    uint32_t interval_ms;       // Own schedule of the target, 0 - together with the internet check
+    uint8_t count;              // Number of requests, 0 - from the parameters
+    uint8_t priority;           // Targets due at the same time are checked in the order of priority
+    TickType_t next_due;        // Time of the next check on the own schedule
+    uint16_t seq_first;
+    uint16_t seq_highest;       // Highest sequence number answered in time, for the detection of reordering
+    uint8_t seq_known;          // Number of requests of the previous batches in the window of late replies
+    uint32_t seq_history;       // Requests of the previous batches that were answered, bit 0 - the last one
+    uint32_t seq_cancelled;     // Requests of the previous batches that were cancelled by the quorum, bit 0 - the last one
+    uint32_t replies_late;      // Replies to the requests that were already counted as lost, since the host was added
+    uint32_t replies_duplicate;
+    uint32_t replies_reordered;
+    uint32_t late_rtt_us;       // Response time of the last late reply
+    uint32_t probes_done;
+    uint32_t probes_replied;
+    uint32_t probes_cancelled;  // Requests cancelled by the quorum, their replies are dropped silently
+    uint32_t next_send_us;
+    uint32_t probe_time_us[PING_PROBES_MAX];
+    pinger_histogram_t rtt_hist;
 } pinger_data_t;
 
 TaskHandle_t _pingTask;
-static uint32_t _pingFlags = 0;
 
 #if CONFIG_PINGER_TASK_STATIC_ALLOCATION
 StaticTask_t _pingTaskBuffer;
@@ -85,6 +201,10 @@ StackType_t _pingTaskStack[CONFIG_PINGER_TASK_STACK_SIZE];
 static uint8_t _pingCount = CONFIG_PINGER_PARAM_COUNT;
 static uint16_t _pingTimeout = CONFIG_PINGER_PARAM_TIMEOUT;
 static uint8_t _pingPacket = CONFIG_PINGER_PARAM_DATASIZE;
+static uint8_t _pingWindow = CONFIG_PINGER_PARAM_WINDOW;
+static uint16_t _pingSpacing = CONFIG_PINGER_PARAM_SPACING;
+static uint8_t _pingQuorum = CONFIG_PINGER_PARAM_QUORUM;
+static uint8_t _pingQuorumFirst = 0;
 static uint8_t _resultMode = CONFIG_PINGER_TOTAL_RESULT_MODE;
 static uint32_t _maxSlowdownDuration = CONFIG_PINGER_SLOWDOWN_DURATION;
 static float _maxSlowdownLoss = CONFIG_PINGER_SLOWDOWN_LOSS;
@@ -93,12 +213,88 @@ static float _maxUnavailableLoss = CONFIG_PINGER_UNAVAILABLE_LOSS;
 static uint8_t _thresholdUnavailable = CONFIG_PINGER_UNAVAILABLE_THRESHOLD;
 static uint32_t _intervalAvailable = CONFIG_PINGER_INTERVAL_AVAILABLE;
 static uint32_t _intervalUnavailable = CONFIG_PINGER_INTERVAL_UNAVAILABLE;
+static uint32_t _intervalConfirm = CONFIG_PINGER_INTERVAL_CONFIRM;
+static uint32_t _intervalBackoff = 0;
+static ping_state_t _intervalState = PING_FAILED;
+static char* _pingHostsList = nullptr;
+
+// Private copy of the list of public servers: the parameter can be replaced by an MQTT update from another task
+#define PING_HOSTS_LIST_MAX (CONFIG_PINGER_HOSTS_MAX * (CONFIG_PINGER_HOSTNAME_MAX + 16))
+static char _pingHostsBuffer[PING_HOSTS_LIST_MAX];
+static SemaphoreHandle_t _pingHostsLock = nullptr;
+
+// Host table: public servers are packed at the beginning, MQTT brokers occupy the last slots
+static pinger_data_t _pingHosts[PING_TARGETS_MAX];
+static uint8_t _pingHostsCount = 0;
+static uint8_t _pingBrokersCount = 0;
+static uint32_t _pingHostsHash = 0;
+static uint16_t _pingHostNextId = PING_HOST_ID_FIRST;
+
+// One raw socket for each address family is shared by all targets, the replies are distributed by the echo identifier
+#if CONFIG_LWIP_IPV6
+  #define PING_FAMILIES 2
+#else
+  #define PING_FAMILIES 1
+#endif // CONFIG_LWIP_IPV6
+static int _pingSockets[PING_FAMILIES] = { 0 };
+
+// Deadline queue of the targets on their own schedule: binary min-heap of indices in the host table by the time of the next check
+static uint8_t _pingQueue[PING_TARGETS_MAX];
+static uint8_t _pingQueueSize = 0;
+static TickType_t _pingRoundDue = 0;
+
+// Phase timers: the time is accumulated during the cycle and stored in the history at its end
+#if CONFIG_PINGER_PHASE_TIMING
+  static uint32_t _pingPhaseCycle[PINGER_PHASE_MAX];
+  static uint32_t _pingPhaseHistory[CONFIG_PINGER_PHASE_WINDOW][PINGER_PHASE_MAX];
+  static pinger_phases_t _pingPhases;
+  #define PINGER_PHASE_BEGIN(var) int64_t var = esp_timer_get_time()
+  #define PINGER_PHASE_END(phase, var) _pingPhaseCycle[phase] += (uint32_t)(esp_timer_get_time() - var)
+#else
+  #define PINGER_PHASE_BEGIN(var)
+  #define PINGER_PHASE_END(phase, var)
+#endif // CONFIG_PINGER_PHASE_TIMING
+
+// Called with the parameters locked
+static void pingerHostsListCopy()
+{
+  if (_pingHostsLock) xSemaphoreTake(_pingHostsLock, portMAX_DELAY);
+  const char* list = _pingHostsList ? _pingHostsList : "";
+  if (strlen(list) >= sizeof(_pingHostsBuffer)) {
+    rlog_w(logTAG, "The list of hosts is too long, only the first %d characters are used", (int)sizeof(_pingHostsBuffer) - 1);
+  };
+  snprintf(_pingHostsBuffer, sizeof(_pingHostsBuffer), "%s", list);
+  if (_pingHostsLock) xSemaphoreGive(_pingHostsLock);
+}
+
+class pingerHostsHandler: public param_handler_t {
+  public:
+    void onChange(param_change_mode_t mode) override
+    {
+      pingerHostsListCopy();
+    };
+};
+
+static pingerHostsHandler _pingHostsHandler;
 
 static void pingerParamsRegister()
 {
   paramsGroupHandle_t pgPinger = paramsRegisterGroup(nullptr, 
     CONFIG_PINGER_PGROUP_ROOT_KEY, CONFIG_PINGER_PGROUP_ROOT_TOPIC, CONFIG_PINGER_PGROUP_ROOT_FRIENDLY);
   
+  if (!_pingHostsList) {
+    _pingHostsList = malloc_string(CONFIG_PINGER_HOSTS);
+  };
+  if (!_pingHostsLock) {
+    _pingHostsLock = xSemaphoreCreateMutex();
+  };
+  paramsRegisterValue(OPT_KIND_PARAMETER, OPT_TYPE_STRING, &_pingHostsHandler, pgPinger,
+    CONFIG_PINGER_PARAM_HOSTS_KEY, CONFIG_PINGER_PARAM_HOSTS_FRIENDLY,
+    CONFIG_MQTT_PARAMS_QOS, (void*)&_pingHostsList);
+  paramsLock();
+  pingerHostsListCopy();
+  paramsUnlock();
+
   paramsSetLimitsU8(
     paramsRegisterValue(OPT_KIND_PARAMETER, OPT_TYPE_U8, nullptr, pgPinger,
       CONFIG_PINGER_PARAM_COUNT_KEY, CONFIG_PINGER_PARAM_COUNT_FRIENDLY,
@@ -114,6 +310,21 @@ static void pingerParamsRegister()
       CONFIG_PINGER_PARAM_DATASIZE_KEY, CONFIG_PINGER_PARAM_DATASIZE_FRIENDLY,
       CONFIG_MQTT_PARAMS_QOS, (void*)&_pingPacket),
     1, 255);
+  paramsSetLimitsU8(
+    paramsRegisterValue(OPT_KIND_PARAMETER, OPT_TYPE_U8, nullptr, pgPinger,
+      CONFIG_PINGER_PARAM_WINDOW_KEY, CONFIG_PINGER_PARAM_WINDOW_FRIENDLY,
+      CONFIG_MQTT_PARAMS_QOS, (void*)&_pingWindow),
+    1, 25);
+  paramsSetLimitsU16(
+    paramsRegisterValue(OPT_KIND_PARAMETER, OPT_TYPE_U16, nullptr, pgPinger,
+      CONFIG_PINGER_PARAM_SPACING_KEY, CONFIG_PINGER_PARAM_SPACING_FRIENDLY,
+      CONFIG_MQTT_PARAMS_QOS, (void*)&_pingSpacing),
+    0, 10000);
+  paramsSetLimitsU8(
+    paramsRegisterValue(OPT_KIND_PARAMETER, OPT_TYPE_U8, nullptr, pgPinger,
+      CONFIG_PINGER_PARAM_QUORUM_KEY, CONFIG_PINGER_PARAM_QUORUM_FRIENDLY,
+      CONFIG_MQTT_PARAMS_QOS, (void*)&_pingQuorum),
+    0, CONFIG_PINGER_HOSTS_MAX);
 
   paramsSetLimitsU8(
     paramsRegisterValue(OPT_KIND_PARAMETER, OPT_TYPE_U8, nullptr, pgPinger,
@@ -153,13 +364,28 @@ static void pingerParamsRegister()
       CONFIG_PINGER_PARAM_INTERVAL_UNAVAILABLE_KEY, CONFIG_PINGER_PARAM_INTERVAL_UNAVAILABLE_FRIENDLY,
       CONFIG_MQTT_PARAMS_QOS, (void*)&_intervalUnavailable),
     1000, 3600000);
+  paramsSetLimitsU32(
+    paramsRegisterValue(OPT_KIND_PARAMETER, OPT_TYPE_U32, nullptr, pgPinger,
+      CONFIG_PINGER_PARAM_INTERVAL_CONFIRM_KEY, CONFIG_PINGER_PARAM_INTERVAL_CONFIRM_FRIENDLY,
+      CONFIG_MQTT_PARAMS_QOS, (void*)&_intervalConfirm),
+    0, 3600000);
+}
+
+// Monotonic time for measuring response time, us. Unlike the system time, it does not jump when SNTP adjusts the clock
+static int64_t pingerNowUs()
+{
+  return esp_timer_get_time();
 }
 
-static esp_err_t pingerSend(pinger_data_t *ep)
+static esp_err_t pingerSend(pinger_data_t *ep, int64_t now_us)
 {
   esp_err_t ret = ESP_OK;
   ep->packet_hdr->seqno++;
-  // Generate checksum since "seqno" has changed 
+  // The send time is transmitted in the packet data, the response will return it back
+  if (ep->icmp_pkt_size >= sizeof(struct icmp_echo_hdr) + sizeof(now_us)) {
+    memcpy((uint8_t*)ep->packet_hdr + sizeof(struct icmp_echo_hdr), &now_us, sizeof(now_us));
+  };
+  // Generate checksum since "seqno" and data have changed 
   ep->packet_hdr->chksum = 0;
   if (ep->packet_hdr->type == ICMP_ECHO) {
     ep->packet_hdr->chksum = inet_chksum(ep->packet_hdr, ep->icmp_pkt_size);
@@ -175,56 +401,198 @@ static esp_err_t pingerSend(pinger_data_t *ep)
     rlog_e(logTAG, "Send ICMP error = %d", opt_val);
     ret = ESP_FAIL;
   } else {
+    ep->probe_time_us[ep->transmitted] = (uint32_t)now_us;
     ep->transmitted++;
   }
   return ret;
 }
 
-static int pingerReceive(pinger_data_t *ep)
+// Timeout of the requests to the host: SRTT + K * RTTVAR, the full timeout until the first response
+static uint32_t pingerRto(pinger_data_t *ep)
+{
+  uint32_t timeout_us = (uint32_t)_pingTimeout * 1000;
+  #if CONFIG_PINGER_RTO_ADAPTIVE
+    if ((ep->rto_us > 0) && (ep->rto_us < timeout_us)) return ep->rto_us;
+  #endif // CONFIG_PINGER_RTO_ADAPTIVE
+  return timeout_us;
+}
+
+#if CONFIG_PINGER_RTO_ADAPTIVE
+static void pingerRtoUpdate(pinger_data_t *ep, uint32_t rtt_us)
+{
+  if (ep->srtt_us == 0) {
+    ep->srtt_us = rtt_us > 0 ? rtt_us : 1;
+    ep->rttvar_us = rtt_us / 2;
+  } else {
+    uint32_t diff = ep->srtt_us > rtt_us ? ep->srtt_us - rtt_us : rtt_us - ep->srtt_us;
+    ep->rttvar_us = (3 * ep->rttvar_us + diff) / 4;
+    ep->srtt_us = (7 * ep->srtt_us + rtt_us) / 8;
+  };
+  ep->rto_us = ep->srtt_us + CONFIG_PINGER_RTO_K * ep->rttvar_us;
+  if (ep->rto_us < (uint32_t)CONFIG_PINGER_RTO_MIN * 1000) {
+    ep->rto_us = (uint32_t)CONFIG_PINGER_RTO_MIN * 1000;
+  };
+}
+#endif // CONFIG_PINGER_RTO_ADAPTIVE
+
+// Send time returned in the reply, 0 - it is not in the reply or is implausible
+static int64_t pingerReplySent(int64_t now_us, const char* payload, int payload_len)
+{
+  int64_t send_us = 0;
+  if (payload_len >= (int)sizeof(send_us)) {
+    memcpy(&send_us, payload, sizeof(send_us));
+  };
+  return (send_us > 0) && (send_us <= now_us) ? send_us : 0;
+}
+
+// Reply to a request that was already counted as lost: the loss remains in the result of its batch, 
+// but the real response time is recorded, -1 - it is unknown
+static void pingerReplyLate(pinger_data_t *ep, uint16_t seqno, int64_t rtt_us)
 {
-  char buf[64]; // 64 bytes are enough to cover IP header and ICMP header
+  ep->replies_late++;
+  if ((rtt_us >= 0) && (rtt_us <= UINT32_MAX)) {
+    ep->late_rtt_us = (uint32_t)rtt_us;
+  };
+  #if CONFIG_PINGER_RTO_ADAPTIVE
+    // The response came within the full timeout, so the adaptive timeout was too short: the sample is taken into account
+    if ((rtt_us >= 0) && (rtt_us <= (int64_t)_pingTimeout * 1000)) {
+      pingerRtoUpdate(ep, (uint32_t)rtt_us);
+    };
+  #endif // CONFIG_PINGER_RTO_ADAPTIVE
+
+  #if CONFIG_PING_SHOW_INTERMEDIATE
+  rlog_d(logTAG, "Late reply from [%s : %s]: seqno = %d, time = %.3f ms",
+    ep->host_name, ipaddr_ntoa(&ep->host_addr), seqno, rtt_us / 1000.0);
+  #endif // CONFIG_PING_SHOW_INTERMEDIATE
+}
+
+// Match the reply to the request sent with the same sequence number, returns true if the reply is counted in the batch
+static bool pingerReply(pinger_data_t *ep, uint16_t seqno, int64_t now_us, const char* payload, int payload_len)
+{
+  uint32_t timeout_us = (uint32_t)_pingTimeout * 1000;
+  int64_t send_us = pingerReplySent(now_us, payload, payload_len);
+  uint16_t index = (uint16_t)(seqno - ep->seq_first);
+  if (index >= ep->transmitted) {
+    // Request of one of the previous batches, if it is in the window
+    uint16_t back = (uint16_t)(ep->seq_first - 1 - seqno);
+    if ((back >= ep->seq_known) || (ep->seq_cancelled & PING_PROBE_BIT(back))) return false;
+    if (ep->seq_history & PING_PROBE_BIT(back)) {
+      ep->replies_duplicate++;
+    } else {
+      ep->seq_history |= PING_PROBE_BIT(back);
+      pingerReplyLate(ep, seqno, send_us > 0 ? now_us - send_us : -1);
+    };
+    return false;
+  };
+
+  uint32_t bit = PING_PROBE_BIT(index);
+  if (ep->probes_cancelled & bit) return false;
+  if (ep->probes_replied & bit) {
+    ep->replies_duplicate++;
+    return false;
+  };
+  ep->probes_replied |= bit;
+  uint32_t elapsed_us = (uint32_t)now_us - ep->probe_time_us[index];
+  if (!ep->active || (elapsed_us > timeout_us) || (ep->probes_done & bit)) {
+    // The batch is over, or the request has already been counted as lost by the timeout
+    pingerReplyLate(ep, seqno, send_us > 0 ? now_us - send_us : elapsed_us);
+    return false;
+  };
+  ep->probes_done |= bit;
+  ep->received++;
+  // A reply to a later request has already been received
+  if ((int16_t)(seqno - ep->seq_highest) < 0) {
+    ep->replies_reordered++;
+  } else {
+    ep->seq_highest = seqno;
+  };
+  // Response time is calculated from the send time returned in the reply, if it is plausible
+  if ((send_us > 0) && (now_us - send_us <= (int64_t)timeout_us)) {
+    ep->elapsed_time_us = (uint32_t)(now_us - send_us);
+  } else {
+    ep->elapsed_time_us = elapsed_us;
+  };
+  ep->total_time_us += ep->elapsed_time_us;
+  pingerHistogramAdd(&ep->rtt_hist, ep->elapsed_time_us);
+  // Running variance (Welford), no samples are stored
+  float delta = ep->elapsed_time_us - ep->rtt_mean_us;
+  ep->rtt_mean_us += delta / ep->received;
+  ep->rtt_m2 += delta * (ep->elapsed_time_us - ep->rtt_mean_us);
+  // Interarrival jitter (RFC 3550): the sending interval is known, so the difference of transit times is the difference of RTT
+  if (ep->rtt_last_us > 0) {
+    float diff = fabsf((float)ep->elapsed_time_us - (float)ep->rtt_last_us);
+    ep->jitter_us += (diff - ep->jitter_us) / 16;
+  };
+  ep->rtt_last_us = ep->elapsed_time_us;
+  #if CONFIG_PINGER_RTO_ADAPTIVE
+    pingerRtoUpdate(ep, ep->elapsed_time_us);
+  #endif // CONFIG_PINGER_RTO_ADAPTIVE
+
+  #if CONFIG_PING_SHOW_INTERMEDIATE
+  rlog_d(logTAG, "Received of %d bytes from [%s : %s]: icmp_seq = %d, ttl = %d, time = %.3f ms",
+    _pingPacket, ep->host_name, ipaddr_ntoa(&ep->host_addr), index + 1, ep->ttl, ep->elapsed_time_us / 1000.0);
+  #endif // CONFIG_PING_SHOW_INTERMEDIATE
+  return true;
+}
+
+// Target with this identifier on the socket: late replies are also accepted for the targets outside the batch
+static pinger_data_t* pingerReplyTarget(int sock, uint16_t id)
+{
+  for (uint8_t i = 0; i < PING_TARGETS_MAX; i++) {
+    pinger_data_t *ep = &_pingHosts[i];
+    if (ep->packet_hdr && (ep->sock == sock) && (ep->packet_hdr->id == id)) return ep;
+  };
+  return nullptr;
+}
+
+static int pingerReceive(int sock, int64_t now_us)
+{
+  char buf[96]; // 96 bytes are enough to cover IP header with options, ICMP header and send time
   int len = 0;
+  int matched = 0;
   struct sockaddr_storage from;
   int fromlen = sizeof(from);
   uint16_t data_head = 0;
+  ip_addr_t from_addr;
 
-  while ((len = recvfrom(ep->sock, buf, sizeof(buf), 0, (struct sockaddr *)&from, (socklen_t *)&fromlen)) > 0) {
+  // Only the data already received is read here
+  while ((len = recvfrom(sock, buf, sizeof(buf), MSG_DONTWAIT, (struct sockaddr *)&from, (socklen_t *)&fromlen)) > 0) {
     if (from.ss_family == AF_INET) {
       // IPv4
       struct sockaddr_in *from4 = (struct sockaddr_in *)&from;
-      inet_addr_to_ip4addr(ip_2_ip4(&ep->host_addr), &from4->sin_addr);
-      IP_SET_TYPE_VAL(ep->host_addr, IPADDR_TYPE_V4);
+      inet_addr_to_ip4addr(ip_2_ip4(&from_addr), &from4->sin_addr);
+      IP_SET_TYPE_VAL(from_addr, IPADDR_TYPE_V4);
       data_head = (uint16_t)(sizeof(struct ip_hdr) + sizeof(struct icmp_echo_hdr));
     #if CONFIG_LWIP_IPV6
     } else {
       // IPv6
       struct sockaddr_in6 *from6 = (struct sockaddr_in6 *)&from;
-      inet6_addr_to_ip6addr(ip_2_ip6(&ep->host_addr), &from6->sin6_addr);
-      IP_SET_TYPE_VAL(ep->host_addr, IPADDR_TYPE_V6);
+      inet6_addr_to_ip6addr(ip_2_ip6(&from_addr), &from6->sin6_addr);
+      IP_SET_TYPE_VAL(from_addr, IPADDR_TYPE_V6);
       data_head = (uint16_t)(sizeof(struct ip6_hdr) + sizeof(struct icmp6_echo_hdr));
     #endif // CONFIG_LWIP_IPV6
     };
 
     if (len >= data_head) {
-      if (IP_IS_V4_VAL(ep->host_addr)) {              
+      if (IP_IS_V4_VAL(from_addr)) {              
         // Currently we process IPv4
         struct ip_hdr *iphdr = (struct ip_hdr *)buf;
-        struct icmp_echo_hdr *iecho = (struct icmp_echo_hdr *)(buf + (IPH_HL(iphdr) * 4));
-        if ((iecho->id == ep->packet_hdr->id) && (iecho->seqno == ep->packet_hdr->seqno)) {
-          ep->received++;
+        int icmp_head = IPH_HL(iphdr) * 4;
+        struct icmp_echo_hdr *iecho = (struct icmp_echo_hdr *)(buf + icmp_head);
+        pinger_data_t *ep = len >= icmp_head + (int)sizeof(struct icmp_echo_hdr) ? pingerReplyTarget(sock, iecho->id) : nullptr;
+        if (ep && pingerReply(ep, iecho->seqno, now_us, (char*)iecho + sizeof(struct icmp_echo_hdr), len - icmp_head - sizeof(struct icmp_echo_hdr))) {
           ep->ttl = iphdr->_ttl;
           // ep->recv_len = lwip_ntohs(IPH_LEN(iphdr)) - data_head;  // The data portion of ICMP
-          return len;
+          matched++;
         }
       #if CONFIG_LWIP_IPV6
-      } else if (IP_IS_V6_VAL(ep->host_addr)) {      
+      } else if (IP_IS_V6_VAL(from_addr)) {      
         // Currently we process IPv6
-        struct ip6_hdr *iphdr = (struct ip6_hdr *)buf;
         struct icmp6_echo_hdr *iecho6 = (struct icmp6_echo_hdr *)(buf + sizeof(struct ip6_hdr)); // IPv6 head length is 40
-        if ((iecho6->id == ep->packet_hdr->id) && (iecho6->seqno == ep->packet_hdr->seqno)) {
-          ep->received++;
+        pinger_data_t *ep = pingerReplyTarget(sock, iecho6->id);
+        if (ep && pingerReply(ep, iecho6->seqno, now_us, (char*)iecho6 + sizeof(struct icmp6_echo_hdr), len - data_head)) {
           // ep->recv_len = IP6H_PLEN(iphdr) - sizeof(struct icmp6_echo_hdr); // The data portion of ICMPv6
-          return len;
+          matched++;
         }
       #endif // CONFIG_LWIP_IPV6
       };
@@ -232,50 +600,52 @@ static int pingerReceive(pinger_data_t *ep)
 
     fromlen = sizeof(from);
   }
-  // if timeout, len will be -1
-  return len;
+  // Number of the replies matched to the requests
+  return matched;
 }
 
 static void pingerFreeSession(pinger_data_t *ep)
 {
   if (ep) {
-    if (ep->sock > 0) {
-      lwip_close(ep->sock);
-      ep->sock = 0;
-    };
+    ep->sock = 0;
     ep->host_resolved = 0;
     ip_addr_set_zero(&ep->host_addr);
     if (ep->packet_hdr) {
-      free(ep->packet_hdr);
+      PINGER_FREE(ep->packet_hdr);
       ep->packet_hdr = nullptr;
     };
   }
 }
 
-static esp_err_t pingerInitSession(pinger_data_t *ep, const char* hostname, uint32_t hostid, uint32_t limit_unavailable)
+static esp_err_t pingerInitSession(pinger_data_t *ep, const char* hostname, uint32_t hostid, uint32_t limit_unavailable,
+  re_ping_event_id_t evid_available, re_ping_event_id_t evid_unavailable)
 {
   esp_err_t ret = ESP_OK;
   PING_CHECK(ep, "Ping data can't be null", err, ESP_ERR_INVALID_ARG);
   memset(ep, 0, sizeof(pinger_data_t));
 
   // Set parameters for ping
-  ep->host_name = hostname;
+  snprintf(ep->host_name, sizeof(ep->host_name), "%s", hostname);
   ep->host_resolved = 0;
   ip_addr_set_zero(&ep->host_addr);
   ep->total_state = PING_OK;
+  ep->evid_available = evid_available;
+  ep->evid_unavailable = evid_unavailable;
   ep->limit_unavailable = limit_unavailable;
   ep->count_unavailable = 0;
   ep->notify_unavailable = false;
 
   // Allocating memory for a data packet
   ep->icmp_pkt_size = sizeof(struct icmp_echo_hdr) + _pingPacket;
-  ep->packet_hdr = (icmp_echo_hdr*)esp_calloc(1, ep->icmp_pkt_size);
+  ep->packet_hdr = (icmp_echo_hdr*)PINGER_CALLOC(1, ep->icmp_pkt_size);
   PING_CHECK(ep->packet_hdr, "No memory for echo packet", err, ESP_ERR_NO_MEM);
   
   // Set ICMP type and code field
   ep->packet_hdr->id = hostid;
   ep->packet_hdr->code = 0;
-  // Fill the additional data buffer with some data
+  ep->packet_hdr->seqno = 0;
+  ep->seq_first = 1;
+  // Fill the additional data buffer with some data, the first 8 bytes will be replaced by the send time
   {
     char *d = (char*)ep->packet_hdr + sizeof(struct icmp_echo_hdr);
     for (uint32_t i = 0; i < _pingPacket; i++) {
@@ -285,124 +655,66 @@ static esp_err_t pingerInitSession(pinger_data_t *ep, const char* hostname, uint
   return ret;
 err:
   if (ep->packet_hdr) {
-    free(ep->packet_hdr);
+    PINGER_FREE(ep->packet_hdr);
     ep->packet_hdr = nullptr;
   };
   return ret;
 }
 
+// The target is detached from the shared socket, the socket itself remains open
 static void pingerCloseSocket(pinger_data_t *ep)
 {
   if (ep) {
-    if (ep->sock > 0) {
-      lwip_close(ep->sock);
-      ep->sock = 0;
-    };
+    ep->sock = 0;
   }
 }
 
-#if LWIP_DNS
-static void pingerDnsFound(const char* hostname, const ip_addr_t *ipaddr, void *arg)
+// Shared sockets are closed only when the module stops or after a socket error, the targets are detached from them
+static void pingerSocketsClose()
 {
-  pinger_data_t *ep = (pinger_data_t *)arg;
-
-  if (ipaddr == nullptr) {
-    ep->host_resolved = 0;
-    ip_addr_set_zero(&ep->host_addr);
-  } else {
-    ep->host_resolved = xTaskGetTickCount();
-    ep->host_addr = *ipaddr;
+  for (uint8_t i = 0; i < PING_TARGETS_MAX; i++) {
+    _pingHosts[i].sock = 0;
   };
-}
-#endif /* LWIP_DNS */ 
-
-// Resolve hostname to IP address
-static esp_err_t pingerResolveName(pinger_data_t *ep)
-{
-  esp_err_t ret = ESP_OK;
-
-  ep->host_resolved = 0;
-  ip_addr_set_zero(&ep->host_addr);
-
-  #if LWIP_DNS
-    ret = dns_gethostbyname(ep->host_name, &ep->host_addr, pingerDnsFound, ep);
-  #else
-    ret = ipaddr_aton(ep->host_name, &ep->host_addr) ? ERR_OK : ERR_ARG;
-  #endif // LWIP_DNS
-  
-  if (ret == ERR_INPROGRESS) {
-    uint16_t waitTicks = pdMS_TO_TICKS(10000);
-    while ((waitTicks > 0) && (ep->host_resolved == 0)) {
-      vTaskDelay(1);
-      waitTicks--;
-    };
-    if (ep->host_resolved == 0) {
-      rlog_e(logTAG, "Failed to resolve a hostname [ %s ]: DNS TIMEOUT", ep->host_name);
-      return ESP_ERR_NOT_FOUND;
-    } else {
-      ret = ESP_OK;
+  for (uint8_t i = 0; i < PING_FAMILIES; i++) {
+    if (_pingSockets[i] > 0) {
+      lwip_close(_pingSockets[i]);
+      PINGER_RES_SOCKET(false);
+      _pingSockets[i] = 0;
     };
   };
-
-  if (ret == ESP_OK) {
-    #if CONFIG_LWIP_IPV6
-      // todo: IPV6 log support
-      if (IP_IS_V4(&ep->host_addr)) {
-        rlog_d(logTAG, "IP address obtained for hostname [ %s ]: %d.%d.%d.%d", 
-          ep->host_name, 
-          ip4_addr1(&ep->host_addr.u_addr.ip4),
-          ip4_addr2(&ep->host_addr.u_addr.ip4),
-          ip4_addr3(&ep->host_addr.u_addr.ip4),
-          ip4_addr4(&ep->host_addr.u_addr.ip4));
-      };
-    #else
-      rlog_d(logTAG, "IP address obtained for hostname [ %s ]: %d.%d.%d.%d", 
-        ep->host_name, 
-        ip4_addr1(&ep->host_addr),
-        ip4_addr2(&ep->host_addr),
-        ip4_addr3(&ep->host_addr),
-        ip4_addr4(&ep->host_addr));
-    #endif // CONFIG_LWIP_IPV6
-  } else {
-    rlog_e(logTAG, "Failed to resolve a hostname [ %s ]: %d %s", ep->host_name, ret, esp_err_to_name(ret));
-    return ESP_ERR_NOT_FOUND;
-  };
-  
-  return ret;
 }
 
 static esp_err_t pingerOpenSocket(pinger_data_t *ep)
 {
   esp_err_t ret = ESP_OK;
+  uint8_t family = 0;
   PING_CHECK(ep, "Ping data can't be null", err, ESP_ERR_INVALID_ARG);
 
-  // Resolve hostname to IP address, if needed
-  if (ep->host_resolved == 0) {
-    ret = pingerResolveName(ep);
-    if (ret != ESP_OK) return ret;
-  };
+  PING_CHECK(ep->host_resolved != 0, "Address of host [ %s ] is unknown", err, ESP_ERR_NOT_FOUND, ep->host_name);
 
-  // Create socket
+  // Create the shared socket of the address family at the first use
   #if CONFIG_LWIP_IPV6
-    if (IP_IS_V4(&ep->host_addr) || ip6_addr_isipv4mappedipv6(ip_2_ip6(&ep->host_addr))) {
-      ep->sock = lwip_socket(AF_INET, SOCK_RAW, IP_PROTO_ICMP);
-    } else {
-      ep->sock = lwip_socket(AF_INET6, SOCK_RAW, IP6_NEXTH_ICMP6);
+    if (!(IP_IS_V4(&ep->host_addr) || ip6_addr_isipv4mappedipv6(ip_2_ip6(&ep->host_addr)))) {
+      family = 1;
     };
-  #else
-    ep->sock = lwip_socket(AF_INET, SOCK_RAW, IP_PROTO_ICMP);
   #endif // CONFIG_LWIP_IPV6
+  if (_pingSockets[family] <= 0) {
+    #if CONFIG_LWIP_IPV6
+      if (family == 1) {
+        _pingSockets[family] = lwip_socket(AF_INET6, SOCK_RAW, IP6_NEXTH_ICMP6);
+      } else {
+        _pingSockets[family] = lwip_socket(AF_INET, SOCK_RAW, IP_PROTO_ICMP);
+      };
+    #else
+      _pingSockets[family] = lwip_socket(AF_INET, SOCK_RAW, IP_PROTO_ICMP);
+    #endif // CONFIG_LWIP_IPV6
+    PING_CHECK(_pingSockets[family] > 0, "Create socket failed: %d", err, ESP_FAIL, _pingSockets[family]);
+    PINGER_RES_SOCKET(true);
 
-  PING_CHECK(ep->sock > 0, "Create socket failed: %d", err, ESP_FAIL, ep->sock);
-
-  // Set receive timeout
-  struct timeval timeout;
-  timeout.tv_sec = _pingTimeout / 1000;
-  timeout.tv_usec = (_pingTimeout % 1000) * 1000;
-  setsockopt(ep->sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
-
-  // Set tos
-  setsockopt(ep->sock, IPPROTO_IP, IP_TOS, &ep->tos, sizeof(ep->tos));
+    // Set tos
+    setsockopt(_pingSockets[family], IPPROTO_IP, IP_TOS, &ep->tos, sizeof(ep->tos));
+  };
+  ep->sock = _pingSockets[family];
 
   // Set socket address
   if (IP_IS_V4(&ep->host_addr)) {
@@ -432,105 +744,408 @@ static void pingerCopyHostData(pinger_data_t *ep, ping_host_data_t* host_data)
   host_data->host_addr = ep->host_addr;
   host_data->transmitted = ep->transmitted;
   host_data->received = ep->received;
-  host_data->total_time_ms = ep->total_time_ms;
+  host_data->total_time_ms = ep->total_time_us / 1000;
   host_data->duration_ms = ep->total_duration_ms;
   host_data->loss = ep->total_loss;
   host_data->ttl = ep->ttl;
   host_data->state = ep->total_state;
 }
 
-static ping_state_t pingerCheckHostEx(pinger_data_t *ep)
+static void pingerCopyHostStats(pinger_data_t *ep, pinger_host_stats_t* host_stats)
+{
+  memset(host_stats, 0, sizeof(pinger_host_stats_t));
+  host_stats->duration_us = ep->total_duration_us;
+  host_stats->rtt_p50_us = pingerHistogramQuantile(&ep->rtt_hist, 0.50);
+  host_stats->rtt_p95_us = pingerHistogramQuantile(&ep->rtt_hist, 0.95);
+  host_stats->rtt_p99_us = pingerHistogramQuantile(&ep->rtt_hist, 0.99);
+  host_stats->rtt_mdev_us = ep->total_mdev_us;
+  host_stats->jitter_us = (uint32_t)ep->jitter_us;
+  host_stats->replies_late = ep->replies_late;
+  host_stats->replies_duplicate = ep->replies_duplicate;
+  host_stats->replies_reordered = ep->replies_reordered;
+  host_stats->late_rtt_us = ep->late_rtt_us;
+}
+
+// A host without a result in this round: only the current name of the slot is published
+static void pingerCopyHostSkipped(pinger_data_t *ep, ping_host_data_t* host_data, pinger_host_stats_t* host_stats)
+{
+  memset(host_data, 0, sizeof(ping_host_data_t));
+  host_data->host_name = ep->host_name;
+  host_data->host_addr = ep->host_addr;
+  memset(host_stats, 0, sizeof(pinger_host_stats_t));
+  host_stats->skipped = true;
+}
+
+// Sequence numbers continue across batches: the replies to the last PING_PROBES_MAX requests of the previous batches 
+// are recognized as late or duplicate, and are not taken for the replies to the new requests
+static void pingerSeqAdvance(pinger_data_t *ep)
 {
+  uint16_t sent = (uint16_t)(ep->packet_hdr->seqno + 1 - ep->seq_first);
+  if (sent == 0) return;
+  uint32_t history = sent < PING_PROBES_MAX ? ep->seq_history << sent : 0;
+  uint32_t cancelled = sent < PING_PROBES_MAX ? ep->seq_cancelled << sent : 0;
+  for (uint16_t i = 0; (i < sent) && (i < PING_PROBES_MAX); i++) {
+    uint16_t index = sent - 1 - i;
+    if ((index < ep->transmitted) && (ep->probes_replied & PING_PROBE_BIT(index))) {
+      history |= PING_PROBE_BIT(i);
+    };
+    if ((index < ep->transmitted) && (ep->probes_cancelled & PING_PROBE_BIT(index))) {
+      cancelled |= PING_PROBE_BIT(i);
+    };
+  };
+  ep->seq_history = history;
+  ep->seq_cancelled = cancelled;
+  ep->seq_known = sent < PING_PROBES_MAX - ep->seq_known ? ep->seq_known + sent : PING_PROBES_MAX;
+  ep->seq_first = ep->packet_hdr->seqno + 1;
+}
+
+static void pingerBatchStart(pinger_data_t *ep)
+{
+  ep->active = false;
+
   #if CONFIG_PING_SHOW_INTERMEDIATE
   rlog_d(logTAG, "Ping host [ %s ]...", ep->host_name);
   #endif // CONFIG_PING_SHOW_INTERMEDIATE
 
-  // Resolve hostname to IP address
-  if ( (ep->received == 0) 
-    || (ep->host_resolved == 0) 
-    || ((xTaskGetTickCount() - ep->host_resolved) > pdMS_TO_TICKS(CONFIG_PINGER_IP_VALIDITY)) ) {
+  // Get IP address from the cache, the socket is reopened if the address has changed
+  ip_addr_t addr;
+  TickType_t resolved;
+  if (!pingerDnsGet(ep->host_name, &addr, &resolved)) {
+    rlog_e(logTAG, "Failed to resolve a hostname [ %s ]", ep->host_name);
+    pingerCloseSocket(ep);
+    ep->host_resolved = 0;
+    return;
+  };
+  if ((ep->host_resolved == 0) || !ip_addr_cmp(&addr, &ep->host_addr)) {
     pingerCloseSocket(ep);
-    esp_err_t err = pingerResolveName(ep);
-    if (err != ESP_OK) goto err;
+    ep->host_addr = addr;
+    // The response time of the previous address says nothing about the new one
+    ep->srtt_us = 0;
+    ep->rttvar_us = 0;
+    ep->rto_us = 0;
+    #if CONFIG_LWIP_IPV6
+      // todo: IPV6 log support
+      if (IP_IS_V4(&ep->host_addr)) {
+        rlog_d(logTAG, "IP address obtained for hostname [ %s ]: %d.%d.%d.%d", 
+          ep->host_name, 
+          ip4_addr1(&ep->host_addr.u_addr.ip4),
+          ip4_addr2(&ep->host_addr.u_addr.ip4),
+          ip4_addr3(&ep->host_addr.u_addr.ip4),
+          ip4_addr4(&ep->host_addr.u_addr.ip4));
+      };
+    #else
+      rlog_d(logTAG, "IP address obtained for hostname [ %s ]: %d.%d.%d.%d", 
+        ep->host_name, 
+        ip4_addr1(&ep->host_addr),
+        ip4_addr2(&ep->host_addr),
+        ip4_addr3(&ep->host_addr),
+        ip4_addr4(&ep->host_addr));
+    #endif // CONFIG_LWIP_IPV6
   };
+  ep->host_resolved = resolved;
 
   // Opening socket
   if (ep->sock <= 0) {
-    if (pingerOpenSocket(ep) != ESP_OK) goto err;
-    if (ep->sock <= 0) goto err;
+    if (pingerOpenSocket(ep) != ESP_OK) return;
+    if (ep->sock <= 0) return;
   };
 
   // Initialize runtime statistics
-  ep->packet_hdr->seqno = 0;
+  pingerSeqAdvance(ep);
+  ep->probes_done = 0;
+  ep->probes_replied = 0;
+  ep->probes_cancelled = 0;
+  ep->next_send_us = (uint32_t)pingerNowUs();
   ep->transmitted = 0;
   ep->received = 0;
-  ep->total_time_ms = 0;
+  ep->total_time_us = 0;
+  ep->total_duration_us = 0;
   ep->total_duration_ms = 0;
+  ep->total_mdev_us = 0;
+  ep->rtt_mean_us = 0;
+  ep->rtt_m2 = 0;
   ep->total_loss = 0;
+  ep->active = true;
+}
 
-  // Batch of ping operations
-  struct timeval timeSend, timeEnd;
-  for (uint32_t i = 0; i < _pingCount; i++) {
-    // Send packet
-    esp_err_t send_ret = pingerSend(ep);
-    gettimeofday(&timeSend, NULL);
-    if (send_ret != ESP_OK) goto err;
-
-    // Recieve response
-    int recv_ret = pingerReceive(ep);
-    gettimeofday(&timeEnd, NULL);
-    ep->elapsed_time_ms = PING_TIME_DIFF_MS(timeEnd, timeSend);
-    if (ep->elapsed_time_ms > 1000000000) {
-      ep->elapsed_time_ms = rand() % _pingTimeout;
-    };
-    ep->total_time_ms += ep->elapsed_time_ms;
-
-    #if CONFIG_PING_SHOW_INTERMEDIATE
-    if (recv_ret >= 0) {
-      rlog_d(logTAG, "Received of %d bytes from [%s : %s]: icmp_seq = %d, ttl = %d, time = %d ms",
-        ep->datasize, ep->host_name, ipaddr_ntoa(&ep->host_addr), ep->packet_hdr->seqno, ep->ttl, ep->elapsed_time_ms);
-    } else {
-      rlog_w(logTAG, "Packet loss for [%s : %s]: icmp_seq = %d", 
-        ep->host_name, ipaddr_ntoa(&ep->host_addr), ep->packet_hdr->seqno);
-    };
-    #endif // CONFIG_PING_SHOW_INTERMEDIATE
-  };
-
+static ping_state_t pingerBatchFinish(pinger_data_t *ep)
+{
   // Calculating loss and average response time
-  if (ep->transmitted > 0) {
-    ep->total_duration_ms = ep->total_time_ms / ep->transmitted;
+  if (ep->active && (ep->transmitted > 0)) {
+    ep->active = false;
+    // The result may be settled before all requests are completed: the outstanding ones are lost with the full timeout
+    for (uint32_t i = 0; i < ep->transmitted; i++) {
+      if ((ep->probes_done & PING_PROBE_BIT(i)) == 0) {
+        ep->probes_done |= PING_PROBE_BIT(i);
+        ep->total_time_us += (uint32_t)_pingTimeout * 1000;
+      };
+    };
+    ep->total_duration_us = ep->total_time_us / ep->transmitted;
+    ep->total_duration_ms = (ep->total_duration_us + 500) / 1000;
     ep->total_loss = (float)((1 - ((float)ep->received) / ep->transmitted) * 100);
+    if (ep->received > 0) {
+      ep->total_mdev_us = (uint32_t)sqrtf(ep->rtt_m2 / ep->received);
+    };
     if (ep->received == 0) {
       ep->total_state = PING_UNAVAILABLE;
     } else {
       ep->total_state = PING_OK;
     };
-  } else goto err;
-
-  // Close socket
-  #if CONFIG_PING_KEEP_SOCKET == 0
-  pingerCloseSocket(ep);
-  #endif // CONFIG_PING_KEEP_SOCKET
+  } else {
+    ep->active = false;
+    ep->total_duration_us = (uint32_t)_pingTimeout * 1000;
+    ep->total_duration_ms = _pingTimeout;
+    ep->total_loss = 100.0;
+    ep->total_state = PING_FAILED;
+    pingerCloseSocket(ep);
+  };
+  ep->known = true;
 
   // Returning the batch result
   return ep->total_state;
-err:
-  ep->total_duration_ms = _pingTimeout;
-  ep->total_loss = 100.0;
-  ep->total_state = PING_FAILED;
-  pingerCloseSocket(ep);
-  return ep->total_state;
 }
 
+// Expire the requests that have not received a response in time, returns the time until the next expiration
+static uint32_t pingerExpireProbes(pinger_data_t *ep, uint32_t now_us)
+{
+  uint32_t timeout_us = (uint32_t)_pingTimeout * 1000;
+  uint32_t rto_us = pingerRto(ep);
+  uint32_t wait_us = UINT32_MAX;
+  bool expired = false;
+  for (uint32_t i = 0; i < ep->transmitted; i++) {
+    if ((ep->probes_done & PING_PROBE_BIT(i)) == 0) {
+      uint32_t elapsed = now_us - ep->probe_time_us[i];
+      if (elapsed >= rto_us) {
+        // The request is lost, it is counted with the full timeout as before
+        ep->probes_done |= PING_PROBE_BIT(i);
+        ep->elapsed_time_us = timeout_us;
+        ep->total_time_us += ep->elapsed_time_us;
+        if (rto_us < timeout_us) expired = true;
+
+        #if CONFIG_PING_SHOW_INTERMEDIATE
+        rlog_w(logTAG, "Packet loss for [%s : %s]: icmp_seq = %d", 
+          ep->host_name, ipaddr_ntoa(&ep->host_addr), i + 1);
+        #endif // CONFIG_PING_SHOW_INTERMEDIATE
+      } else if (rto_us - elapsed < wait_us) {
+        wait_us = rto_us - elapsed;
+      };
+    };
+  };
+  // Exponential backoff until the next response (RFC 6298, 5.5)
+  if (expired) {
+    ep->rto_us = rto_us < timeout_us / 2 ? 2 * rto_us : timeout_us;
+  };
+  return wait_us;
+}
 
-static ping_state_t pingerCheckHost(pinger_data_t *ep, re_ping_event_id_t evid_availavble, re_ping_event_id_t evid_unavailavble)
+// Number of requests that are still waiting for a response
+static uint32_t pingerOutstanding(pinger_data_t *ep)
 {
-  // Ping host
-  pingerCheckHostEx(ep);
+  return ep->transmitted - __builtin_popcount(ep->probes_done);
+}
 
+// Number of requests to the target in one batch
+static uint8_t pingerProbes(pinger_data_t *ep)
+{
+  uint8_t count = ep->count > 0 ? ep->count : _pingCount;
+  return count < PING_PROBES_MAX ? count : PING_PROBES_MAX;
+}
+
+// The result of the host does not depend on the remaining requests: all of them are completed, or too many are already lost
+static bool pingerBatchSettled(pinger_data_t *ep)
+{
+  uint8_t probes = pingerProbes(ep);
+  if (!ep->active) return true;
+  if ((ep->transmitted < probes) || (pingerOutstanding(ep) > 0)) {
+    uint32_t lost = __builtin_popcount(ep->probes_done) - ep->received;
+    return (float)lost * 100 / probes > _maxUnavailableLoss;
+  };
+  return true;
+}
+
+// The result of a single host by the same thresholds as for the internet access
+static ping_state_t pingerBatchVerdict(pinger_data_t *ep)
+{
+  if ((ep->total_state != PING_OK) || (ep->total_duration_ms >= _maxUnavailableDuration) || (ep->total_loss > _maxUnavailableLoss)) {
+    return PING_UNAVAILABLE;
+  };
+  if ((ep->total_duration_ms >= _maxSlowdownDuration) || (ep->total_loss >= _maxSlowdownLoss)) {
+    return PING_SLOWDOWN;
+  };
+  return PING_OK;
+}
+
+// Check of the targets in one batch, in the order of the list. The first "voters" targets decide the state of the internet
+// by the quorum, the other ones are checked completely in the same batch
+static void pingerCheckHostsEx(pinger_data_t **targets, uint8_t count, uint8_t voters, uint8_t quorum)
+{
+  if (count == 0) return;
+  uint8_t window = _pingWindow > 0 ? _pingWindow : 1;
+  uint32_t spacing_us = (uint32_t)_pingSpacing * 1000;
+
+  // Resolve names of all hosts in parallel: known addresses are taken from the cache at once and refreshed in the background,
+  // only hosts without any known address are waited for. A host that did not respond is re-resolved
+  PINGER_PHASE_BEGIN(phase);
+  for (uint8_t i = 0; i < count; i++) {
+    pingerDnsRequest(targets[i]->host_name, (targets[i]->transmitted > 0) && (targets[i]->received == 0));
+  };
+  pingerDnsWait(pdMS_TO_TICKS(CONFIG_PINGER_DNS_TIMEOUT));
+  PINGER_PHASE_END(PINGER_PHASE_DNS, phase);
+
+  // With a quorum, only the required number of voters is checked at first, the next one is added for each disagreement
+  uint8_t started = voters;
+  uint8_t votes[PING_UNAVAILABLE + 1] = { 0 };
+  uint32_t settled = 0;
+  if ((quorum > 0) && (quorum < voters)) {
+    started = quorum;
+  } else {
+    quorum = 0;
+  };
+
+  // Attach the hosts of the batch to the shared sockets
+  PINGER_PHASE_BEGIN(phaseSocket);
+  for (uint8_t k = 0; k < count; k++) {
+    if ((k < started) || (k >= voters)) {
+      targets[k]->checked = true;
+      pingerBatchStart(targets[k]);
+    };
+  };
+  PINGER_PHASE_END(PINGER_PHASE_SOCKET, phaseSocket);
+
+  // Batch of ping operations: requests to all hosts are sent in a pipeline of up to "window" outstanding requests 
+  // at intervals of "spacing", and all replies are awaited together
+  PINGER_PHASE_BEGIN(phaseProbes);
+  while (1) {
+    int64_t now_us = pingerNowUs();
+    uint32_t wait_us = UINT32_MAX;
+    fd_set fds;
+    int maxfd = -1;
+    FD_ZERO(&fds);
+
+    for (uint8_t i = 0; i < count; i++) {
+      pinger_data_t *ep = targets[i];
+      if (ep->active) {
+        uint32_t expire_us = pingerExpireProbes(ep, (uint32_t)now_us);
+        if (expire_us < wait_us) wait_us = expire_us;
+
+        // Send packets while the window allows it
+        uint8_t probes = pingerProbes(ep);
+        while ((ep->transmitted < probes) && (pingerOutstanding(ep) < window) && ((int32_t)((uint32_t)now_us - ep->next_send_us) >= 0)) {
+          if (pingerSend(ep, now_us) == ESP_OK) {
+            ep->next_send_us = (uint32_t)now_us + spacing_us;
+            if (pingerRto(ep) < wait_us) wait_us = pingerRto(ep);
+          } else {
+            ep->active = false;
+            break;
+          };
+        };
+        if (!ep->active) continue;
+
+        // Time of the next request
+        if ((ep->transmitted < probes) && (pingerOutstanding(ep) < window)) {
+          uint32_t send_us = ep->next_send_us - (uint32_t)now_us;
+          if (send_us < wait_us) wait_us = send_us;
+        };
+
+        // Still waiting for responses
+        if (pingerOutstanding(ep) > 0) {
+          FD_SET(ep->sock, &fds);
+          if (ep->sock > maxfd) maxfd = ep->sock;
+        };
+      };
+    };
+
+    // Count the votes of the hosts whose result is already known
+    if (quorum > 0) {
+      bool reached = false;
+      bool pending = false;
+      for (uint8_t k = 0; (k < started) && !reached; k++) {
+        pinger_data_t *ep = targets[k];
+        if ((settled & ((uint32_t)1 << k)) == 0) {
+          if (pingerBatchSettled(ep)) {
+            settled |= ((uint32_t)1 << k);
+            pingerBatchFinish(ep);
+            reached = ++votes[pingerBatchVerdict(ep)] >= quorum;
+          } else {
+            pending = true;
+          };
+        };
+      };
+      if (reached) {
+        // The remaining requests of the voters are cancelled, the results of the unfinished ones are not used
+        for (uint8_t k = 0; k < started; k++) {
+          pinger_data_t *ep = targets[k];
+          if ((settled & ((uint32_t)1 << k)) == 0) {
+            settled |= ((uint32_t)1 << k);
+            for (uint32_t i = 0; i < ep->transmitted; i++) {
+              if ((ep->probes_done & PING_PROBE_BIT(i)) == 0) ep->probes_cancelled |= PING_PROBE_BIT(i);
+            };
+            ep->checked = false;
+            ep->active = false;
+          };
+        };
+        quorum = 0;
+        continue;
+      };
+      // No agreement yet and all started voters are finished: the next one is added
+      if (!pending && (started < voters)) {
+        pinger_data_t *ep = targets[started];
+        ep->checked = true;
+        pingerBatchStart(ep);
+        started++;
+        continue;
+      };
+    };
+
+    // All requests are completed
+    if (wait_us == UINT32_MAX) break;
+    
+    // Recieve responses
+    struct timeval timeout;
+    timeout.tv_sec = wait_us / 1000000;
+    timeout.tv_usec = wait_us % 1000000;
+    int ready = select(maxfd + 1, &fds, NULL, NULL, &timeout);
+    if (ready < 0) {
+      rlog_e(logTAG, "Select ICMP sockets error = %d", errno);
+      for (uint8_t i = 0; i < count; i++) {
+        targets[i]->active = false;
+      };
+      // The sockets will be reopened on the next check
+      pingerSocketsClose();
+      break;
+    };
+    if (ready > 0) {
+      now_us = pingerNowUs();
+      for (uint8_t i = 0; i < PING_FAMILIES; i++) {
+        if ((_pingSockets[i] > 0) && FD_ISSET(_pingSockets[i], &fds)) {
+          pingerReceive(_pingSockets[i], now_us);
+        };
+      };
+    };
+  };
+
+  // Calculating the results of the batch
+  for (uint8_t k = 0; k < count; k++) {
+    if (((k < started) || (k >= voters)) && ((settled & ((uint32_t)1 << k)) == 0)) {
+      pingerBatchFinish(targets[k]);
+    };
+  };
+  PINGER_PHASE_END(PINGER_PHASE_PROBES, phaseProbes);
+}
+
+// Posting may block while the event loop queue is full
+static void pingerEventPost(int32_t event_id, void* event_data, size_t event_data_size)
+{
+  PINGER_PHASE_BEGIN(phase);
+  eventLoopPost(RE_PING_EVENTS, event_id, event_data, event_data_size, portMAX_DELAY);
+  PINGER_PHASE_END(PINGER_PHASE_EVENTS, phase);
+}
+
+static ping_state_t pingerCheckHost(pinger_data_t *ep)
+{
   // Show log
-  rlog_d(logTAG, "Ping statistics for [%s : %s]: %d packets transmitted, %d received, %.1f% % packet loss, average time %d ms",
-    ep->host_name, ipaddr_ntoa(&ep->host_addr), ep->transmitted, ep->received, ep->total_loss, ep->total_duration_ms);
+  rlog_d(logTAG, "Ping statistics for [%s : %s]: %d packets transmitted, %d received, %.1f%% packet loss, average time %.3f ms",
+    ep->host_name, ipaddr_ntoa(&ep->host_addr), ep->transmitted, ep->received, ep->total_loss, ep->total_duration_us / 1000.0);
 
   // Copy results to data to send to event loop
   ping_host_data_t host_data;
@@ -545,7 +1160,7 @@ static ping_state_t pingerCheckHost(pinger_data_t *ep, re_ping_event_id_t evid_a
       ep->time_unavailable = 0;
       if (ep->notify_unavailable) {
         ep->notify_unavailable = false;
-        eventLoopPost(RE_PING_EVENTS, evid_availavble, &host_data, sizeof(host_data), portMAX_DELAY);
+        pingerEventPost(ep->evid_available, &host_data, sizeof(host_data));
       };
     };
   } else {
@@ -557,62 +1172,689 @@ static ping_state_t pingerCheckHost(pinger_data_t *ep, re_ping_event_id_t evid_a
     if ((!ep->notify_unavailable) && (ep->count_unavailable >= ep->limit_unavailable)) {
       ep->notify_unavailable = true;
       host_data.time_unavailable = ep->time_unavailable;
-      eventLoopPost(RE_PING_EVENTS, evid_unavailavble, &host_data, sizeof(host_data), portMAX_DELAY);
+      pingerEventPost(ep->evid_unavailable, &host_data, sizeof(host_data));
     };
   };
   
   return ep->total_state;
 }
 
+// -----------------------------------------------------------------------------------------------------------------------
+// ------------------------------------------------------ Host table -----------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+static bool pingerIsHostSeparator(char c)
+{
+  return (c == ',') || (c == ';') || (c == ' ') || (c == '\t') || (c == '\r') || (c == '\n');
+}
+
+static uint32_t pingerHostsListHash(const char* list)
+{
+  // FNV-1a
+  uint32_t hash = 2166136261UL;
+  while (*list) {
+    hash = (hash ^ (uint8_t)*list++) * 16777619UL;
+  };
+  return hash;
+}
+
+static bool pingerHostIs(pinger_data_t *ep, const char* hostname, uint8_t len)
+{
+  return (strncasecmp(ep->host_name, hostname, len) == 0) && (ep->host_name[len] == 0);
+}
+
+static uint16_t pingerHostNewId()
+{
+  // Identifier must be unique among the public servers
+  while (1) {
+    uint16_t id = _pingHostNextId;
+    _pingHostNextId = (_pingHostNextId < PING_HOST_ID_LAST) ? _pingHostNextId + 1 : PING_HOST_ID_FIRST;
+    bool used = false;
+    for (uint8_t i = 0; i < CONFIG_PINGER_HOSTS_MAX; i++) {
+      if ((_pingHosts[i].packet_hdr) && (_pingHosts[i].packet_hdr->id == id)) {
+        used = true;
+        break;
+      };
+    };
+    if (!used) return id;
+  };
+}
+
+static void pingerHostSwap(uint8_t a, uint8_t b)
+{
+  pinger_data_t temp = _pingHosts[a];
+  _pingHosts[a] = _pingHosts[b];
+  _pingHosts[b] = temp;
+}
+
+// Own schedule of the host after the name: "host/interval/count/priority", interval in seconds, omitted values are 0
+static void pingerHostOptions(const char* options, const char* end, uint32_t* interval_ms, uint8_t* count, uint8_t* priority)
+{
+  uint32_t values[3] = { 0, 0, 0 };
+  for (uint8_t i = 0; (i < 3) && (options < end) && (*options == '/'); i++) {
+    char* next;
+    values[i] = strtoul(options + 1, &next, 10);
+    options = next;
+  };
+  if (options < end) {
+    rlog_w(logTAG, "Invalid schedule of the host [ %.*s ]", (int)(end - options), options);
+  };
+  *interval_ms = values[0] < 86400 ? values[0] * 1000 : 86400000;
+  *count = values[1] < PING_PROBES_MAX ? (uint8_t)values[1] : PING_PROBES_MAX;
+  *priority = values[2] < UINT8_MAX ? (uint8_t)values[2] : UINT8_MAX;
+}
+
+// Synchronize the host table with the list of public servers, returns true if the table has changed
+static bool pingerHostsApply(const char* list)
+{
+  uint32_t hash = pingerHostsListHash(list);
+  if (hash == _pingHostsHash) return false;
+  _pingHostsHash = hash;
+
+  // Split the list into host names and their schedules
+  const char* names[CONFIG_PINGER_HOSTS_MAX];
+  uint8_t lens[CONFIG_PINGER_HOSTS_MAX];
+  uint32_t intervals[CONFIG_PINGER_HOSTS_MAX];
+  uint8_t counts[CONFIG_PINGER_HOSTS_MAX];
+  uint8_t priorities[CONFIG_PINGER_HOSTS_MAX];
+  uint8_t count = 0;
+  const char* ptr = list;
+  while (*ptr) {
+    while (*ptr && pingerIsHostSeparator(*ptr)) ptr++;
+    const char* name = ptr;
+    while (*ptr && !pingerIsHostSeparator(*ptr)) ptr++;
+    const char* options = name;
+    while ((options < ptr) && (*options != '/')) options++;
+    size_t len = options - name;
+    if (len == 0) continue;
+    if (len >= CONFIG_PINGER_HOSTNAME_MAX) {
+      rlog_e(logTAG, "Host name [ %.*s ] is too long", (int)len, name);
+      continue;
+    };
+    if (count >= CONFIG_PINGER_HOSTS_MAX) {
+      rlog_w(logTAG, "Too many hosts in the list, only the first %d are used", CONFIG_PINGER_HOSTS_MAX);
+      break;
+    };
+    bool duplicate = false;
+    for (uint8_t i = 0; i < count; i++) {
+      if ((lens[i] == len) && (strncasecmp(names[i], name, len) == 0)) {
+        duplicate = true;
+        break;
+      };
+    };
+    if (!duplicate) {
+      names[count] = name;
+      lens[count] = (uint8_t)len;
+      pingerHostOptions(options, ptr, &intervals[count], &counts[count], &priorities[count]);
+      count++;
+    };
+  };
+
+  // Remove hosts that are no longer in the list
+  uint8_t i = 0;
+  while (i < _pingHostsCount) {
+    bool found = false;
+    for (uint8_t j = 0; j < count; j++) {
+      if (pingerHostIs(&_pingHosts[i], names[j], lens[j])) {
+        found = true;
+        break;
+      };
+    };
+    if (found) {
+      i++;
+    } else {
+      rlog_i(logTAG, "Host [ %s ] removed from the list", _pingHosts[i].host_name);
+      pingerFreeSession(&_pingHosts[i]);
+      _pingHostsCount--;
+      if (i != _pingHostsCount) {
+        _pingHosts[i] = _pingHosts[_pingHostsCount];
+      };
+      memset(&_pingHosts[_pingHostsCount], 0, sizeof(pinger_data_t));
+    };
+  };
+
+  // Arrange hosts in the order of the list and add new ones
+  for (uint8_t j = 0; j < count; j++) {
+    uint8_t k = j;
+    while ((k < _pingHostsCount) && !pingerHostIs(&_pingHosts[k], names[j], lens[j])) k++;
+    if (k < _pingHostsCount) {
+      if (k != j) pingerHostSwap(j, k);
+    } else {
+      char hostname[CONFIG_PINGER_HOSTNAME_MAX];
+      memcpy(hostname, names[j], lens[j]);
+      hostname[lens[j]] = 0;
+      // The current occupant of the slot moves to the end of the table
+      if (j < _pingHostsCount) {
+        _pingHosts[_pingHostsCount] = _pingHosts[j];
+      };
+      if (pingerInitSession(&_pingHosts[j], hostname, pingerHostNewId(), 1, RE_PING_HOST_AVAILABLE, RE_PING_HOST_UNAVAILABLE) == ESP_OK) {
+        rlog_i(logTAG, "Host [ %s ] added to the list", hostname);
+        _pingHostsCount++;
+      } else {
+        if (j < _pingHostsCount) {
+          _pingHosts[j] = _pingHosts[_pingHostsCount];
+        };
+        memset(&_pingHosts[_pingHostsCount], 0, sizeof(pinger_data_t));
+        // Try again on the next check
+        _pingHostsHash = 0;
+        break;
+      };
+    };
+    pinger_data_t *ep = &_pingHosts[j];
+    if ((ep->interval_ms != intervals[j]) || (ep->count != counts[j]) || (ep->priority != priorities[j])) {
+      ep->interval_ms = intervals[j];
+      ep->count = counts[j];
+      ep->priority = priorities[j];
+      ep->next_due = xTaskGetTickCount();
+    };
+  };
+  return true;
+}
+
+// The names of the hosts point into the private copy of the list, so it is locked until the table is updated
+static bool pingerHostsUpdate()
+{
+  if (!_pingHostsLock || (xSemaphoreTake(_pingHostsLock, portMAX_DELAY) != pdTRUE)) return false;
+  bool changed = pingerHostsApply(_pingHostsBuffer);
+  xSemaphoreGive(_pingHostsLock);
+  return changed;
+}
+
+#if CONFIG_MQTT1_PING_CHECK || CONFIG_MQTT2_PING_CHECK
+static void pingerBrokerAdd(const char* hostname, uint32_t hostid, uint32_t limit_unavailable,
+  re_ping_event_id_t evid_available, re_ping_event_id_t evid_unavailable)
+{
+  if (_pingBrokersCount < PING_BROKERS_MAX) {
+    pinger_data_t *ep = &_pingHosts[CONFIG_PINGER_HOSTS_MAX + _pingBrokersCount];
+    if (pingerInitSession(ep, hostname, hostid, limit_unavailable, evid_available, evid_unavailable) == ESP_OK) {
+      ep->interval_ms = CONFIG_PINGER_BROKER_INTERVAL;
+      ep->next_due = xTaskGetTickCount();
+      _pingBrokersCount++;
+    };
+  };
+}
+#endif // CONFIG_MQTT1_PING_CHECK || CONFIG_MQTT2_PING_CHECK
+
+static void pingerHostsFree()
+{
+  for (uint8_t i = 0; i < PING_TARGETS_MAX; i++) {
+    pingerFreeSession(&_pingHosts[i]);
+  };
+  pingerSocketsClose();
+  _pingHostsCount = 0;
+  _pingBrokersCount = 0;
+  _pingHostsHash = 0;
+  _pingQueueSize = 0;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ---------------------------------------------------- Deadline queue ---------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+static bool pingerQueueBefore(uint8_t a, uint8_t b)
+{
+  int32_t diff = (int32_t)(_pingHosts[a].next_due - _pingHosts[b].next_due);
+  return (diff < 0) || ((diff == 0) && (_pingHosts[a].priority > _pingHosts[b].priority));
+}
+
+static void pingerQueueSwap(uint8_t a, uint8_t b)
+{
+  uint8_t temp = _pingQueue[a];
+  _pingQueue[a] = _pingQueue[b];
+  _pingQueue[b] = temp;
+}
+
+static void pingerQueueSiftDown(uint8_t pos)
+{
+  while (1) {
+    uint8_t first = pos;
+    uint8_t left = 2 * pos + 1;
+    uint8_t right = left + 1;
+    if ((left < _pingQueueSize) && pingerQueueBefore(_pingQueue[left], _pingQueue[first])) first = left;
+    if ((right < _pingQueueSize) && pingerQueueBefore(_pingQueue[right], _pingQueue[first])) first = right;
+    if (first == pos) return;
+    pingerQueueSwap(pos, first);
+    pos = first;
+  };
+}
+
+static void pingerQueuePush(uint8_t index)
+{
+  uint8_t pos = _pingQueueSize++;
+  _pingQueue[pos] = index;
+  while ((pos > 0) && pingerQueueBefore(_pingQueue[pos], _pingQueue[(pos - 1) / 2])) {
+    pingerQueueSwap(pos, (pos - 1) / 2);
+    pos = (pos - 1) / 2;
+  };
+}
+
+static uint8_t pingerQueuePop()
+{
+  uint8_t index = _pingQueue[0];
+  _pingQueue[0] = _pingQueue[--_pingQueueSize];
+  pingerQueueSiftDown(0);
+  return index;
+}
+
+// The queue holds the targets on their own schedule and is rebuilt when the host table changes
+static void pingerQueueBuild()
+{
+  _pingQueueSize = 0;
+  for (uint8_t i = 0; i < PING_TARGETS_MAX; i++) {
+    if (_pingHosts[i].packet_hdr && (_pingHosts[i].interval_ms > 0)) {
+      _pingQueue[_pingQueueSize++] = i;
+    };
+  };
+  for (int16_t pos = _pingQueueSize / 2 - 1; pos >= 0; pos--) {
+    pingerQueueSiftDown(pos);
+  };
+}
+
 #define LOGMSG_SERVICE_STARTED "Service access check Internet access was started"
 #define LOGMSG_SERVICE_STOPPED "Service access check Internet access was stopped"
 
-static void pingerExec(void *args)
+static pinger_publish_data_t _pingData;
+#if (CONFIG_PINGER_FILTER_MODE > 0) && (CONFIG_PINGER_FILTER_SIZE > 0)
+static pinger_filter_t _filterDuration;
+static pinger_filter_t _filterLoss;
+#endif // CONFIG_PINGER_FILTER_MODE
+
+bool pingerCycleInit()
 {
-  static ping_publish_data_t data;
-  memset(&data, 0, sizeof(data));
-  data.inet.state = PING_FAILED;
-  data.inet.time_unavailable = 0;
-  static bool pingEnabled = true;
-  static bool pingLastOk = true;
-  static BaseType_t waitResult;
-  static uint32_t waitFlags;
-  static TickType_t lastCheck = 0;
-  static TickType_t waitTicks = 0;
-  ping_state_t inet_state;
+  memset(&_pingData, 0, sizeof(_pingData));
+  _pingData.inet.state = PING_FAILED;
+  _pingData.inet.time_unavailable = 0;
+  _intervalBackoff = 0;
+  _pingRoundDue = xTaskGetTickCount();
   #if (CONFIG_PINGER_FILTER_MODE > 0) && (CONFIG_PINGER_FILTER_SIZE > 0)
-  static bool bufReset = true;
-  static uint8_t bufIndex = 0;
-  static uint16_t bufDuration[CONFIG_PINGER_FILTER_SIZE];
+  pingerFilterReset(&_filterDuration);
+  pingerFilterReset(&_filterLoss);
   #endif // CONFIG_PINGER_FILTER_MODE
+  #if CONFIG_PINGER_PHASE_TIMING
+  memset(_pingPhaseCycle, 0, sizeof(_pingPhaseCycle));
+  memset(&_pingPhases, 0, sizeof(_pingPhases));
+  #endif // CONFIG_PINGER_PHASE_TIMING
 
   pingerParamsRegister();
+  pingerDnsInit();
   
-  #ifdef CONFIG_PINGER_HOST_1  
-    static pinger_data_t pdHost1;
-    if (pingerInitSession(&pdHost1, CONFIG_PINGER_HOST_1, 7001, 1) == ESP_OK) { data.inet.hosts_count++; };
-  #endif // CONFIG_PINGER_HOST_1  
-  #ifdef CONFIG_PINGER_HOST_2
-    static pinger_data_t pdHost2;
-    if (pingerInitSession(&pdHost2, CONFIG_PINGER_HOST_2, 7002, 1) == ESP_OK) { data.inet.hosts_count++; };
-  #endif // CONFIG_PINGER_HOST_2
-  #ifdef CONFIG_PINGER_HOST_3
-    static pinger_data_t pdHost3;
-    if (pingerInitSession(&pdHost3, CONFIG_PINGER_HOST_3, 7003, 1) == ESP_OK) { data.inet.hosts_count++; };
-  #endif // CONFIG_PINGER_HOST_3
-
+  // Public servers are taken from the parameters, MQTT brokers from the project configuration
+  pingerHostsUpdate();
   #if CONFIG_MQTT1_PING_CHECK
-    static pinger_data_t pdMqtt1;
-    pingerInitSession(&pdMqtt1, CONFIG_MQTT1_HOST, 8101, CONFIG_MQTT1_PING_CHECK_LIMIT);
+    pingerBrokerAdd(CONFIG_MQTT1_HOST, 8101, CONFIG_MQTT1_PING_CHECK_LIMIT, RE_PING_MQTT1_AVAILABLE, RE_PING_MQTT1_UNAVAILABLE);
   #endif // CONFIG_MQTT1_PING_CHECK
   #if CONFIG_MQTT2_PING_CHECK
-    pinger_data_t pdMqtt2;
-    pingerInitSession(&pdMqtt2, CONFIG_MQTT2_HOST, 8102, CONFIG_MQTT2_PING_CHECK_LIMIT);
+    pingerBrokerAdd(CONFIG_MQTT2_HOST, 8102, CONFIG_MQTT2_PING_CHECK_LIMIT, RE_PING_MQTT2_AVAILABLE, RE_PING_MQTT2_UNAVAILABLE);
   #endif // CONFIG_MQTT2_PING_CHECK
+  pingerQueueBuild();
 
   #if CONFIG_OPENMON_ENABLE && CONFIG_OPENMON_PINGER_ENABLE
     pingerOpenMonInit();
   #endif // CONFIG_OPENMON_ENABLE && CONFIG_OPENMON_PINGER_ENABLE
+  return true;
+}
+
+void pingerCycleRestart()
+{
+  _pingData.inet.state = PING_FAILED;
+  _intervalBackoff = 0;
+  _pingRoundDue = xTaskGetTickCount();
+}
+
+#if CONFIG_PINGER_PHASE_TIMING
+
+// The maxima are taken over the history of the last cycles, so that a single outlier leaves them after the window
+static void pingerPhasesFinish()
+{
+  uint32_t* slot = _pingPhaseHistory[_pingPhases.cycles % CONFIG_PINGER_PHASE_WINDOW];
+  memcpy(slot, _pingPhaseCycle, sizeof(_pingPhaseCycle));
+  memcpy(_pingPhases.last_us, _pingPhaseCycle, sizeof(_pingPhaseCycle));
+  memset(_pingPhaseCycle, 0, sizeof(_pingPhaseCycle));
+  _pingPhases.cycles++;
+
+  uint32_t depth = _pingPhases.cycles < CONFIG_PINGER_PHASE_WINDOW ? _pingPhases.cycles : CONFIG_PINGER_PHASE_WINDOW;
+  memset(_pingPhases.max_us, 0, sizeof(_pingPhases.max_us));
+  for (uint32_t i = 0; i < depth; i++) {
+    for (uint8_t phase = 0; phase < PINGER_PHASE_MAX; phase++) {
+      PING_SET_MAX(_pingPhaseHistory[i][phase], _pingPhases.max_us[phase]);
+    };
+  };
+  rlog_v(logTAG, "Check cycle phases: dns=%u, socket=%u, probes=%u, events=%u, publish=%u, total=%u us",
+    _pingPhases.last_us[PINGER_PHASE_DNS], _pingPhases.last_us[PINGER_PHASE_SOCKET], _pingPhases.last_us[PINGER_PHASE_PROBES],
+    _pingPhases.last_us[PINGER_PHASE_EVENTS], _pingPhases.last_us[PINGER_PHASE_PUBLISH], _pingPhases.last_us[PINGER_PHASE_CYCLE]);
+}
+
+void pingerPhasesGet(pinger_phases_t* phases)
+{
+  if (phases) *phases = _pingPhases;
+}
+
+#endif // CONFIG_PINGER_PHASE_TIMING
+
+// Interval until the next check, ms: short while a change of the state is suspected, then growing exponentially
+static uint32_t pingerScheduleNext(ping_state_t state, bool suspected, bool ok)
+{
+  uint32_t interval = ok ? _intervalAvailable : _intervalUnavailable;
+  if (_intervalConfirm > 0) {
+    if (suspected || (state != _intervalState) || (_intervalBackoff == 0)) {
+      _intervalBackoff = _intervalConfirm;
+    } else {
+      _intervalBackoff = _intervalBackoff < interval / 2 ? 2 * _intervalBackoff : interval;
+    };
+    _intervalState = state;
+    if (_intervalBackoff < interval) interval = _intervalBackoff;
+  };
+  #if CONFIG_PINGER_INTERVAL_JITTER > 0
+    uint32_t spread = interval / 100 * CONFIG_PINGER_INTERVAL_JITTER;
+    interval = interval - spread + esp_random() % (2 * spread + 1);
+  #endif // CONFIG_PINGER_INTERVAL_JITTER
+  return interval;
+}
+
+// Evaluation of the internet access by the results of the hosts, posting events and publishing
+static ping_state_t pingerInetUpdate(bool* last_ok, bool* suspected)
+{
+  ping_state_t inet_state;
+  _pingData.inet.hosts_available = 0;
+  _pingData.inet.duration_ms_min = 0;
+  _pingData.inet.duration_ms_max = 0;
+  _pingData.inet.duration_ms_total = 0;
+  _pingData.inet.loss_min = 0;
+  _pingData.inet.loss_max = 0;
+  _pingData.inet.loss_total = 0;
+
+  // Hosts on their own schedule take part with their last result, hosts skipped by the quorum are not included in the totals
+  uint8_t hostsChecked = 0;
+  uint32_t hostsDuration = 0;
+  float hostsLoss = 0;
+  uint32_t hostsMdev = 0;
+  uint32_t hostsJitter = 0;
+  uint8_t hostsResponded = 0;
+  _pingData.hosts_count = _pingHostsCount;
+  for (uint8_t i = 0; i < _pingHostsCount; i++) {
+    pinger_data_t *ep = &_pingHosts[i];
+    if (!ep->checked && ((ep->interval_ms == 0) || !ep->known)) {
+      pingerCopyHostSkipped(ep, &_pingData.hosts[i], &_pingData.hosts_stats[i]);
+      continue;
+    };
+    if ((ep->checked ? pingerCheckHost(ep) : ep->total_state) < PING_UNAVAILABLE) {
+      _pingData.inet.hosts_available++;
+    };
+    if (hostsChecked++ == 0) {
+      _pingData.inet.duration_ms_min = ep->total_duration_ms;
+      _pingData.inet.duration_ms_max = ep->total_duration_ms;
+      _pingData.inet.loss_min = ep->total_loss;
+      _pingData.inet.loss_max = ep->total_loss;
+    } else {
+      PING_SET_MIN(ep->total_duration_ms, _pingData.inet.duration_ms_min, ep->total_loss, _maxUnavailableLoss);
+      PING_SET_MAX(ep->total_duration_ms, _pingData.inet.duration_ms_max);
+      PING_SET_MIN(ep->total_loss, _pingData.inet.loss_min, ep->total_duration_ms, _maxUnavailableDuration);
+      PING_SET_MAX(ep->total_loss, _pingData.inet.loss_max);
+    };
+    hostsDuration += ep->total_duration_ms;
+    hostsLoss += ep->total_loss;
+    pingerCopyHostData(ep, &_pingData.hosts[i]);
+    pingerCopyHostStats(ep, &_pingData.hosts_stats[i]);
+    if (ep->received > 0) {
+      hostsMdev += ep->total_mdev_us;
+      hostsJitter += (uint32_t)ep->jitter_us;
+      hostsResponded++;
+    };
+  };
+  _pingData.inet.hosts_count = _pingHostsCount;
+  _pingData.inet_stats.hosts_checked = hostsChecked;
+  if (hostsChecked > 0) {
+    _pingData.inet.duration_ms_total = hostsDuration / hostsChecked;
+    _pingData.inet.loss_total = hostsLoss / hostsChecked;
+  };
+  _pingData.inet_stats.rtt_mdev_us = hostsResponded > 0 ? hostsMdev / hostsResponded : 0;
+  _pingData.inet_stats.jitter_us = hostsResponded > 0 ? hostsJitter / hostsResponded : 0;
+  
+  // Determine the final results by which we will evaluate the status of Internet access
+  if (_resultMode == 0) {
+    _pingData.inet.duration_ms_total = _pingData.inet.duration_ms_min;
+    _pingData.inet.loss_total = _pingData.inet.loss_min;
+  }
+  else if (_resultMode == 2) {
+    _pingData.inet.duration_ms_total = _pingData.inet.duration_ms_max;
+    _pingData.inet.loss_total = _pingData.inet.loss_max;
+  };
+
+  // Remember unfiltered result
+  bool pingLastOk = ((_pingData.inet.hosts_available > 0) && (_pingData.inet.duration_ms_total < _maxSlowdownDuration) && (_pingData.inet.loss_total < _maxSlowdownLoss));
+  bool pingRawOk = pingLastOk;
+
+  // Filter for "smoothing" ping results (0 - disabled, 1 - average, 2 - median, 3 - EWMA)
+  #if (CONFIG_PINGER_FILTER_MODE > 0) && (CONFIG_PINGER_FILTER_SIZE > 0)
+    _pingData.inet.duration_ms_total = (uint32_t)(pingerFilterUpdate(&_filterDuration, _pingData.inet.duration_ms_total) + 0.5f);
+    _pingData.inet.loss_total = pingerFilterUpdate(&_filterLoss, _pingData.inet.loss_total);
+  #endif // CONFIG_PINGER_FILTER_MODE
+
+  // Analyze results and send events
+  if ((_pingData.inet.hosts_available > 0) && (_pingData.inet.duration_ms_total < _maxUnavailableDuration) && (_pingData.inet.loss_total <= _maxUnavailableLoss)) {
+    // Status analysis by total filtered response time
+    if ((_pingData.inet.duration_ms_total < _maxSlowdownDuration) && (_pingData.inet.loss_total < _maxSlowdownLoss)) {
+      inet_state = PING_OK;
+      rlog_i(logTAG, "Internet access is available (%d ms)", _pingData.inet.duration_ms_total);
+      // Posting an event only when the status changes
+      if (_pingData.inet.state != inet_state) {
+        _pingData.inet.state = inet_state;
+        pingerEventPost(RE_PING_INET_AVAILABLE, &_pingData.inet, sizeof(_pingData.inet));
+        _pingData.inet.time_unavailable = 0;
+      };
+    } else {
+      inet_state = PING_SLOWDOWN;
+      pingLastOk = false;
+      rlog_w(logTAG, "Internet access is slowed (%d ms)", _pingData.inet.duration_ms_total);
+      if (_pingData.inet.state != inet_state) {
+        if (_pingData.inet.time_unavailable == 0) {
+          _pingData.inet.time_unavailable = time(nullptr);
+        };
+        _pingData.inet.state = inet_state;
+        pingerEventPost(RE_PING_INET_SLOWDOWN, &_pingData.inet, sizeof(_pingData.inet));
+      };
+    };
+    _pingData.inet.count_unavailable = 0;
+  } else {
+    // Failed to reach any of the hosts
+    inet_state = PING_UNAVAILABLE;
+    pingLastOk = false;
+    rlog_e(logTAG, "Internet access is not available!");
+    if (_pingData.inet.state != inet_state) {
+      _pingData.inet.count_unavailable++;
+      if ((_pingData.inet.state <= PING_UNAVAILABLE) || (_pingData.inet.time_unavailable == 0)) {
+        _pingData.inet.time_unavailable = time(nullptr);
+      };
+      if ((_pingData.inet.state == PING_OK) || (_pingData.inet.state == PING_SLOWDOWN)) {
+        if (_pingData.inet.count_unavailable >= _thresholdUnavailable) {
+          _pingData.inet.state = PING_UNAVAILABLE;
+          pingerEventPost(RE_PING_INET_UNAVAILABLE, &_pingData.inet, sizeof(_pingData.inet));
+        };
+      } else {
+        _pingData.inet.state = PING_UNAVAILABLE;
+      };
+    };
+  };
+
+  // Publishing server check results
+  PINGER_PHASE_BEGIN(phasePublish);
+  #if CONFIG_MQTT_PINGER_ENABLE
+  pingerMqttPublish(&_pingData);
+  #endif // CONFIG_MQTT_PINGER_ENABLE
+  #if CONFIG_OPENMON_ENABLE && CONFIG_OPENMON_PINGER_ENABLE
+  pingerOpenMonPublish(&_pingData);
+  #endif // CONFIG_OPENMON_ENABLE && CONFIG_OPENMON_PINGER_ENABLE
+  PINGER_PHASE_END(PINGER_PHASE_PUBLISH, phasePublish);
+
+  // A change of the state is suspected when the result of this check has not yet been confirmed by the threshold, 
+  // or the filter still holds the previous state
+  *suspected = (inet_state != _pingData.inet.state) || (pingRawOk != (inet_state == PING_OK));
+  *last_ok = pingLastOk;
+  return inet_state;
+}
+
+// Results of the hosts on their own schedule between the rounds: only their own events are posted, 
+// returns true if the availability of any of them has changed
+static bool pingerOwnUpdate(pinger_data_t **targets, uint8_t count)
+{
+  bool changed = false;
+  for (uint8_t i = 0; i < count; i++) {
+    pinger_data_t *ep = targets[i];
+    if (!ep->checked) continue;
+    bool wasAvailable = ep->count_unavailable == 0;
+    if ((pingerCheckHost(ep) == PING_OK) != wasAvailable) changed = true;
+    uint8_t index = ep - _pingHosts;
+    pingerCopyHostData(ep, &_pingData.hosts[index]);
+    pingerCopyHostStats(ep, &_pingData.hosts_stats[index]);
+  };
+  return changed;
+}
+
+// Targets of the internet check round in the order of priority. With the quorum, hosts of equal priority are shifted 
+// every round, so that the results of all of them are refreshed
+static uint8_t pingerRoundTargets(pinger_data_t **targets)
+{
+  uint8_t count = 0;
+  uint8_t first = (_pingQuorum > 0) && (_pingHostsCount > 0) ? _pingQuorumFirst++ % _pingHostsCount : 0;
+  for (uint8_t k = 0; k < _pingHostsCount; k++) {
+    pinger_data_t *ep = &_pingHosts[(first + k) % _pingHostsCount];
+    if (ep->interval_ms == 0) {
+      uint8_t pos = count++;
+      while ((pos > 0) && (targets[pos - 1]->priority < ep->priority)) {
+        targets[pos] = targets[pos - 1];
+        pos--;
+      };
+      targets[pos] = ep;
+    };
+  };
+  return count;
+}
+
+uint32_t pingerCycleExec()
+{
+  TickType_t lastCheck = xTaskGetTickCount();
+  PINGER_PHASE_BEGIN(phaseCycle);
+  #if CONFIG_PINGER_RESOURCES
+    pingerResCycleBegin();
+  #endif // CONFIG_PINGER_RESOURCES
+
+  // Apply changes to the list of hosts
+  if (pingerHostsUpdate()) {
+    pingerQueueBuild();
+  };
+
+  // Targets that are due: the internet check round and the targets on their own schedule
+  pinger_data_t *inet[PING_TARGETS_MAX];
+  pinger_data_t *own[PING_TARGETS_MAX];
+  pinger_data_t *brokers[PING_BROKERS_MAX];
+  uint8_t due[PING_TARGETS_MAX];
+  uint8_t inetCount = 0, ownCount = 0, brokersCount = 0, dueCount = 0;
+  for (uint8_t i = 0; i < PING_TARGETS_MAX; i++) {
+    _pingHosts[i].checked = false;
+  };
+  bool round = (int32_t)(lastCheck - _pingRoundDue) >= 0;
+  if (round) {
+    rlog_i(logTAG, "Internet access is checked...");
+    if (_pingHostsCount == 0) {
+      rlog_w(logTAG, "The list of hosts for checking is empty");
+    };
+    inetCount = pingerRoundTargets(inet);
+    for (uint8_t i = 0; i < _pingBrokersCount; i++) {
+      if (_pingHosts[CONFIG_PINGER_HOSTS_MAX + i].interval_ms == 0) {
+        brokers[brokersCount++] = &_pingHosts[CONFIG_PINGER_HOSTS_MAX + i];
+      };
+    };
+  };
+  while ((_pingQueueSize > 0) && ((int32_t)(lastCheck - _pingHosts[_pingQueue[0]].next_due) >= 0)) {
+    uint8_t index = pingerQueuePop();
+    due[dueCount++] = index;
+    if (index < CONFIG_PINGER_HOSTS_MAX) {
+      own[ownCount++] = &_pingHosts[index];
+    } else {
+      brokers[brokersCount++] = &_pingHosts[index];
+    };
+  };
+
+  // All due targets are checked in one batch: the hosts of the round vote by the quorum, the hosts on their own schedule 
+  // and the brokers are checked completely. The state of the internet is evaluated only by the rounds, in which the hosts 
+  // on their own schedule take part with their last result
+  pinger_data_t *targets[PING_TARGETS_MAX];
+  uint8_t count = 0;
+  for (uint8_t i = 0; i < inetCount; i++) targets[count++] = inet[i];
+  for (uint8_t i = 0; i < ownCount; i++) targets[count++] = own[i];
+  for (uint8_t i = 0; i < brokersCount; i++) targets[count++] = brokers[i];
+  pingerCheckHostsEx(targets, count, inetCount, _pingQuorum);
+
+  bool pingLastOk = _pingData.inet.state == PING_OK;
+  if (round) {
+    bool suspected = false;
+    ping_state_t inet_state = pingerInetUpdate(&pingLastOk, &suspected);
+    uint32_t interval = pingerScheduleNext(inet_state, suspected, pingLastOk);
+    _pingRoundDue = (pingLastOk ? lastCheck : xTaskGetTickCount()) + pdMS_TO_TICKS(interval);
+  } else if (ownCount > 0) {
+    if (pingerOwnUpdate(own, ownCount) && (_intervalConfirm > 0)) {
+      // A host on its own schedule noticed a change, it is confirmed by the round ahead of time
+      TickType_t confirm = xTaskGetTickCount() + pdMS_TO_TICKS(_intervalConfirm);
+      if ((int32_t)(confirm - _pingRoundDue) < 0) _pingRoundDue = confirm;
+    };
+  };
+
+  // Additional checks for individual hosts are evaluated only while the internet is available
+  if (pingLastOk) {
+    for (uint8_t i = 0; i < brokersCount; i++) {
+      pingerCheckHost(brokers[i]);
+    };
+  };
+
+  // Next checks of the targets on their own schedule
+  for (uint8_t i = 0; i < dueCount; i++) {
+    _pingHosts[due[i]].next_due = lastCheck + pdMS_TO_TICKS(_pingHosts[due[i]].interval_ms);
+    pingerQueuePush(due[i]);
+  };
+
+  // Time of the phases of the cycle, published after the cycle itself
+  #if CONFIG_PINGER_PHASE_TIMING
+    PINGER_PHASE_END(PINGER_PHASE_CYCLE, phaseCycle);
+    pingerPhasesFinish();
+    #if CONFIG_MQTT_PINGER_ENABLE && CONFIG_MQTT_PINGER_PHASES
+      pingerMqttPublishPhases(&_pingPhases);
+    #endif // CONFIG_MQTT_PINGER_PHASES
+  #endif // CONFIG_PINGER_PHASE_TIMING
+  #if CONFIG_PINGER_RESOURCES
+    pingerResCycleEnd();
+    #if CONFIG_MQTT_PINGER_ENABLE && CONFIG_MQTT_PINGER_RESOURCES
+      pinger_resources_t resources;
+      pingerResourcesGet(&resources);
+      pingerMqttPublishResources(&resources);
+    #endif // CONFIG_MQTT_PINGER_RESOURCES
+  #endif // CONFIG_PINGER_RESOURCES
+
+  // Waiting until the nearest target is due
+  TickType_t next = _pingRoundDue;
+  if ((_pingQueueSize > 0) && ((int32_t)(_pingHosts[_pingQueue[0]].next_due - next) < 0)) {
+    next = _pingHosts[_pingQueue[0]].next_due;
+  };
+  TickType_t now = xTaskGetTickCount();
+  if ((int32_t)(next - now) > 0) {
+    return (next - now) * portTICK_PERIOD_MS;
+  };
+  return portTICK_PERIOD_MS;
+}
+
+void pingerCycleFree()
+{
+  pingerHostsFree();
+  pingerDnsFree();
+}
+
+static void pingerExec(void *args)
+{
+  static bool pingEnabled = true;
+  static BaseType_t waitResult;
+  static uint32_t waitFlags;
+  static TickType_t waitTicks = 0;
+
+  pingerCycleInit();
 
   // Posting an event
   rlog_i(logTAG, LOGMSG_SERVICE_STARTED);
@@ -620,14 +1862,14 @@ static void pingerExec(void *args)
 
   while (1) {
     // Waiting for task start or pause notifications
-    waitResult = xTaskNotifyWait(0, ULONG_MAX, &waitFlags, waitTicks);
+    waitResult = xTaskNotifyWait(0, UINT32_MAX, &waitFlags, waitTicks);
     if (waitResult == pdPASS) {
       if ((waitFlags & PING_START) == PING_START) {
         if (!pingEnabled) {
           pingEnabled = true;
           rlog_i(logTAG, LOGMSG_SERVICE_STARTED);
           eventLoopPost(RE_PING_EVENTS, RE_PING_STARTED, nullptr, 0, portMAX_DELAY);
-          data.inet.state = PING_FAILED;
+          pingerCycleRestart();
         };
       } else if ((waitFlags & PING_STOP) == PING_STOP) {
         if (pingEnabled) {
@@ -641,207 +1883,12 @@ static void pingerExec(void *args)
 
     // Performing pings
     if (pingEnabled) {
-      rlog_i(logTAG, "Internet access is checked...");
-      lastCheck = xTaskGetTickCount();
-
-      // Check hosts
-      data.inet.hosts_available = 0;
-      data.inet.duration_ms_min = 0;
-      data.inet.duration_ms_max = 0;
-      data.inet.loss_min = 0;
-      data.inet.loss_max = 0;
-
-      // Host 1
-      if (pingerCheckHost(&pdHost1, RE_PING_HOST_AVAILABLE, RE_PING_HOST_UNAVAILABLE) < PING_UNAVAILABLE) {
-        data.inet.hosts_available++;
-      };
-      data.inet.duration_ms_min = pdHost1.total_duration_ms;
-      data.inet.duration_ms_max = pdHost1.total_duration_ms;
-      data.inet.duration_ms_total = pdHost1.total_duration_ms;
-      data.inet.loss_min = pdHost1.total_loss;
-      data.inet.loss_max = pdHost1.total_loss;
-      data.inet.loss_total = pdHost1.total_loss;
-      pingerCopyHostData(&pdHost1, &data.host1);
-
-      // Host 2
-      #ifdef CONFIG_PINGER_HOST_2
-        if (pingerCheckHost(&pdHost2, RE_PING_HOST_AVAILABLE, RE_PING_HOST_UNAVAILABLE) < PING_UNAVAILABLE) {
-          data.inet.hosts_available++;
-        };
-        data.inet.duration_ms_total = (pdHost1.total_duration_ms + pdHost2.total_duration_ms) / 2;
-        data.inet.loss_total = (pdHost1.total_loss + pdHost2.total_loss) / 2;
-        PING_SET_MIN(pdHost2.total_duration_ms, data.inet.duration_ms_min, pdHost2.total_loss, _maxUnavailableLoss);
-        PING_SET_MAX(pdHost2.total_duration_ms, data.inet.duration_ms_max);
-        PING_SET_MIN(pdHost2.total_loss, data.inet.loss_min, pdHost2.total_duration_ms, _maxUnavailableDuration);
-        PING_SET_MAX(pdHost2.total_loss, data.inet.loss_max);
-        pingerCopyHostData(&pdHost2, &data.host2);
-      #endif // CONFIG_PINGER_HOST_2
-
-      // Host 3
-      #ifdef CONFIG_PINGER_HOST_3
-        if (pingerCheckHost(&pdHost3, RE_PING_HOST_AVAILABLE, RE_PING_HOST_UNAVAILABLE) < PING_UNAVAILABLE) {
-          data.inet.hosts_available++;
-        };
-        data.inet.duration_ms_total = (pdHost1.total_duration_ms + pdHost2.total_duration_ms + pdHost3.total_duration_ms) / 3;
-        data.inet.loss_total = (pdHost1.total_loss + pdHost2.total_loss + pdHost3.total_loss) / 3;
-        PING_SET_MIN(pdHost3.total_duration_ms, data.inet.duration_ms_min, pdHost3.total_loss, _maxUnavailableLoss);
-        PING_SET_MAX(pdHost3.total_duration_ms, data.inet.duration_ms_max);
-        PING_SET_MIN(pdHost3.total_loss, data.inet.loss_min, pdHost3.total_duration_ms, _maxUnavailableDuration);
-        PING_SET_MAX(pdHost3.total_loss, data.inet.loss_max);
-        pingerCopyHostData(&pdHost3, &data.host3);
-      #endif // CONFIG_PINGER_HOST_3
-      
-      // Determine the final results by which we will evaluate the status of Internet access
-      if (_resultMode == 0) {
-        data.inet.duration_ms_total = data.inet.duration_ms_min;
-        data.inet.loss_total = data.inet.loss_min;
-      }
-      else if (_resultMode == 2) {
-        data.inet.duration_ms_total = data.inet.duration_ms_max;
-        data.inet.loss_total = data.inet.loss_max;
-      };
-
-      // Remember unfiltered result
-      pingLastOk = ((data.inet.hosts_available > 0) && (data.inet.duration_ms_total < _maxSlowdownDuration) && (data.inet.loss_total < _maxSlowdownLoss));
-
-      // Filter for "smoothing" ping results (0 - disabled, 1 - average, 2 - median)
-      #if (CONFIG_PINGER_FILTER_MODE > 0) && (CONFIG_PINGER_FILTER_SIZE > 0)
-        if (bufReset) {
-          bufReset = false;
-          for (uint8_t i = 0; i < CONFIG_PINGER_FILTER_SIZE; i++) {
-            bufDuration[i] = data.inet.duration_ms_total;
-          };
-        } else {
-          bufDuration[bufIndex] = data.inet.duration_ms_total;
-        };
-
-        #if CONFIG_PINGER_FILTER_MODE == 1
-          // Average
-          uint32_t sumDuration = 0;
-          for (uint16_t i = 0; i < CONFIG_PINGER_FILTER_SIZE; i++) {
-            sumDuration += bufDuration[i];
-          };
-          data.inet.duration_ms_total = (uint16_t)(sumDuration / CONFIG_PINGER_FILTER_SIZE);
-        #elif CONFIG_PINGER_FILTER_MODE == 2
-          // Median
-          if ((bufIndex < CONFIG_PINGER_FILTER_SIZE - 1) && (bufDuration[bufIndex] > bufDuration[bufIndex + 1])) {
-            for (int i = bufIndex; i < CONFIG_PINGER_FILTER_SIZE - 1; i++) {
-              if (bufDuration[i] > bufDuration[i + 1]) {
-                uint16_t buff = bufDuration[i];
-                bufDuration[i] = bufDuration[i + 1];
-                bufDuration[i + 1] = buff;
-              };
-            };
-          } else {
-            if ((bufIndex > 0) && (bufDuration[bufIndex - 1] > bufDuration[bufIndex])) {
-              for (int i = bufIndex; i > 0; i--) {
-                if (bufDuration[i] < bufDuration[i - 1]) {
-                  uint16_t buff = bufDuration[i];
-                  bufDuration[i] = bufDuration[i - 1];
-                  bufDuration[i - 1] = buff;
-                };
-              };
-            };
-          };
-          data.inet.duration_ms_total = bufDuration[CONFIG_PINGER_FILTER_SIZE / 2];
-        #endif // CONFIG_PINGER_FILTER_MODE
-
-        if (++bufIndex >= CONFIG_PINGER_FILTER_SIZE) bufIndex = 0;
-      #endif // CONFIG_PINGER_FILTER_MODE
-
-      // Analyze results and send events
-      if ((data.inet.hosts_available > 0) && (data.inet.duration_ms_total < _maxUnavailableDuration) && (data.inet.loss_total <= _maxUnavailableLoss)) {
-        // Status analysis by total filtered response time
-        if ((data.inet.duration_ms_total < _maxSlowdownDuration) && (data.inet.loss_total < _maxSlowdownLoss)) {
-          inet_state = PING_OK;
-          rlog_i(logTAG, "Internet access is available (%d ms)", data.inet.duration_ms_total);
-          // Posting an event only when the status changes
-          if (data.inet.state != inet_state) {
-            data.inet.state = inet_state;
-            eventLoopPost(RE_PING_EVENTS, RE_PING_INET_AVAILABLE, &data.inet, sizeof(data.inet), portMAX_DELAY);
-            data.inet.time_unavailable = 0;
-          };
-        } else {
-          inet_state = PING_SLOWDOWN;
-          pingLastOk = false;
-          rlog_w(logTAG, "Internet access is slowed (%d ms)", data.inet.duration_ms_total);
-          if (data.inet.state != inet_state) {
-            if (data.inet.time_unavailable == 0) {
-              data.inet.time_unavailable = time(nullptr);
-            };
-            data.inet.state = inet_state;
-            eventLoopPost(RE_PING_EVENTS, RE_PING_INET_SLOWDOWN, &data.inet, sizeof(data.inet), portMAX_DELAY);
-          };
-        };
-        data.inet.count_unavailable = 0;
-      } else {
-        // Failed to reach any of the hosts
-        inet_state = PING_UNAVAILABLE;
-        pingLastOk = false;
-        rlog_e(logTAG, "Internet access is not available!");
-        if (data.inet.state != inet_state) {
-          data.inet.count_unavailable++;
-          if ((data.inet.state <= PING_UNAVAILABLE) || (data.inet.time_unavailable == 0)) {
-            data.inet.time_unavailable = time(nullptr);
-          };
-          if ((data.inet.state == PING_OK) || (data.inet.state == PING_SLOWDOWN)) {
-            if (data.inet.count_unavailable >= _thresholdUnavailable) {
-              data.inet.state = PING_UNAVAILABLE;
-              eventLoopPost(RE_PING_EVENTS, RE_PING_INET_UNAVAILABLE, &data.inet, sizeof(data.inet), portMAX_DELAY);
-            };
-          } else {
-            data.inet.state = PING_UNAVAILABLE;
-          };
-        };
-      };
-
-      // Publishing server check results
-      #if CONFIG_MQTT_PINGER_ENABLE
-      pingerMqttPublish(&data);
-      #endif // CONFIG_MQTT_PINGER_ENABLE
-      #if CONFIG_OPENMON_ENABLE && CONFIG_OPENMON_PINGER_ENABLE
-      pingerOpenMonPublish(&data);
-      #endif // CONFIG_OPENMON_ENABLE && CONFIG_OPENMON_PINGER_ENABLE
-
-      // Additional checks for individual hosts
-      if (pingLastOk) {
-        #if CONFIG_MQTT1_PING_CHECK
-        pingerCheckHost(&pdMqtt1, RE_PING_MQTT1_AVAILABLE, RE_PING_MQTT1_UNAVAILABLE);
-        #endif // CONFIG_MQTT1_PING_CHECK
-        #if CONFIG_MQTT2_PING_CHECK
-        pingerCheckHost(&pdMqtt2, RE_PING_MQTT2_AVAILABLE, RE_PING_MQTT2_UNAVAILABLE);
-        #endif // CONFIG_MQTT2_PING_CHECK
-      };
-
-      // Waiting interval between periodic checks
-      if (pingLastOk) {
-        waitTicks = (xTaskGetTickCount() - lastCheck);
-        if (pdMS_TO_TICKS(_intervalAvailable) > waitTicks) {
-          waitTicks = pdMS_TO_TICKS(_intervalAvailable) - waitTicks;
-        } else {
-          waitTicks = 1;
-        };
-      } else {
-        waitTicks = pdMS_TO_TICKS(_intervalUnavailable);
-      };
+      waitTicks = pdMS_TO_TICKS(pingerCycleExec());
     };
   };
 
   // Before exit task, free all resources
-  pingerFreeSession(&pdHost1);
-  #ifdef CONFIG_PINGER_HOST_2
-  pingerFreeSession(&pdHost2);
-  #endif // CONFIG_PINGER_HOST_2
-  #ifdef CONFIG_PINGER_HOST_3
-  pingerFreeSession(&pdHost3);
-  #endif // CONFIG_PINGER_HOST_3
-
-  #if CONFIG_MQTT1_PING_CHECK
-  pingerFreeSession(&pdMqtt1);
-  #endif // CONFIG_MQTT1_PING_CHECK
-  #if CONFIG_MQTT2_PING_CHECK
-  pingerFreeSession(&pdMqtt2);
-  #endif // CONFIG_MQTT2_PING_CHECK
+  pingerCycleFree();
   
   // Delete task
   vTaskDelete(NULL);
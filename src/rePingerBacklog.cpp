@@ -0,0 +1,169 @@
+#include <string.h>
+#include <time.h>
+#include "project_config.h"
+#include "def_consts.h"
+#include "rLog.h"
+#include "rePingerBacklog.h"
+#ifdef CONFIG_MQTT_PINGER_BACKLOG_PARTITION
+#include "esp_partition.h"
+#endif // CONFIG_MQTT_PINGER_BACKLOG_PARTITION
+
+#if CONFIG_MQTT_PINGER_BACKLOG
+
+// Ring of the newest records in RAM
+static pinger_record_t _backlogRecords[CONFIG_MQTT_PINGER_BACKLOG_SIZE];
+static uint32_t _backlogHead = 0;
+static uint32_t _backlogCount = 0;
+
+#ifdef CONFIG_MQTT_PINGER_BACKLOG_PARTITION
+
+static const char* logTAG = "PING";
+
+// Records do not cross sector boundaries, a sector is erased before the first record is written into it
+#define PINGER_BACKLOG_SECTOR 4096
+#define PINGER_BACKLOG_PER_SECTOR (PINGER_BACKLOG_SECTOR / sizeof(pinger_record_t))
+
+// Log of the oldest records in flash memory
+static const esp_partition_t* _flashPartition = nullptr;
+static uint32_t _flashCapacity = 0;
+static uint32_t _flashHead = 0;
+static uint32_t _flashCount = 0;
+
+static size_t pingerBacklogFlashOffset(uint32_t slot)
+{
+  return (slot / PINGER_BACKLOG_PER_SECTOR) * PINGER_BACKLOG_SECTOR + (slot % PINGER_BACKLOG_PER_SECTOR) * sizeof(pinger_record_t);
+}
+
+static bool pingerBacklogFlashInit()
+{
+  _flashPartition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, CONFIG_MQTT_PINGER_BACKLOG_PARTITION);
+  if (!_flashPartition) {
+    rlog_e(logTAG, "Backlog partition [ %s ] not found", CONFIG_MQTT_PINGER_BACKLOG_PARTITION);
+    return false;
+  };
+  if (_flashPartition->size < 2 * PINGER_BACKLOG_SECTOR) {
+    rlog_e(logTAG, "Backlog partition [ %s ] is too small", CONFIG_MQTT_PINGER_BACKLOG_PARTITION);
+    _flashPartition = nullptr;
+    return false;
+  };
+  _flashCapacity = (_flashPartition->size / PINGER_BACKLOG_SECTOR) * PINGER_BACKLOG_PER_SECTOR;
+  _flashHead = 0;
+  _flashCount = 0;
+  rlog_i(logTAG, "Backlog partition [ %s ]: %d records", CONFIG_MQTT_PINGER_BACKLOG_PARTITION, (int)_flashCapacity);
+  return true;
+}
+
+static void pingerBacklogFlashPut(const pinger_record_t* record)
+{
+  uint32_t slot = (_flashHead + _flashCount) % _flashCapacity;
+  if ((slot % PINGER_BACKLOG_PER_SECTOR) == 0) {
+    // The sector still contains the oldest records: they are discarded up to the next sector
+    if (_flashCount > _flashCapacity - PINGER_BACKLOG_PER_SECTOR) {
+      uint32_t dropped = _flashCount - (_flashCapacity - PINGER_BACKLOG_PER_SECTOR);
+      _flashHead = (_flashHead + dropped) % _flashCapacity;
+      _flashCount -= dropped;
+      rlog_w(logTAG, "Backlog is full, %d oldest records have been discarded", (int)dropped);
+    };
+    esp_err_t err = esp_partition_erase_range(_flashPartition, pingerBacklogFlashOffset(slot), PINGER_BACKLOG_SECTOR);
+    if (err != ESP_OK) {
+      rlog_e(logTAG, "Failed to erase backlog sector: %d", err);
+      return;
+    };
+  };
+  esp_err_t err = esp_partition_write(_flashPartition, pingerBacklogFlashOffset(slot), record, sizeof(pinger_record_t));
+  if (err == ESP_OK) {
+    _flashCount++;
+  } else {
+    rlog_e(logTAG, "Failed to write backlog record: %d", err);
+  };
+}
+
+#endif // CONFIG_MQTT_PINGER_BACKLOG_PARTITION
+
+bool pingerBacklogInit()
+{
+  _backlogHead = 0;
+  _backlogCount = 0;
+  #ifdef CONFIG_MQTT_PINGER_BACKLOG_PARTITION
+    pingerBacklogFlashInit();
+  #endif // CONFIG_MQTT_PINGER_BACKLOG_PARTITION
+  return true;
+}
+
+static uint16_t pingerBacklogValue(uint32_t value)
+{
+  return value < UINT16_MAX ? value : UINT16_MAX;
+}
+
+void pingerBacklogPut(const pinger_publish_data_t* data)
+{
+  if (_backlogCount >= CONFIG_MQTT_PINGER_BACKLOG_SIZE) {
+    // The oldest record in RAM is moved to the flash memory or lost
+    #ifdef CONFIG_MQTT_PINGER_BACKLOG_PARTITION
+      if (_flashPartition) {
+        pingerBacklogFlashPut(&_backlogRecords[_backlogHead]);
+      };
+    #endif // CONFIG_MQTT_PINGER_BACKLOG_PARTITION
+    _backlogHead = (_backlogHead + 1) % CONFIG_MQTT_PINGER_BACKLOG_SIZE;
+    _backlogCount--;
+  };
+
+  pinger_record_t* record = &_backlogRecords[(_backlogHead + _backlogCount) % CONFIG_MQTT_PINGER_BACKLOG_SIZE];
+  memset(record, 0, sizeof(pinger_record_t));
+  record->time = (uint32_t)time(nullptr);
+  record->state = data->inet.state;
+  record->duration_ms = pingerBacklogValue(data->inet.duration_ms_total);
+  record->loss = pingerBacklogValue(data->inet.loss_total * 100.0f);
+  record->hosts_count = data->hosts_count < CONFIG_PINGER_HOSTS_MAX ? data->hosts_count : CONFIG_PINGER_HOSTS_MAX;
+  for (uint8_t i = 0; i < record->hosts_count; i++) {
+    if (data->hosts_stats[i].skipped) {
+      record->hosts[i].state = PINGER_BACKLOG_SKIPPED;
+      continue;
+    };
+    record->hosts[i].state = data->hosts[i].state;
+    record->hosts[i].duration_ms = pingerBacklogValue(data->hosts[i].duration_ms);
+    record->hosts[i].loss = pingerBacklogValue(data->hosts[i].loss * 100.0f);
+  };
+  _backlogCount++;
+}
+
+uint32_t pingerBacklogCount()
+{
+  #ifdef CONFIG_MQTT_PINGER_BACKLOG_PARTITION
+    return _flashCount + _backlogCount;
+  #else
+    return _backlogCount;
+  #endif // CONFIG_MQTT_PINGER_BACKLOG_PARTITION
+}
+
+bool pingerBacklogPeek(uint32_t index, pinger_record_t* record)
+{
+  #ifdef CONFIG_MQTT_PINGER_BACKLOG_PARTITION
+    // Records from the flash memory are older than the records in RAM
+    if (index < _flashCount) {
+      uint32_t slot = (_flashHead + index) % _flashCapacity;
+      return esp_partition_read(_flashPartition, pingerBacklogFlashOffset(slot), record, sizeof(pinger_record_t)) == ESP_OK;
+    };
+    index -= _flashCount;
+  #endif // CONFIG_MQTT_PINGER_BACKLOG_PARTITION
+  if (index >= _backlogCount) return false;
+  memcpy(record, &_backlogRecords[(_backlogHead + index) % CONFIG_MQTT_PINGER_BACKLOG_SIZE], sizeof(pinger_record_t));
+  return true;
+}
+
+void pingerBacklogDrop(uint32_t count)
+{
+  #ifdef CONFIG_MQTT_PINGER_BACKLOG_PARTITION
+    if (_flashCount > 0) {
+      uint32_t dropped = count < _flashCount ? count : _flashCount;
+      _flashHead = (_flashHead + dropped) % _flashCapacity;
+      _flashCount -= dropped;
+      count -= dropped;
+    };
+  #endif // CONFIG_MQTT_PINGER_BACKLOG_PARTITION
+  if (count > _backlogCount) count = _backlogCount;
+  _backlogHead = (_backlogHead + count) % CONFIG_MQTT_PINGER_BACKLOG_SIZE;
+  _backlogCount -= count;
+}
+
+#endif // CONFIG_MQTT_PINGER_BACKLOG
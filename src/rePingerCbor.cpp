@@ -0,0 +1,444 @@
+#include <string.h>
+#include "rePingerCbor.h"
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ------------------------------------------------------- Encoder -------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+#define CBOR_UINT     0x00
+#define CBOR_TEXT     0x60
+#define CBOR_ARRAY    0x80
+#define CBOR_MAP      0xA0
+#define CBOR_SIMPLE   0xE0
+
+#define CBOR_UINT8    24
+#define CBOR_UINT16   25
+#define CBOR_UINT32   26
+#define CBOR_UINT64   27
+#define CBOR_FLOAT32  (CBOR_SIMPLE | 26)
+#define CBOR_FLOAT64  (CBOR_SIMPLE | 27)
+
+typedef struct {
+  uint8_t* buffer;
+  size_t size;
+  size_t length;      // Length of the document, including the part that did not fit into the buffer
+} pinger_cbor_t;
+
+static void pingerCborPut(pinger_cbor_t* cbor, uint8_t value)
+{
+  if (cbor->length < cbor->size) {
+    cbor->buffer[cbor->length] = value;
+  };
+  cbor->length++;
+}
+
+// Big-endian argument of the given width, 1..8 bytes
+static void pingerCborPutBE(pinger_cbor_t* cbor, uint64_t value, uint8_t width)
+{
+  while (width > 0) {
+    width--;
+    pingerCborPut(cbor, (uint8_t)(value >> (width * 8)));
+  };
+}
+
+// Header of a string or container with the shortest length encoding
+static void pingerCborHead(pinger_cbor_t* cbor, uint8_t major, uint32_t length)
+{
+  if (length < 24) {
+    pingerCborPut(cbor, major | length);
+  } else if (length <= UINT8_MAX) {
+    pingerCborPut(cbor, major | CBOR_UINT8);
+    pingerCborPutBE(cbor, length, 1);
+  } else if (length <= UINT16_MAX) {
+    pingerCborPut(cbor, major | CBOR_UINT16);
+    pingerCborPutBE(cbor, length, 2);
+  } else {
+    pingerCborPut(cbor, major | CBOR_UINT32);
+    pingerCborPutBE(cbor, length, 4);
+  };
+}
+
+// Keys are always small, so they take one byte
+static void pingerCborKey(pinger_cbor_t* cbor, uint8_t key)
+{
+  pingerCborHead(cbor, CBOR_UINT, key);
+}
+
+static void pingerCborUint8(pinger_cbor_t* cbor, uint8_t key, uint8_t value)
+{
+  pingerCborKey(cbor, key);
+  pingerCborPut(cbor, CBOR_UINT | CBOR_UINT8);
+  pingerCborPutBE(cbor, value, 1);
+}
+
+static void pingerCborUint32(pinger_cbor_t* cbor, uint8_t key, uint32_t value)
+{
+  pingerCborKey(cbor, key);
+  pingerCborPut(cbor, CBOR_UINT | CBOR_UINT32);
+  pingerCborPutBE(cbor, value, 4);
+}
+
+static void pingerCborUint64(pinger_cbor_t* cbor, uint8_t key, uint64_t value)
+{
+  pingerCborKey(cbor, key);
+  pingerCborPut(cbor, CBOR_UINT | CBOR_UINT64);
+  pingerCborPutBE(cbor, value, 8);
+}
+
+static void pingerCborFloat(pinger_cbor_t* cbor, uint8_t key, float value)
+{
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  pingerCborKey(cbor, key);
+  pingerCborPut(cbor, CBOR_FLOAT32);
+  pingerCborPutBE(cbor, bits, 4);
+}
+
+static void pingerCborText(pinger_cbor_t* cbor, uint8_t key, const char* value)
+{
+  size_t len = value ? strlen(value) : 0;
+  pingerCborKey(cbor, key);
+  pingerCborHead(cbor, CBOR_TEXT, len);
+  for (size_t i = 0; i < len; i++) {
+    pingerCborPut(cbor, (uint8_t)value[i]);
+  };
+}
+
+static void pingerCborEncodeInet(pinger_cbor_t* cbor, ping_inet_data_t* data, pinger_inet_stats_t* stats)
+{
+  bool unavailable = data->state >= PING_UNAVAILABLE;
+  pingerCborHead(cbor, CBOR_MAP, unavailable ? 13 : 11);
+  pingerCborUint8(cbor, PINGER_CBOR_INET_STATE, data->state);
+  pingerCborUint8(cbor, PINGER_CBOR_INET_HOSTS_COUNT, data->hosts_count);
+  pingerCborUint8(cbor, PINGER_CBOR_INET_HOSTS_CHECKED, stats->hosts_checked);
+  pingerCborUint32(cbor, PINGER_CBOR_INET_DURATION_MIN, data->duration_ms_min);
+  pingerCborUint32(cbor, PINGER_CBOR_INET_DURATION_MAX, data->duration_ms_max);
+  pingerCborUint32(cbor, PINGER_CBOR_INET_DURATION_TOTAL, data->duration_ms_total);
+  pingerCborFloat(cbor, PINGER_CBOR_INET_LOSS_MIN, data->loss_min);
+  pingerCborFloat(cbor, PINGER_CBOR_INET_LOSS_MAX, data->loss_max);
+  pingerCborFloat(cbor, PINGER_CBOR_INET_LOSS_TOTAL, data->loss_total);
+  pingerCborUint32(cbor, PINGER_CBOR_INET_RTT_MDEV, stats->rtt_mdev_us);
+  pingerCborUint32(cbor, PINGER_CBOR_INET_JITTER, stats->jitter_us);
+  if (unavailable) {
+    pingerCborUint64(cbor, PINGER_CBOR_INET_TIME_UNAVAILABLE, (uint64_t)data->time_unavailable);
+    pingerCborUint32(cbor, PINGER_CBOR_INET_COUNT_UNAVAILABLE, data->count_unavailable);
+  };
+}
+
+static void pingerCborEncodeHost(pinger_cbor_t* cbor, ping_host_data_t* data, pinger_host_stats_t* stats)
+{
+  if (stats->skipped) {
+    pingerCborHead(cbor, CBOR_MAP, 2);
+    pingerCborText(cbor, PINGER_CBOR_HOST_NAME, data->host_name);
+    pingerCborUint8(cbor, PINGER_CBOR_HOST_SKIPPED, 1);
+    return;
+  };
+
+  bool unavailable = data->state >= PING_UNAVAILABLE;
+  pingerCborHead(cbor, CBOR_MAP, unavailable ? 17 : 16);
+  pingerCborText(cbor, PINGER_CBOR_HOST_NAME, data->host_name);
+  pingerCborUint8(cbor, PINGER_CBOR_HOST_STATE, data->state);
+  pingerCborUint32(cbor, PINGER_CBOR_HOST_TRANSMITTED, data->transmitted);
+  pingerCborUint32(cbor, PINGER_CBOR_HOST_RECEIVED, data->received);
+  pingerCborUint8(cbor, PINGER_CBOR_HOST_TTL, data->ttl);
+  pingerCborUint32(cbor, PINGER_CBOR_HOST_DURATION, data->duration_ms);
+  pingerCborFloat(cbor, PINGER_CBOR_HOST_LOSS, data->loss);
+  pingerCborUint32(cbor, PINGER_CBOR_HOST_RTT_P50, stats->rtt_p50_us);
+  pingerCborUint32(cbor, PINGER_CBOR_HOST_RTT_P95, stats->rtt_p95_us);
+  pingerCborUint32(cbor, PINGER_CBOR_HOST_RTT_P99, stats->rtt_p99_us);
+  pingerCborUint32(cbor, PINGER_CBOR_HOST_RTT_MDEV, stats->rtt_mdev_us);
+  pingerCborUint32(cbor, PINGER_CBOR_HOST_JITTER, stats->jitter_us);
+  pingerCborUint32(cbor, PINGER_CBOR_HOST_REPLIES_LATE, stats->replies_late);
+  pingerCborUint32(cbor, PINGER_CBOR_HOST_REPLIES_LATE_RTT, stats->late_rtt_us);
+  pingerCborUint32(cbor, PINGER_CBOR_HOST_REPLIES_DUPLICATE, stats->replies_duplicate);
+  pingerCborUint32(cbor, PINGER_CBOR_HOST_REPLIES_REORDERED, stats->replies_reordered);
+  if (unavailable) {
+    pingerCborUint64(cbor, PINGER_CBOR_HOST_TIME_UNAVAILABLE, (uint64_t)data->time_unavailable);
+  };
+}
+
+size_t pingerCborEncode(uint8_t* buffer, size_t size, pinger_publish_data_t* data, const bool* parts)
+{
+  pinger_cbor_t cbor;
+  cbor.buffer = buffer;
+  cbor.size = buffer ? size : 0;
+  cbor.length = 0;
+
+  uint8_t hosts_count = data->hosts_count < CONFIG_PINGER_HOSTS_MAX ? data->hosts_count : CONFIG_PINGER_HOSTS_MAX;
+  uint16_t count = 0;
+  for (uint16_t i = 0; i <= hosts_count; i++) {
+    if (!parts || parts[i]) count++;
+  };
+
+  pingerCborHead(&cbor, CBOR_MAP, count);
+  if (!parts || parts[0]) {
+    pingerCborKey(&cbor, 0);
+    pingerCborEncodeInet(&cbor, &data->inet, &data->inet_stats);
+  };
+  for (uint8_t i = 0; i < hosts_count; i++) {
+    if (!parts || parts[i + 1]) {
+      pingerCborHead(&cbor, CBOR_UINT, i + 1);
+      pingerCborEncodeHost(&cbor, &data->hosts[i], &data->hosts_stats[i]);
+    };
+  };
+
+  if (buffer && (cbor.length > size)) return 0;
+  return cbor.length;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ------------------------------------------------------- Decoder -------------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+// Nesting limit when skipping unknown values
+#define CBOR_DEPTH_MAX 4
+
+typedef struct {
+  const uint8_t* buffer;
+  size_t size;
+  size_t pos;
+} pinger_cbor_reader_t;
+
+// Reads the initial byte and its argument
+static bool pingerCborReadHead(pinger_cbor_reader_t* reader, uint8_t* major, uint8_t* info, uint64_t* value)
+{
+  if (reader->pos >= reader->size) return false;
+  uint8_t initial = reader->buffer[reader->pos++];
+  *major = initial & 0xE0;
+  *info = initial & 0x1F;
+  uint8_t width;
+  if (*info < 24) {
+    *value = *info;
+    return true;
+  } else if (*info == CBOR_UINT8) {
+    width = 1;
+  } else if (*info == CBOR_UINT16) {
+    width = 2;
+  } else if (*info == CBOR_UINT32) {
+    width = 4;
+  } else if (*info == CBOR_UINT64) {
+    width = 8;
+  } else {
+    // Indefinite lengths and reserved values are not used
+    return false;
+  };
+  if (reader->size - reader->pos < width) return false;
+  *value = 0;
+  for (uint8_t i = 0; i < width; i++) {
+    *value = (*value << 8) | reader->buffer[reader->pos++];
+  };
+  return true;
+}
+
+static bool pingerCborSkip(pinger_cbor_reader_t* reader, uint8_t depth)
+{
+  uint8_t major, info;
+  uint64_t value;
+  if ((depth > CBOR_DEPTH_MAX) || !pingerCborReadHead(reader, &major, &info, &value)) return false;
+  switch (major) {
+    case 0x40:          // Byte string
+    case CBOR_TEXT:
+      if (reader->size - reader->pos < value) return false;
+      reader->pos += value;
+      return true;
+    case CBOR_ARRAY:
+    case CBOR_MAP:
+      if (major == CBOR_MAP) value *= 2;
+      for (uint64_t i = 0; i < value; i++) {
+        if (!pingerCborSkip(reader, depth + 1)) return false;
+      };
+      return true;
+    case 0xC0:          // Tag, followed by the tagged item
+      return pingerCborSkip(reader, depth + 1);
+    default:
+      return true;
+  };
+}
+
+static bool pingerCborReadUint(pinger_cbor_reader_t* reader, uint64_t* value)
+{
+  uint8_t major, info;
+  return pingerCborReadHead(reader, &major, &info, value) && (major == CBOR_UINT);
+}
+
+static bool pingerCborReadFloat(pinger_cbor_reader_t* reader, float* value)
+{
+  uint8_t major, info;
+  uint64_t bits;
+  if (!pingerCborReadHead(reader, &major, &info, &bits)) return false;
+  if (major == CBOR_UINT) {
+    *value = (float)bits;
+  } else if ((major | info) == CBOR_FLOAT32) {
+    uint32_t bits32 = (uint32_t)bits;
+    memcpy(value, &bits32, sizeof(*value));
+  } else if ((major | info) == CBOR_FLOAT64) {
+    double value64;
+    memcpy(&value64, &bits, sizeof(value64));
+    *value = (float)value64;
+  } else {
+    return false;
+  };
+  return true;
+}
+
+// The text is copied to the names buffer
+static bool pingerCborReadText(pinger_cbor_reader_t* reader, const char** value, char** names, size_t* names_size)
+{
+  uint8_t major, info;
+  uint64_t len;
+  if (!pingerCborReadHead(reader, &major, &info, &len) || (major != CBOR_TEXT)) return false;
+  if (reader->size - reader->pos < len) return false;
+  if (*names && (len < *names_size)) {
+    memcpy(*names, reader->buffer + reader->pos, len);
+    (*names)[len] = 0;
+    *value = *names;
+    *names += len + 1;
+    *names_size -= len + 1;
+  } else {
+    *value = nullptr;
+  };
+  reader->pos += len;
+  return true;
+}
+
+static bool pingerCborDecodeInet(pinger_cbor_reader_t* reader, ping_inet_data_t* data, pinger_inet_stats_t* stats)
+{
+  uint8_t major, info;
+  uint64_t count, key, value = 0;
+  if (!pingerCborReadHead(reader, &major, &info, &count) || (major != CBOR_MAP)) return false;
+  for (uint64_t i = 0; i < count; i++) {
+    if (!pingerCborReadUint(reader, &key)) return false;
+    bool ok;
+    switch (key) {
+      case PINGER_CBOR_INET_LOSS_MIN:
+        ok = pingerCborReadFloat(reader, &data->loss_min);
+        break;
+      case PINGER_CBOR_INET_LOSS_MAX:
+        ok = pingerCborReadFloat(reader, &data->loss_max);
+        break;
+      case PINGER_CBOR_INET_LOSS_TOTAL:
+        ok = pingerCborReadFloat(reader, &data->loss_total);
+        break;
+      case PINGER_CBOR_INET_STATE:
+      case PINGER_CBOR_INET_DURATION_MIN:
+      case PINGER_CBOR_INET_DURATION_MAX:
+      case PINGER_CBOR_INET_DURATION_TOTAL:
+      case PINGER_CBOR_INET_RTT_MDEV:
+      case PINGER_CBOR_INET_JITTER:
+      case PINGER_CBOR_INET_TIME_UNAVAILABLE:
+      case PINGER_CBOR_INET_COUNT_UNAVAILABLE:
+      case PINGER_CBOR_INET_HOSTS_COUNT:
+      case PINGER_CBOR_INET_HOSTS_CHECKED:
+        ok = pingerCborReadUint(reader, &value);
+        break;
+      default:
+        ok = pingerCborSkip(reader, 1);
+        break;
+    };
+    if (!ok) return false;
+    switch (key) {
+      case PINGER_CBOR_INET_STATE:             data->state = (ping_state_t)value;          break;
+      case PINGER_CBOR_INET_DURATION_MIN:      data->duration_ms_min = value;              break;
+      case PINGER_CBOR_INET_DURATION_MAX:      data->duration_ms_max = value;              break;
+      case PINGER_CBOR_INET_DURATION_TOTAL:    data->duration_ms_total = value;            break;
+      case PINGER_CBOR_INET_RTT_MDEV:          stats->rtt_mdev_us = value;                 break;
+      case PINGER_CBOR_INET_JITTER:            stats->jitter_us = value;                   break;
+      case PINGER_CBOR_INET_TIME_UNAVAILABLE:  data->time_unavailable = (time_t)value;     break;
+      case PINGER_CBOR_INET_COUNT_UNAVAILABLE: data->count_unavailable = value;            break;
+      case PINGER_CBOR_INET_HOSTS_COUNT:       data->hosts_count = value;                  break;
+      case PINGER_CBOR_INET_HOSTS_CHECKED:     stats->hosts_checked = value;               break;
+      default: break;
+    };
+  };
+  return true;
+}
+
+static bool pingerCborDecodeHost(pinger_cbor_reader_t* reader, ping_host_data_t* data, pinger_host_stats_t* stats, char** names, size_t* names_size)
+{
+  uint8_t major, info;
+  uint64_t count, key, value = 0;
+  if (!pingerCborReadHead(reader, &major, &info, &count) || (major != CBOR_MAP)) return false;
+  // The flag is present only in the subtree of a skipped host
+  stats->skipped = false;
+  for (uint64_t i = 0; i < count; i++) {
+    if (!pingerCborReadUint(reader, &key)) return false;
+    bool ok;
+    switch (key) {
+      case PINGER_CBOR_HOST_NAME:
+        ok = pingerCborReadText(reader, &data->host_name, names, names_size);
+        break;
+      case PINGER_CBOR_HOST_LOSS:
+        ok = pingerCborReadFloat(reader, &data->loss);
+        break;
+      case PINGER_CBOR_HOST_STATE:
+      case PINGER_CBOR_HOST_TRANSMITTED:
+      case PINGER_CBOR_HOST_RECEIVED:
+      case PINGER_CBOR_HOST_TTL:
+      case PINGER_CBOR_HOST_DURATION:
+      case PINGER_CBOR_HOST_RTT_P50:
+      case PINGER_CBOR_HOST_RTT_P95:
+      case PINGER_CBOR_HOST_RTT_P99:
+      case PINGER_CBOR_HOST_RTT_MDEV:
+      case PINGER_CBOR_HOST_JITTER:
+      case PINGER_CBOR_HOST_TIME_UNAVAILABLE:
+      case PINGER_CBOR_HOST_REPLIES_LATE:
+      case PINGER_CBOR_HOST_REPLIES_LATE_RTT:
+      case PINGER_CBOR_HOST_REPLIES_DUPLICATE:
+      case PINGER_CBOR_HOST_REPLIES_REORDERED:
+      case PINGER_CBOR_HOST_SKIPPED:
+        ok = pingerCborReadUint(reader, &value);
+        break;
+      default:
+        ok = pingerCborSkip(reader, 1);
+        break;
+    };
+    if (!ok) return false;
+    switch (key) {
+      case PINGER_CBOR_HOST_STATE:            data->state = (ping_state_t)value;           break;
+      case PINGER_CBOR_HOST_TRANSMITTED:      data->transmitted = value;                   break;
+      case PINGER_CBOR_HOST_RECEIVED:         data->received = value;                      break;
+      case PINGER_CBOR_HOST_TTL:              data->ttl = value;                           break;
+      case PINGER_CBOR_HOST_DURATION:         data->duration_ms = value;                   break;
+      case PINGER_CBOR_HOST_RTT_P50:          stats->rtt_p50_us = value;                   break;
+      case PINGER_CBOR_HOST_RTT_P95:          stats->rtt_p95_us = value;                   break;
+      case PINGER_CBOR_HOST_RTT_P99:          stats->rtt_p99_us = value;                   break;
+      case PINGER_CBOR_HOST_RTT_MDEV:         stats->rtt_mdev_us = value;                  break;
+      case PINGER_CBOR_HOST_JITTER:           stats->jitter_us = value;                    break;
+      case PINGER_CBOR_HOST_TIME_UNAVAILABLE: data->time_unavailable = (time_t)value;      break;
+      case PINGER_CBOR_HOST_REPLIES_LATE:     stats->replies_late = value;                 break;
+      case PINGER_CBOR_HOST_REPLIES_LATE_RTT: stats->late_rtt_us = value;                  break;
+      case PINGER_CBOR_HOST_REPLIES_DUPLICATE: stats->replies_duplicate = value;           break;
+      case PINGER_CBOR_HOST_REPLIES_REORDERED: stats->replies_reordered = value;           break;
+      case PINGER_CBOR_HOST_SKIPPED:          stats->skipped = value != 0;                 break;
+      default: break;
+    };
+  };
+  return true;
+}
+
+bool pingerCborDecode(const uint8_t* buffer, size_t size, pinger_publish_data_t* data, bool* parts, char* names, size_t names_size)
+{
+  pinger_cbor_reader_t reader;
+  reader.buffer = buffer;
+  reader.size = size;
+  reader.pos = 0;
+
+  if (parts) memset(parts, 0, sizeof(bool) * (CONFIG_PINGER_HOSTS_MAX + 1));
+  uint8_t major, info;
+  uint64_t count, key;
+  if (!pingerCborReadHead(&reader, &major, &info, &count) || (major != CBOR_MAP)) return false;
+  for (uint64_t i = 0; i < count; i++) {
+    if (!pingerCborReadUint(&reader, &key)) return false;
+    if (key == 0) {
+      if (!pingerCborDecodeInet(&reader, &data->inet, &data->inet_stats)) return false;
+    } else if (key <= CONFIG_PINGER_HOSTS_MAX) {
+      if (!pingerCborDecodeHost(&reader, &data->hosts[key - 1], &data->hosts_stats[key - 1], &names, &names_size)) return false;
+      if (key > data->hosts_count) data->hosts_count = key;
+    } else {
+      if (!pingerCborSkip(&reader, 1)) return false;
+      continue;
+    };
+    if (parts) parts[key] = true;
+  };
+  return reader.pos == size;
+}
@@ -0,0 +1,180 @@
+#include <string.h>
+#include <strings.h>
+#include "project_config.h"
+#include "def_consts.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "lwip/opt.h"
+#include "lwip/dns.h"
+#include "lwip/ip_addr.h"
+#include "rLog.h"
+#include "rePingerDns.h"
+#include "rePingerRes.h"
+
+static const char* logTAG = "PING";
+
+typedef struct {
+  char host_name[CONFIG_PINGER_HOSTNAME_MAX];
+  ip_addr_t addr;
+  volatile TickType_t resolved;       // Time of the last successful resolution, 0 - address is unknown
+  TickType_t requested;               // Time of the last request
+  TickType_t used;                    // Time of the last use, for replacing entries
+  volatile bool pending;              // Waiting for a response from the DNS server
+} pinger_dns_entry_t;
+
+static pinger_dns_entry_t _dnsCache[CONFIG_PINGER_DNS_CACHE_SIZE];
+static SemaphoreHandle_t _dnsSignal = nullptr;
+
+bool pingerDnsInit()
+{
+  if (!_dnsSignal) {
+    memset(_dnsCache, 0, sizeof(_dnsCache));
+    _dnsSignal = xSemaphoreCreateBinary();
+    if (!_dnsSignal) {
+      rlog_e(logTAG, "Failed to create DNS semaphore");
+      return false;
+    };
+  };
+  return true;
+}
+
+void pingerDnsFree()
+{
+  // Entries that are still waiting for a response are left in place, the callback will refer to them
+  for (uint8_t i = 0; i < CONFIG_PINGER_DNS_CACHE_SIZE; i++) {
+    if (!_dnsCache[i].pending) {
+      memset(&_dnsCache[i], 0, sizeof(pinger_dns_entry_t));
+    };
+  };
+}
+
+static pinger_dns_entry_t* pingerDnsFind(const char* hostname)
+{
+  for (uint8_t i = 0; i < CONFIG_PINGER_DNS_CACHE_SIZE; i++) {
+    if ((_dnsCache[i].host_name[0] != 0) && (strcasecmp(_dnsCache[i].host_name, hostname) == 0)) {
+      return &_dnsCache[i];
+    };
+  };
+  return nullptr;
+}
+
+static pinger_dns_entry_t* pingerDnsAdd(const char* hostname)
+{
+  // Free entry or the entry that has not been used for the longest time
+  pinger_dns_entry_t* entry = nullptr;
+  TickType_t now = xTaskGetTickCount();
+  for (uint8_t i = 0; i < CONFIG_PINGER_DNS_CACHE_SIZE; i++) {
+    if (!_dnsCache[i].pending) {
+      if (_dnsCache[i].host_name[0] == 0) {
+        entry = &_dnsCache[i];
+        break;
+      };
+      if ((entry == nullptr) || ((now - _dnsCache[i].used) > (now - entry->used))) {
+        entry = &_dnsCache[i];
+      };
+    };
+  };
+  if (entry) {
+    memset(entry, 0, sizeof(pinger_dns_entry_t));
+    strncpy(entry->host_name, hostname, sizeof(entry->host_name) - 1);
+  };
+  return entry;
+}
+
+#if LWIP_DNS
+// Called from the TCP/IP task
+static void pingerDnsFound(const char* hostname, const ip_addr_t *ipaddr, void *arg)
+{
+  pinger_dns_entry_t* entry = (pinger_dns_entry_t*)arg;
+  if (ipaddr) {
+    entry->addr = *ipaddr;
+    entry->resolved = xTaskGetTickCount();
+    // Zero tick means "unknown address"
+    if (entry->resolved == 0) entry->resolved = 1;
+  } else {
+    PINGER_RES_DNS(true);
+  };
+  entry->pending = false;
+  if (_dnsSignal) xSemaphoreGive(_dnsSignal);
+}
+#endif /* LWIP_DNS */
+
+void pingerDnsRequest(const char* hostname, bool refresh)
+{
+  pinger_dns_entry_t* entry = pingerDnsFind(hostname);
+  if (!entry) {
+    entry = pingerDnsAdd(hostname);
+    if (!entry) {
+      rlog_e(logTAG, "No free entries in the DNS cache for [ %s ]", hostname);
+      return;
+    };
+  };
+
+  TickType_t now = xTaskGetTickCount();
+  entry->used = now;
+  if (entry->pending) return;
+
+  // Is it time to update the address?
+  bool expired = (entry->resolved == 0) || ((now - entry->resolved) > pdMS_TO_TICKS(CONFIG_PINGER_IP_VALIDITY));
+  if (!(expired || refresh)) return;
+  if ((entry->requested != 0) && ((now - entry->requested) < pdMS_TO_TICKS(CONFIG_PINGER_DNS_RETRY))) return;
+  entry->requested = now;
+
+  // The address is not reset, the old one is used until the new one is received
+  ip_addr_t addr;
+  ip_addr_set_zero(&addr);
+  err_t err;
+  entry->pending = true;
+  PINGER_RES_DNS(false);
+  #if LWIP_DNS
+    err = dns_gethostbyname(entry->host_name, &addr, pingerDnsFound, entry);
+  #else
+    err = ipaddr_aton(entry->host_name, &addr) ? ERR_OK : ERR_ARG;
+  #endif // LWIP_DNS
+  if (err == ERR_INPROGRESS) return;
+  entry->pending = false;
+
+  if (err == ERR_OK) {
+    // Literal address or a valid record in the lwIP cache
+    entry->addr = addr;
+    entry->resolved = now ? now : 1;
+  } else {
+    PINGER_RES_DNS(true);
+    rlog_e(logTAG, "Failed to resolve a hostname [ %s ]: %d", entry->host_name, err);
+  };
+}
+
+void pingerDnsWait(TickType_t timeout)
+{
+  TickType_t start = xTaskGetTickCount();
+  while (1) {
+    bool waiting = false;
+    for (uint8_t i = 0; i < CONFIG_PINGER_DNS_CACHE_SIZE; i++) {
+      if (_dnsCache[i].pending && (_dnsCache[i].resolved == 0)) {
+        waiting = true;
+        break;
+      };
+    };
+    if (!waiting) return;
+
+    TickType_t elapsed = xTaskGetTickCount() - start;
+    if (elapsed >= timeout) return;
+    if (_dnsSignal) {
+      xSemaphoreTake(_dnsSignal, timeout - elapsed);
+    } else {
+      vTaskDelay(1);
+    };
+  };
+}
+
+bool pingerDnsGet(const char* hostname, ip_addr_t* addr, TickType_t* resolved)
+{
+  pinger_dns_entry_t* entry = pingerDnsFind(hostname);
+  if (entry && (entry->resolved != 0)) {
+    *addr = entry->addr;
+    *resolved = entry->resolved;
+    return true;
+  };
+  return false;
+}
@@ -0,0 +1,143 @@
+#include <string.h>
+#include "rePingerFilter.h"
+
+#if (CONFIG_PINGER_FILTER_MODE > 0) && (CONFIG_PINGER_FILTER_SIZE > 0)
+
+void pingerFilterReset(pinger_filter_t* filter)
+{
+  memset(filter, 0, sizeof(pinger_filter_t));
+  #if CONFIG_PINGER_FILTER_MODE == PINGER_FILTER_MEDIAN
+    // Initial arrangement of the slots: 0 - median, odd - max-heap, even - min-heap
+    for (int16_t i = 0; i < CONFIG_PINGER_FILTER_SIZE; i++) {
+      filter->pos[i] = ((i + 1) / 2) * ((i & 1) ? -1 : 1);
+      filter->heap[filter->pos[i] + CONFIG_PINGER_FILTER_SIZE / 2] = i;
+    };
+  #endif // CONFIG_PINGER_FILTER_MODE
+}
+
+#if CONFIG_PINGER_FILTER_MODE == PINGER_FILTER_AVERAGE
+
+// Average: the running sum is corrected by the incoming and outgoing values, O(1)
+float pingerFilterUpdate(pinger_filter_t* filter, float value)
+{
+  if (filter->count < CONFIG_PINGER_FILTER_SIZE) {
+    filter->count++;
+  } else {
+    filter->sum -= filter->values[filter->index];
+  };
+  filter->values[filter->index] = value;
+  filter->sum += value;
+  if (++filter->index >= CONFIG_PINGER_FILTER_SIZE) filter->index = 0;
+  return (float)(filter->sum / filter->count);
+}
+
+#elif CONFIG_PINGER_FILTER_MODE == PINGER_FILTER_MEDIAN
+
+// Median: two heaps around the median element, which are indexed from the ring of values, O(log n).
+// Negative positions belong to the max-heap of the smaller half, positive ones to the min-heap of the larger half.
+
+#define HEAP(f, i) ((f)->heap[(i) + CONFIG_PINGER_FILTER_SIZE / 2])
+#define MIN_COUNT(f) (((f)->count - 1) / 2)
+#define MAX_COUNT(f) ((f)->count / 2)
+
+static bool pingerMedianLess(pinger_filter_t* filter, int16_t i, int16_t j)
+{
+  return filter->values[HEAP(filter, i)] < filter->values[HEAP(filter, j)];
+}
+
+// Swap the slots if the first is less than the second
+static bool pingerMedianSwap(pinger_filter_t* filter, int16_t i, int16_t j)
+{
+  if (pingerMedianLess(filter, i, j)) {
+    uint16_t temp = HEAP(filter, i);
+    HEAP(filter, i) = HEAP(filter, j);
+    HEAP(filter, j) = temp;
+    filter->pos[HEAP(filter, i)] = i;
+    filter->pos[HEAP(filter, j)] = j;
+    return true;
+  };
+  return false;
+}
+
+static void pingerMedianMinDown(pinger_filter_t* filter, int16_t i)
+{
+  for (i *= 2; i <= MIN_COUNT(filter); i *= 2) {
+    if ((i < MIN_COUNT(filter)) && pingerMedianLess(filter, i + 1, i)) i++;
+    if (!pingerMedianSwap(filter, i, i / 2)) break;
+  };
+}
+
+static void pingerMedianMaxDown(pinger_filter_t* filter, int16_t i)
+{
+  for (i *= 2; i >= -MAX_COUNT(filter); i *= 2) {
+    if ((i > -MAX_COUNT(filter)) && pingerMedianLess(filter, i, i - 1)) i--;
+    if (!pingerMedianSwap(filter, i / 2, i)) break;
+  };
+}
+
+// Returns true if the value has reached the median position
+static bool pingerMedianMinUp(pinger_filter_t* filter, int16_t i)
+{
+  while ((i > 0) && pingerMedianSwap(filter, i, i / 2)) i /= 2;
+  return i == 0;
+}
+
+static bool pingerMedianMaxUp(pinger_filter_t* filter, int16_t i)
+{
+  while ((i < 0) && pingerMedianSwap(filter, i / 2, i)) i /= 2;
+  return i == 0;
+}
+
+float pingerFilterUpdate(pinger_filter_t* filter, float value)
+{
+  bool added = filter->count < CONFIG_PINGER_FILTER_SIZE;
+  int16_t p = filter->pos[filter->index];
+  float old = filter->values[filter->index];
+  filter->values[filter->index] = value;
+  if (++filter->index >= CONFIG_PINGER_FILTER_SIZE) filter->index = 0;
+  if (added) filter->count++;
+
+  if (p > 0) {
+    // The new value replaces a value in the min-heap
+    if (!added && (old < value)) {
+      pingerMedianMinDown(filter, p);
+    } else if (pingerMedianMinUp(filter, p) && pingerMedianSwap(filter, 0, -1)) {
+      pingerMedianMaxDown(filter, -1);
+    };
+  } else if (p < 0) {
+    // The new value replaces a value in the max-heap
+    if (!added && (value < old)) {
+      pingerMedianMaxDown(filter, p);
+    } else if (pingerMedianMaxUp(filter, p) && MIN_COUNT(filter) && pingerMedianSwap(filter, 1, 0)) {
+      pingerMedianMinDown(filter, 1);
+    };
+  } else {
+    // The new value replaces the median
+    if (MAX_COUNT(filter) && pingerMedianSwap(filter, 0, -1)) pingerMedianMaxDown(filter, -1);
+    if (MIN_COUNT(filter) && pingerMedianSwap(filter, 1, 0)) pingerMedianMinDown(filter, 1);
+  };
+
+  float median = filter->values[HEAP(filter, 0)];
+  if ((filter->count & 1) == 0) {
+    median = (median + filter->values[HEAP(filter, -1)]) / 2;
+  };
+  return median;
+}
+
+#elif CONFIG_PINGER_FILTER_MODE == PINGER_FILTER_EWMA
+
+// Exponential moving average with the same "center of mass" as the average over the window: alpha = 2 / (N + 1), O(1)
+float pingerFilterUpdate(pinger_filter_t* filter, float value)
+{
+  if (filter->count == 0) {
+    filter->count = 1;
+    filter->value = value;
+  } else {
+    filter->value += (value - filter->value) * 2.0f / (CONFIG_PINGER_FILTER_SIZE + 1);
+  };
+  return filter->value;
+}
+
+#endif // CONFIG_PINGER_FILTER_MODE
+
+#endif // CONFIG_PINGER_FILTER_MODE
@@ -1,25 +1,92 @@
 #include <stdlib.h>
+#include <stdarg.h>
+#include <math.h>
 #include <stdbool.h>
+#include <string.h>
 #include "project_config.h"
 #include "def_consts.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
 #include "rLog.h"
 #include "rePingerMqtt.h"
 #include "rStrings.h"
 #include "reEsp32.h"
 #include "reMqtt.h"
 #include "reStates.h"
+#include "rePingerWriter.h"
+#include "rePingerRes.h"
+#include "rePingerCbor.h"
+#include "rePingerBacklog.h"
 
 #if CONFIG_PINGER_ENABLE && CONFIG_MQTT_PINGER_ENABLE
 
 static const char *logTAG = "PING";
 static char* _mqttTopicPing = nullptr;
+#if CONFIG_MQTT_PINGER_AS_JSON
+static char* _mqttJsonBuffer = nullptr;
+#endif // CONFIG_MQTT_PINGER_AS_JSON
+#if CONFIG_MQTT_PINGER_AS_CBOR
+static char* _mqttTopicCbor = nullptr;
+static uint8_t _mqttCborBuffer[PINGER_CBOR_SIZE_MAX];
+static pinger_mqtt_raw_publish_t _mqttRawPublish = nullptr;
+#endif // CONFIG_MQTT_PINGER_AS_CBOR
+#if CONFIG_MQTT_PINGER_BACKLOG
+static char* _mqttTopicBacklog = nullptr;
+#endif // CONFIG_MQTT_PINGER_BACKLOG
+#if CONFIG_PINGER_PHASE_TIMING && CONFIG_MQTT_PINGER_PHASES
+static char* _mqttTopicPhases = nullptr;
+#endif // CONFIG_MQTT_PINGER_PHASES
+#if CONFIG_PINGER_RESOURCES && CONFIG_MQTT_PINGER_RESOURCES
+static char* _mqttTopicResources = nullptr;
+static int64_t _mqttResourcesTime = 0;
+#endif // CONFIG_MQTT_PINGER_RESOURCES
+#if (CONFIG_MQTT_PINGER_AS_JSON || CONFIG_MQTT_PINGER_AS_CBOR) && CONFIG_MQTT_PINGER_DELTA
+static void pingerMqttDocDeltaReset();
+#endif // (CONFIG_MQTT_PINGER_AS_JSON || CONFIG_MQTT_PINGER_AS_CBOR) && CONFIG_MQTT_PINGER_DELTA
+#if CONFIG_MQTT_PINGER_AS_PLAIN
+static bool pingerMqttTopicsCreate(uint8_t hosts_count);
+static void pingerMqttTopicsFree();
+static uint8_t _mqttTopicHosts = 0;
+#endif // CONFIG_MQTT_PINGER_AS_PLAIN
 
 char* mqttTopicPingerCreate(const bool primary)
 {
-  if (_mqttTopicPing) free(_mqttTopicPing);
-  _mqttTopicPing = mqttGetTopicDevice1(primary, CONFIG_MQTT_PINGER_LOCAL, CONFIG_MQTT_PINGER_TOPIC);
+  if (_mqttTopicPing) PINGER_FREE(_mqttTopicPing);
+  _mqttTopicPing = PINGER_TRACK(mqttGetTopicDevice1(primary, CONFIG_MQTT_PINGER_LOCAL, CONFIG_MQTT_PINGER_TOPIC));
   if (_mqttTopicPing) {
     rlog_i(logTAG, "Generated topic for publishing ping result: [ %s ]", _mqttTopicPing);
+    #if CONFIG_MQTT_PINGER_AS_PLAIN
+      pingerMqttTopicsCreate(_mqttTopicHosts);
+    #endif // CONFIG_MQTT_PINGER_AS_PLAIN
+    #if CONFIG_MQTT_PINGER_AS_JSON
+      if (!_mqttJsonBuffer) {
+        _mqttJsonBuffer = (char*)PINGER_MALLOC(CONFIG_MQTT_PINGER_JSON_SIZE_MAX);
+        if (!_mqttJsonBuffer) {
+          rlog_e(logTAG, "Failed to allocate the buffer of the JSON document (%d bytes)", (int)CONFIG_MQTT_PINGER_JSON_SIZE_MAX);
+        };
+      };
+    #endif // CONFIG_MQTT_PINGER_AS_JSON
+    #if CONFIG_MQTT_PINGER_AS_CBOR
+      if (_mqttTopicCbor) PINGER_FREE(_mqttTopicCbor);
+      _mqttTopicCbor = PINGER_TRACK(mqttGetSubTopic(_mqttTopicPing, CONFIG_MQTT_PINGER_CBOR_TOPIC));
+    #endif // CONFIG_MQTT_PINGER_AS_CBOR
+    #if CONFIG_MQTT_PINGER_BACKLOG
+      if (_mqttTopicBacklog) PINGER_FREE(_mqttTopicBacklog);
+      _mqttTopicBacklog = PINGER_TRACK(mqttGetSubTopic(_mqttTopicPing, CONFIG_MQTT_PINGER_BACKLOG_TOPIC));
+    #endif // CONFIG_MQTT_PINGER_BACKLOG
+    #if CONFIG_PINGER_PHASE_TIMING && CONFIG_MQTT_PINGER_PHASES
+      if (_mqttTopicPhases) PINGER_FREE(_mqttTopicPhases);
+      _mqttTopicPhases = PINGER_TRACK(mqttGetSubTopic(_mqttTopicPing, CONFIG_MQTT_PINGER_PHASES_TOPIC));
+    #endif // CONFIG_MQTT_PINGER_PHASES
+    #if CONFIG_PINGER_RESOURCES && CONFIG_MQTT_PINGER_RESOURCES
+      if (_mqttTopicResources) PINGER_FREE(_mqttTopicResources);
+      _mqttTopicResources = PINGER_TRACK(mqttGetSubTopic(_mqttTopicPing, CONFIG_MQTT_PINGER_RESOURCES_TOPIC));
+      _mqttResourcesTime = 0;
+    #endif // CONFIG_MQTT_PINGER_RESOURCES
+    #if (CONFIG_MQTT_PINGER_AS_JSON || CONFIG_MQTT_PINGER_AS_CBOR) && CONFIG_MQTT_PINGER_DELTA
+      pingerMqttDocDeltaReset();
+    #endif // (CONFIG_MQTT_PINGER_AS_JSON || CONFIG_MQTT_PINGER_AS_CBOR) && CONFIG_MQTT_PINGER_DELTA
   } else {
     rlog_e(logTAG, "Failed to generate topic for publishing ping result");
   };
@@ -33,402 +100,791 @@ char* mqttTopicPingerGet()
 
 void mqttTopicPingerFree()
 {
-  if (_mqttTopicPing) free(_mqttTopicPing);
+  #if CONFIG_MQTT_PINGER_AS_PLAIN
+    pingerMqttTopicsFree();
+  #endif // CONFIG_MQTT_PINGER_AS_PLAIN
+  #if CONFIG_MQTT_PINGER_AS_JSON
+    if (_mqttJsonBuffer) PINGER_FREE(_mqttJsonBuffer);
+    _mqttJsonBuffer = nullptr;
+  #endif // CONFIG_MQTT_PINGER_AS_JSON
+  #if CONFIG_MQTT_PINGER_AS_CBOR
+    if (_mqttTopicCbor) PINGER_FREE(_mqttTopicCbor);
+    _mqttTopicCbor = nullptr;
+  #endif // CONFIG_MQTT_PINGER_AS_CBOR
+  #if CONFIG_MQTT_PINGER_BACKLOG
+    if (_mqttTopicBacklog) PINGER_FREE(_mqttTopicBacklog);
+    _mqttTopicBacklog = nullptr;
+  #endif // CONFIG_MQTT_PINGER_BACKLOG
+  #if CONFIG_PINGER_PHASE_TIMING && CONFIG_MQTT_PINGER_PHASES
+    if (_mqttTopicPhases) PINGER_FREE(_mqttTopicPhases);
+    _mqttTopicPhases = nullptr;
+  #endif // CONFIG_MQTT_PINGER_PHASES
+  #if CONFIG_PINGER_RESOURCES && CONFIG_MQTT_PINGER_RESOURCES
+    if (_mqttTopicResources) PINGER_FREE(_mqttTopicResources);
+    _mqttTopicResources = nullptr;
+  #endif // CONFIG_MQTT_PINGER_RESOURCES
+  if (_mqttTopicPing) PINGER_FREE(_mqttTopicPing);
   _mqttTopicPing = nullptr;
   rlog_d(logTAG, "Topic for publishing ping result has been scrapped");
 }
 
-#if CONFIG_MQTT_PINGER_AS_PLAIN
+// -----------------------------------------------------------------------------------------------------------------------
+// -------------------------------------------------- Change detection ---------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
 
-void pingerMqttPublishHostPlain(const char* topic, ping_host_data_t* data)
-{
-  char* _mqttTopicPingHost = mqttGetSubTopic(_mqttTopicPing, topic);
-  RE_MEM_CHECK(logTAG, _mqttTopicPingHost, return);
-
-  mqttPublish(mqttGetSubTopic(_mqttTopicPingHost, "hostname"), 
-    (char*)data->host_name, 
-    CONFIG_MQTT_PINGER_QOS, CONFIG_MQTT_PINGER_RETAINED, true, false);
-  mqttPublish(mqttGetSubTopic(_mqttTopicPingHost, "state"), 
-    malloc_stringf("%d", data->state), 
-    CONFIG_MQTT_PINGER_QOS, CONFIG_MQTT_PINGER_RETAINED, true, true);
-  mqttPublish(mqttGetSubTopic(_mqttTopicPingHost, "packets/transmitted"), 
-    malloc_stringf("%d", data->transmitted), 
-    CONFIG_MQTT_PINGER_QOS, CONFIG_MQTT_PINGER_RETAINED, true, true);
-  mqttPublish(mqttGetSubTopic(_mqttTopicPingHost, "packets/received"), 
-    malloc_stringf("%d", data->received), 
-    CONFIG_MQTT_PINGER_QOS, CONFIG_MQTT_PINGER_RETAINED, true, true);
-  mqttPublish(mqttGetSubTopic(_mqttTopicPingHost, "packets/ttl"), 
-    malloc_stringf("%d", data->ttl), 
-    CONFIG_MQTT_PINGER_QOS, CONFIG_MQTT_PINGER_RETAINED, true, true);
+typedef enum {
+  PD_EXACT = 0,     // Any change, for states, counters and strings
+  PD_DURATION,
+  PD_LOSS,
+  PD_RTT
+} pinger_delta_kind_t;
 
-  #if CONFIG_SENSOR_STRING_ENABLE
-    mqttPublish(mqttGetSubTopic(_mqttTopicPingHost, "duration/" CONFIG_SENSOR_NUMERIC_VALUE), 
-      malloc_stringf(CONFIG_FORMAT_PING_TIMERESP_VALUE, data->duration_ms), 
-      CONFIG_MQTT_PINGER_QOS, CONFIG_MQTT_PINGER_RETAINED, true, true);
-    mqttPublish(mqttGetSubTopic(_mqttTopicPingHost, "duration/" CONFIG_SENSOR_STRING_VALUE), 
-      malloc_stringf(CONFIG_FORMAT_PING_TIMERESP_STRING, data->duration_ms), 
-      CONFIG_MQTT_PINGER_QOS, CONFIG_MQTT_PINGER_RETAINED, true, true);
-  #else
-    mqttPublish(mqttGetSubTopic(_mqttTopicPingHost, "duration"), 
-      malloc_stringf(CONFIG_FORMAT_PING_TIMERESP_VALUE, data->duration_ms), 
-      CONFIG_MQTT_PINGER_QOS, CONFIG_MQTT_PINGER_RETAINED, true, true);
-  #endif // CONFIG_SENSOR_STRING_ENABLE
-    
-  #if CONFIG_SENSOR_STRING_ENABLE
-    mqttPublish(mqttGetSubTopic(_mqttTopicPingHost, "loss/" CONFIG_SENSOR_NUMERIC_VALUE), 
-      malloc_stringf(CONFIG_FORMAT_PING_LOSS_VALUE, data->loss), 
-      CONFIG_MQTT_PINGER_QOS, CONFIG_MQTT_PINGER_RETAINED, true, true);
-    mqttPublish(mqttGetSubTopic(_mqttTopicPingHost, "loss/" CONFIG_SENSOR_STRING_VALUE), 
-      malloc_stringf(CONFIG_FORMAT_PING_LOSS_STRING, data->loss), 
-      CONFIG_MQTT_PINGER_QOS, CONFIG_MQTT_PINGER_RETAINED, true, true);
-  #else
-    mqttPublish(mqttGetSubTopic(_mqttTopicPingHost, "loss"), 
-      malloc_stringf(CONFIG_FORMAT_PING_LOSS_VALUE, data->loss), 
-      CONFIG_MQTT_PINGER_QOS, CONFIG_MQTT_PINGER_RETAINED, true, true);
-  #endif // CONFIG_SENSOR_STRING_ENABLE
+#if CONFIG_MQTT_PINGER_DELTA
+
+typedef struct {
+  double value;
+  TickType_t time;
+  bool valid;
+} pinger_delta_t;
+
+// The value is outside the deadband of the last published one or has not been published for too long
+static bool pingerDeltaExceeded(const pinger_delta_t* delta, double value, pinger_delta_kind_t kind)
+{
+  if (!delta->valid || ((xTaskGetTickCount() - delta->time) >= pdMS_TO_TICKS(CONFIG_MQTT_PINGER_HEARTBEAT * 1000))) {
+    return true;
+  };
+  double diff = fabs(value - delta->value);
+  if (kind == PD_EXACT) {
+    return diff != 0;
+  };
+  // The larger of the absolute and relative deadbands is used
+  double deadband = fabs(delta->value) * CONFIG_MQTT_PINGER_DEADBAND_RELATIVE / 100.0;
+  switch (kind) {
+    case PD_DURATION:
+      if (deadband < CONFIG_MQTT_PINGER_DEADBAND_DURATION) deadband = CONFIG_MQTT_PINGER_DEADBAND_DURATION;
+      break;
+    case PD_LOSS:
+      if (deadband < CONFIG_MQTT_PINGER_DEADBAND_LOSS) deadband = CONFIG_MQTT_PINGER_DEADBAND_LOSS;
+      break;
+    default:
+      if (deadband < CONFIG_MQTT_PINGER_DEADBAND_RTT) deadband = CONFIG_MQTT_PINGER_DEADBAND_RTT;
+      break;
+  };
+  return diff > deadband;
+}
 
-  mqttPublish(mqttGetSubTopic(_mqttTopicPingHost, "unavailable/time/unix"), 
-    malloc_stringf("%d", data->time_unavailable), 
-    CONFIG_MQTT_PINGER_QOS, CONFIG_MQTT_PINGER_RETAINED, true, true);
-  mqttPublish(mqttGetSubTopic(_mqttTopicPingHost, "unavailable/time/string"), 
-    malloc_timestr(CONFIG_FORMAT_DTS, data->time_unavailable), 
-    CONFIG_MQTT_PINGER_QOS, CONFIG_MQTT_PINGER_RETAINED, true, true);
+static void pingerDeltaStore(pinger_delta_t* delta, double value)
+{
+  delta->value = value;
+  delta->time = xTaskGetTickCount();
+  delta->valid = true;
+}
 
-  free(_mqttTopicPingHost);
+// Strings are compared by a hash
+static double pingerDeltaHash(const char* text)
+{
+  uint32_t hash = 2166136261UL;
+  while (text && *text) {
+    hash = (hash ^ (uint8_t)*text++) * 16777619UL;
+  };
+  return hash;
 }
 
-void pingerMqttPublishInetPlain(ping_inet_data_t* data)
+#if CONFIG_MQTT_PINGER_AS_PLAIN
+
+// Returns true if the value should be published, and remembers it as published
+static bool pingerDeltaCheck(pinger_delta_t* delta, double value, pinger_delta_kind_t kind, bool force)
 {
-  mqttPublish(mqttGetSubTopic(_mqttTopicPing, "internet/state"), 
-    malloc_stringf("%d", data->state), 
-    CONFIG_MQTT_PINGER_QOS, CONFIG_MQTT_PINGER_RETAINED, true, true);
+  if (force || pingerDeltaExceeded(delta, value, kind)) {
+    pingerDeltaStore(delta, value);
+    return true;
+  };
+  return false;
+}
+
+#endif // CONFIG_MQTT_PINGER_AS_PLAIN
+
+#endif // CONFIG_MQTT_PINGER_DELTA
+
+#if CONFIG_MQTT_PINGER_AS_PLAIN
+
+// -----------------------------------------------------------------------------------------------------------------------
+// ----------------------------------------------------- Topic table -----------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+// All topics are stored one after another in a single memory block and are built only when the base topic or 
+// the number of hosts changes
 
+typedef enum {
+  PT_INET_STATE = 0,
+  PT_INET_HOSTS_COUNT, PT_INET_HOSTS_CHECKED,
   #if CONFIG_SENSOR_STRING_ENABLE
-    mqttPublish(mqttGetSubTopic(_mqttTopicPing, "internet/duration/min/" CONFIG_SENSOR_NUMERIC_VALUE), 
-      malloc_stringf(CONFIG_FORMAT_PING_TIMERESP_VALUE, data->duration_ms_min), 
-      CONFIG_MQTT_PINGER_QOS, CONFIG_MQTT_PINGER_RETAINED, true, true);
-    mqttPublish(mqttGetSubTopic(_mqttTopicPing, "internet/duration/min/" CONFIG_SENSOR_STRING_VALUE), 
-      malloc_stringf(CONFIG_FORMAT_PING_TIMERESP_STRING, data->duration_ms_min), 
-      CONFIG_MQTT_PINGER_QOS, CONFIG_MQTT_PINGER_RETAINED, true, true);
+    PT_INET_DURATION_MIN, PT_INET_DURATION_MIN_STRING,
+    PT_INET_DURATION_MAX, PT_INET_DURATION_MAX_STRING,
+    PT_INET_DURATION_TOTAL, PT_INET_DURATION_TOTAL_STRING,
+    PT_INET_LOSS_MIN, PT_INET_LOSS_MIN_STRING,
+    PT_INET_LOSS_MAX, PT_INET_LOSS_MAX_STRING,
+    PT_INET_LOSS_TOTAL, PT_INET_LOSS_TOTAL_STRING,
   #else
-    mqttPublish(mqttGetSubTopic(_mqttTopicPing, "internet/duration/min"), 
-      malloc_stringf(CONFIG_FORMAT_PING_TIMERESP_VALUE, data->duration_ms_min), 
-      CONFIG_MQTT_PINGER_QOS, CONFIG_MQTT_PINGER_RETAINED, true, true);
+    PT_INET_DURATION_MIN, PT_INET_DURATION_MAX, PT_INET_DURATION_TOTAL,
+    PT_INET_LOSS_MIN, PT_INET_LOSS_MAX, PT_INET_LOSS_TOTAL,
   #endif // CONFIG_SENSOR_STRING_ENABLE
+  PT_INET_RTT_MDEV, PT_INET_RTT_JITTER,
+  PT_INET_UNAVAILABLE_UNIX, PT_INET_UNAVAILABLE_STRING, PT_INET_UNAVAILABLE_COUNT,
+  #ifdef CONFIG_FORMAT_PING_MIXED
+    PT_INET_DISPLAY,
+  #endif // CONFIG_FORMAT_PING_MIXED
+  PT_INET_MAX
+} pinger_inet_topic_t;
 
+static const char* _mqttTopicsInet[PT_INET_MAX] = {
+  "internet/state",
+  "internet/hosts/count", "internet/hosts/checked",
   #if CONFIG_SENSOR_STRING_ENABLE
-    mqttPublish(mqttGetSubTopic(_mqttTopicPing, "internet/duration/max/" CONFIG_SENSOR_NUMERIC_VALUE), 
-      malloc_stringf(CONFIG_FORMAT_PING_TIMERESP_VALUE, data->duration_ms_max), 
-      CONFIG_MQTT_PINGER_QOS, CONFIG_MQTT_PINGER_RETAINED, true, true);
-    mqttPublish(mqttGetSubTopic(_mqttTopicPing, "internet/duration/max/" CONFIG_SENSOR_STRING_VALUE), 
-      malloc_stringf(CONFIG_FORMAT_PING_TIMERESP_STRING, data->duration_ms_max), 
-      CONFIG_MQTT_PINGER_QOS, CONFIG_MQTT_PINGER_RETAINED, true, true);
+    "internet/duration/min/" CONFIG_SENSOR_NUMERIC_VALUE, "internet/duration/min/" CONFIG_SENSOR_STRING_VALUE,
+    "internet/duration/max/" CONFIG_SENSOR_NUMERIC_VALUE, "internet/duration/max/" CONFIG_SENSOR_STRING_VALUE,
+    "internet/duration/total/" CONFIG_SENSOR_NUMERIC_VALUE, "internet/duration/total/" CONFIG_SENSOR_STRING_VALUE,
+    "internet/loss/min/" CONFIG_SENSOR_NUMERIC_VALUE, "internet/loss/min/" CONFIG_SENSOR_STRING_VALUE,
+    "internet/loss/max/" CONFIG_SENSOR_NUMERIC_VALUE, "internet/loss/max/" CONFIG_SENSOR_STRING_VALUE,
+    "internet/loss/total/" CONFIG_SENSOR_NUMERIC_VALUE, "internet/loss/total/" CONFIG_SENSOR_STRING_VALUE,
   #else
-    mqttPublish(mqttGetSubTopic(_mqttTopicPing, "internet/duration/max"), 
-      malloc_stringf(CONFIG_FORMAT_PING_TIMERESP_VALUE, data->duration_ms_max), 
-      CONFIG_MQTT_PINGER_QOS, CONFIG_MQTT_PINGER_RETAINED, true, true);
+    "internet/duration/min", "internet/duration/max", "internet/duration/total",
+    "internet/loss/min", "internet/loss/max", "internet/loss/total",
   #endif // CONFIG_SENSOR_STRING_ENABLE
+  "internet/rtt/mdev", "internet/rtt/jitter",
+  "internet/unavailable/time/unix", "internet/unavailable/time/string", "internet/unavailable/count",
+  #ifdef CONFIG_FORMAT_PING_MIXED
+    "internet/" CONFIG_SENSOR_DISPLAY,
+  #endif // CONFIG_FORMAT_PING_MIXED
+};
 
+typedef enum {
+  PT_HOST_HOSTNAME = 0, 
+  PT_HOST_SKIPPED,
+  PT_HOST_STATE,
+  PT_HOST_TRANSMITTED, PT_HOST_RECEIVED, PT_HOST_TTL,
   #if CONFIG_SENSOR_STRING_ENABLE
-    mqttPublish(mqttGetSubTopic(_mqttTopicPing, "internet/duration/total/" CONFIG_SENSOR_NUMERIC_VALUE), 
-      malloc_stringf(CONFIG_FORMAT_PING_TIMERESP_VALUE, data->duration_ms_total), 
-      CONFIG_MQTT_PINGER_QOS, CONFIG_MQTT_PINGER_RETAINED, true, true);
-    mqttPublish(mqttGetSubTopic(_mqttTopicPing, "internet/duration/total/" CONFIG_SENSOR_STRING_VALUE), 
-      malloc_stringf(CONFIG_FORMAT_PING_TIMERESP_STRING, data->duration_ms_total), 
-      CONFIG_MQTT_PINGER_QOS, CONFIG_MQTT_PINGER_RETAINED, true, true);
+    PT_HOST_DURATION, PT_HOST_DURATION_STRING,
+    PT_HOST_LOSS, PT_HOST_LOSS_STRING,
   #else
-    mqttPublish(mqttGetSubTopic(_mqttTopicPing, "internet/duration/total"), 
-      malloc_stringf(CONFIG_FORMAT_PING_TIMERESP_VALUE, data->duration_ms_total), 
-      CONFIG_MQTT_PINGER_QOS, CONFIG_MQTT_PINGER_RETAINED, true, true);
+    PT_HOST_DURATION, PT_HOST_LOSS,
   #endif // CONFIG_SENSOR_STRING_ENABLE
-
+  PT_HOST_RTT_P50, PT_HOST_RTT_P95, PT_HOST_RTT_P99, PT_HOST_RTT_MDEV, PT_HOST_RTT_JITTER,
+  PT_HOST_REPLIES_LATE, PT_HOST_REPLIES_LATE_RTT, PT_HOST_REPLIES_DUPLICATE, PT_HOST_REPLIES_REORDERED,
+  PT_HOST_UNAVAILABLE_UNIX, PT_HOST_UNAVAILABLE_STRING,
+  PT_HOST_MAX
+} pinger_host_topic_t;
+
+static const char* _mqttTopicsHost[PT_HOST_MAX] = {
+  "hostname",
+  "skipped",
+  "state",
+  "packets/transmitted", "packets/received", "packets/ttl",
   #if CONFIG_SENSOR_STRING_ENABLE
-    mqttPublish(mqttGetSubTopic(_mqttTopicPing, "internet/loss/min/" CONFIG_SENSOR_NUMERIC_VALUE), 
-      malloc_stringf(CONFIG_FORMAT_PING_LOSS_VALUE, data->loss_min), 
-      CONFIG_MQTT_PINGER_QOS, CONFIG_MQTT_PINGER_RETAINED, true, true);
-    mqttPublish(mqttGetSubTopic(_mqttTopicPing, "internet/loss/min/" CONFIG_SENSOR_STRING_VALUE), 
-      malloc_stringf(CONFIG_FORMAT_PING_LOSS_STRING, data->loss_min), 
-      CONFIG_MQTT_PINGER_QOS, CONFIG_MQTT_PINGER_RETAINED, true, true);
+    "duration/" CONFIG_SENSOR_NUMERIC_VALUE, "duration/" CONFIG_SENSOR_STRING_VALUE,
+    "loss/" CONFIG_SENSOR_NUMERIC_VALUE, "loss/" CONFIG_SENSOR_STRING_VALUE,
   #else
-    mqttPublish(mqttGetSubTopic(_mqttTopicPing, "internet/loss/min"), 
-      malloc_stringf(CONFIG_FORMAT_PING_LOSS_VALUE, data->loss_min), 
-      CONFIG_MQTT_PINGER_QOS, CONFIG_MQTT_PINGER_RETAINED, true, true);
+    "duration", "loss",
   #endif // CONFIG_SENSOR_STRING_ENABLE
+  "rtt/p50", "rtt/p95", "rtt/p99", "rtt/mdev", "rtt/jitter",
+  "replies/late", "replies/late_rtt", "replies/duplicate", "replies/reordered",
+  "unavailable/time/unix", "unavailable/time/string",
+};
+
+#define PT_TOPICS_MAX (PT_INET_MAX + CONFIG_PINGER_HOSTS_MAX * PT_HOST_MAX)
+
+static char* _mqttTopicTable = nullptr;
+static uint16_t _mqttTopicIndex[PT_TOPICS_MAX];
+#if CONFIG_MQTT_PINGER_DELTA
+static pinger_delta_t _mqttTopicDelta[PT_TOPICS_MAX];
+#endif // CONFIG_MQTT_PINGER_DELTA
+
+static void pingerMqttWriteTopics(pinger_writer_t* table, uint8_t hosts_count)
+{
+  uint16_t n = 0;
+  for (uint8_t i = 0; i < PT_INET_MAX; i++) {
+    _mqttTopicIndex[n++] = table->length;
+    pingerWriterPrintf(table, "%s/%s", _mqttTopicPing, _mqttTopicsInet[i]);
+    pingerWriterPutc(table, 0);
+  };
+  for (uint8_t h = 0; h < hosts_count; h++) {
+    for (uint8_t i = 0; i < PT_HOST_MAX; i++) {
+      _mqttTopicIndex[n++] = table->length;
+      pingerWriterPrintf(table, "%s/host%d/%s", _mqttTopicPing, h + 1, _mqttTopicsHost[i]);
+      pingerWriterPutc(table, 0);
+    };
+  };
+}
+
+static void pingerMqttTopicsFree()
+{
+  if (_mqttTopicTable) PINGER_FREE(_mqttTopicTable);
+  _mqttTopicTable = nullptr;
+}
+
+static bool pingerMqttTopicsCreate(uint8_t hosts_count)
+{
+  pingerMqttTopicsFree();
+  if (!_mqttTopicPing) return false;
+  if (hosts_count > CONFIG_PINGER_HOSTS_MAX) hosts_count = CONFIG_PINGER_HOSTS_MAX;
+
+  // First pass calculates the size of the table, the second one fills it
+  pinger_writer_t table;
+  pingerWriterInit(&table, nullptr, 0);
+  pingerMqttWriteTopics(&table, hosts_count);
+  if (pingerWriterRequired(&table) > UINT16_MAX) {
+    rlog_e(logTAG, "Topic table is too large");
+    return false;
+  };
+  _mqttTopicTable = (char*)PINGER_MALLOC(pingerWriterRequired(&table));
+  RE_MEM_CHECK(logTAG, _mqttTopicTable, return false);
+  pingerWriterInit(&table, _mqttTopicTable, pingerWriterRequired(&table));
+  pingerMqttWriteTopics(&table, hosts_count);
+  _mqttTopicHosts = hosts_count;
+  #if CONFIG_MQTT_PINGER_DELTA
+    // After the topics change, all values are published again
+    memset(_mqttTopicDelta, 0, sizeof(_mqttTopicDelta));
+  #endif // CONFIG_MQTT_PINGER_DELTA
+  rlog_d(logTAG, "Topic table for %d hosts has been generated, %d bytes", hosts_count, (int)table.length);
+  return true;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------
+// -------------------------------------------------- Plain publishing ---------------------------------------------------
+// -----------------------------------------------------------------------------------------------------------------------
+
+// Values are formatted on the stack, topics are taken from the table, so no memory is allocated here.
+// In the change-driven mode, the value is published only if it has changed beyond the deadband; returns true if published
+static bool pingerMqttPublishField(uint16_t topic, pinger_delta_kind_t kind, double value, bool force, const char* format, ...) 
+  __attribute__ ((format (printf, 5, 6)));
+static bool pingerMqttPublishField(uint16_t topic, pinger_delta_kind_t kind, double value, bool force, const char* format, ...)
+{
+  #if CONFIG_MQTT_PINGER_DELTA
+    if (!pingerDeltaCheck(&_mqttTopicDelta[topic], value, kind, force)) return false;
+  #endif // CONFIG_MQTT_PINGER_DELTA
+  char payload[48];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(payload, sizeof(payload), format, args);
+  va_end(args);
+  return mqttPublish(_mqttTopicTable + _mqttTopicIndex[topic], payload, 
+    CONFIG_MQTT_PINGER_QOS, CONFIG_MQTT_PINGER_RETAINED, false, false);
+}
 
+#if CONFIG_MQTT_PINGER_DELTA
+  #define PINGER_DELTA_HASH(text) pingerDeltaHash(text)
+#else
+  #define PINGER_DELTA_HASH(text) 0
+#endif // CONFIG_MQTT_PINGER_DELTA
+
+static void pingerMqttPublishHostPlain(uint8_t host, ping_host_data_t* data, pinger_host_stats_t* stats)
+{
+  uint16_t topic = PT_INET_MAX + host * PT_HOST_MAX;
+
+  // A host without a result in this round: the values of the last check remain in the topics
+  pingerMqttPublishField(topic + PT_HOST_SKIPPED, PD_EXACT, stats->skipped, false, "%d", stats->skipped);
+  if (stats->skipped) {
+    pingerMqttPublishField(topic + PT_HOST_HOSTNAME, PD_EXACT, PINGER_DELTA_HASH(data->host_name), false, "%s", data->host_name);
+    return;
+  };
+
+  // When the state changes, all values of the host are published
+  bool force = pingerMqttPublishField(topic + PT_HOST_STATE, PD_EXACT, data->state, false, "%d", data->state);
+  pingerMqttPublishField(topic + PT_HOST_HOSTNAME, PD_EXACT, PINGER_DELTA_HASH(data->host_name), force, "%s", data->host_name);
+  pingerMqttPublishField(topic + PT_HOST_TRANSMITTED, PD_EXACT, data->transmitted, force, "%d", data->transmitted);
+  pingerMqttPublishField(topic + PT_HOST_RECEIVED, PD_EXACT, data->received, force, "%d", data->received);
+  pingerMqttPublishField(topic + PT_HOST_TTL, PD_EXACT, data->ttl, force, "%d", data->ttl);
+
+  pingerMqttPublishField(topic + PT_HOST_DURATION, PD_DURATION, data->duration_ms, force, CONFIG_FORMAT_PING_TIMERESP_VALUE, data->duration_ms);
   #if CONFIG_SENSOR_STRING_ENABLE
-    mqttPublish(mqttGetSubTopic(_mqttTopicPing, "internet/loss/max/" CONFIG_SENSOR_NUMERIC_VALUE), 
-      malloc_stringf(CONFIG_FORMAT_PING_LOSS_VALUE, data->loss_max), 
-      CONFIG_MQTT_PINGER_QOS, CONFIG_MQTT_PINGER_RETAINED, true, true);
-    mqttPublish(mqttGetSubTopic(_mqttTopicPing, "internet/loss/max/" CONFIG_SENSOR_STRING_VALUE), 
-      malloc_stringf(CONFIG_FORMAT_PING_LOSS_STRING, data->loss_max), 
-      CONFIG_MQTT_PINGER_QOS, CONFIG_MQTT_PINGER_RETAINED, true, true);
-  #else
-    mqttPublish(mqttGetSubTopic(_mqttTopicPing, "internet/loss/max"), 
-      malloc_stringf(CONFIG_FORMAT_PING_LOSS_VALUE, data->loss_max), 
-      CONFIG_MQTT_PINGER_QOS, CONFIG_MQTT_PINGER_RETAINED, true, true);
+    pingerMqttPublishField(topic + PT_HOST_DURATION_STRING, PD_DURATION, data->duration_ms, force, CONFIG_FORMAT_PING_TIMERESP_STRING, data->duration_ms);
+  #endif // CONFIG_SENSOR_STRING_ENABLE
+  pingerMqttPublishField(topic + PT_HOST_LOSS, PD_LOSS, data->loss, force, CONFIG_FORMAT_PING_LOSS_VALUE, data->loss);
+  #if CONFIG_SENSOR_STRING_ENABLE
+    pingerMqttPublishField(topic + PT_HOST_LOSS_STRING, PD_LOSS, data->loss, force, CONFIG_FORMAT_PING_LOSS_STRING, data->loss);
   #endif // CONFIG_SENSOR_STRING_ENABLE
 
+  pingerMqttPublishField(topic + PT_HOST_RTT_P50, PD_RTT, stats->rtt_p50_us / 1000.0, force, CONFIG_FORMAT_PING_RTT_VALUE, stats->rtt_p50_us / 1000.0);
+  pingerMqttPublishField(topic + PT_HOST_RTT_P95, PD_RTT, stats->rtt_p95_us / 1000.0, force, CONFIG_FORMAT_PING_RTT_VALUE, stats->rtt_p95_us / 1000.0);
+  pingerMqttPublishField(topic + PT_HOST_RTT_P99, PD_RTT, stats->rtt_p99_us / 1000.0, force, CONFIG_FORMAT_PING_RTT_VALUE, stats->rtt_p99_us / 1000.0);
+  pingerMqttPublishField(topic + PT_HOST_RTT_MDEV, PD_RTT, stats->rtt_mdev_us / 1000.0, force, CONFIG_FORMAT_PING_RTT_VALUE, stats->rtt_mdev_us / 1000.0);
+  pingerMqttPublishField(topic + PT_HOST_RTT_JITTER, PD_RTT, stats->jitter_us / 1000.0, force, CONFIG_FORMAT_PING_RTT_VALUE, stats->jitter_us / 1000.0);
+
+  pingerMqttPublishField(topic + PT_HOST_REPLIES_LATE, PD_EXACT, stats->replies_late, force, "%u", stats->replies_late);
+  pingerMqttPublishField(topic + PT_HOST_REPLIES_LATE_RTT, PD_RTT, stats->late_rtt_us / 1000.0, force, CONFIG_FORMAT_PING_RTT_VALUE, stats->late_rtt_us / 1000.0);
+  pingerMqttPublishField(topic + PT_HOST_REPLIES_DUPLICATE, PD_EXACT, stats->replies_duplicate, force, "%u", stats->replies_duplicate);
+  pingerMqttPublishField(topic + PT_HOST_REPLIES_REORDERED, PD_EXACT, stats->replies_reordered, force, "%u", stats->replies_reordered);
+
+  char buffer[CONFIG_FORMAT_STRFTIME_DTS_BUFFER_SIZE];
+  time2str(CONFIG_FORMAT_DTS, &(data->time_unavailable), buffer, sizeof(buffer));
+  pingerMqttPublishField(topic + PT_HOST_UNAVAILABLE_UNIX, PD_EXACT, data->time_unavailable, force, "%d", (int)data->time_unavailable);
+  pingerMqttPublishField(topic + PT_HOST_UNAVAILABLE_STRING, PD_EXACT, data->time_unavailable, force, "%s", buffer);
+}
+
+static void pingerMqttPublishInetPlain(ping_inet_data_t* data, pinger_inet_stats_t* stats)
+{
+  bool force = pingerMqttPublishField(PT_INET_STATE, PD_EXACT, data->state, false, "%d", data->state);
+  pingerMqttPublishField(PT_INET_HOSTS_COUNT, PD_EXACT, data->hosts_count, force, "%d", data->hosts_count);
+  pingerMqttPublishField(PT_INET_HOSTS_CHECKED, PD_EXACT, stats->hosts_checked, force, "%d", stats->hosts_checked);
+
+  bool total = pingerMqttPublishField(PT_INET_DURATION_TOTAL, PD_DURATION, data->duration_ms_total, force, CONFIG_FORMAT_PING_TIMERESP_VALUE, data->duration_ms_total);
+  pingerMqttPublishField(PT_INET_DURATION_MIN, PD_DURATION, data->duration_ms_min, force, CONFIG_FORMAT_PING_TIMERESP_VALUE, data->duration_ms_min);
+  pingerMqttPublishField(PT_INET_DURATION_MAX, PD_DURATION, data->duration_ms_max, force, CONFIG_FORMAT_PING_TIMERESP_VALUE, data->duration_ms_max);
+  total |= pingerMqttPublishField(PT_INET_LOSS_TOTAL, PD_LOSS, data->loss_total, force, CONFIG_FORMAT_PING_LOSS_VALUE, data->loss_total);
+  pingerMqttPublishField(PT_INET_LOSS_MIN, PD_LOSS, data->loss_min, force, CONFIG_FORMAT_PING_LOSS_VALUE, data->loss_min);
+  pingerMqttPublishField(PT_INET_LOSS_MAX, PD_LOSS, data->loss_max, force, CONFIG_FORMAT_PING_LOSS_VALUE, data->loss_max);
   #if CONFIG_SENSOR_STRING_ENABLE
-    mqttPublish(mqttGetSubTopic(_mqttTopicPing, "internet/loss/total/" CONFIG_SENSOR_NUMERIC_VALUE), 
-      malloc_stringf(CONFIG_FORMAT_PING_LOSS_VALUE, data->loss_total), 
-      CONFIG_MQTT_PINGER_QOS, CONFIG_MQTT_PINGER_RETAINED, true, true);
-    mqttPublish(mqttGetSubTopic(_mqttTopicPing, "internet/loss/total/" CONFIG_SENSOR_STRING_VALUE), 
-      malloc_stringf(CONFIG_FORMAT_PING_LOSS_STRING, data->loss_total), 
-      CONFIG_MQTT_PINGER_QOS, CONFIG_MQTT_PINGER_RETAINED, true, true);
-  #else
-    mqttPublish(mqttGetSubTopic(_mqttTopicPing, "internet/loss/total"), 
-      malloc_stringf(CONFIG_FORMAT_PING_LOSS_VALUE, data->loss_total), 
-      CONFIG_MQTT_PINGER_QOS, CONFIG_MQTT_PINGER_RETAINED, true, true);
+    pingerMqttPublishField(PT_INET_DURATION_TOTAL_STRING, PD_DURATION, data->duration_ms_total, force, CONFIG_FORMAT_PING_TIMERESP_STRING, data->duration_ms_total);
+    pingerMqttPublishField(PT_INET_DURATION_MIN_STRING, PD_DURATION, data->duration_ms_min, force, CONFIG_FORMAT_PING_TIMERESP_STRING, data->duration_ms_min);
+    pingerMqttPublishField(PT_INET_DURATION_MAX_STRING, PD_DURATION, data->duration_ms_max, force, CONFIG_FORMAT_PING_TIMERESP_STRING, data->duration_ms_max);
+    pingerMqttPublishField(PT_INET_LOSS_TOTAL_STRING, PD_LOSS, data->loss_total, force, CONFIG_FORMAT_PING_LOSS_STRING, data->loss_total);
+    pingerMqttPublishField(PT_INET_LOSS_MIN_STRING, PD_LOSS, data->loss_min, force, CONFIG_FORMAT_PING_LOSS_STRING, data->loss_min);
+    pingerMqttPublishField(PT_INET_LOSS_MAX_STRING, PD_LOSS, data->loss_max, force, CONFIG_FORMAT_PING_LOSS_STRING, data->loss_max);
   #endif // CONFIG_SENSOR_STRING_ENABLE
 
-` char buffer[CONFIG_BUFFER_LEN_INT64_RADIX10];
+  pingerMqttPublishField(PT_INET_RTT_MDEV, PD_RTT, stats->rtt_mdev_us / 1000.0, force, CONFIG_FORMAT_PING_RTT_VALUE, stats->rtt_mdev_us / 1000.0);
+  pingerMqttPublishField(PT_INET_RTT_JITTER, PD_RTT, stats->jitter_us / 1000.0, force, CONFIG_FORMAT_PING_RTT_VALUE, stats->jitter_us / 1000.0);
+
+  char buffer[CONFIG_BUFFER_LEN_INT64_RADIX10 > CONFIG_FORMAT_STRFTIME_DTS_BUFFER_SIZE ? CONFIG_BUFFER_LEN_INT64_RADIX10 : CONFIG_FORMAT_STRFTIME_DTS_BUFFER_SIZE];
   _ui64toa(data->time_unavailable, buffer, 10);
-  mqttPublish(mqttGetSubTopic(_mqttTopicPing, "internet/unavailable/time/unix"), 
-    malloc_string(buffer), 
-    CONFIG_MQTT_PINGER_QOS, CONFIG_MQTT_PINGER_RETAINED, true, true);
+  pingerMqttPublishField(PT_INET_UNAVAILABLE_UNIX, PD_EXACT, data->time_unavailable, force, "%s", buffer);
   time2str(CONFIG_FORMAT_DTS, &(data->time_unavailable), buffer, sizeof(buffer));
-  mqttPublish(mqttGetSubTopic(_mqttTopicPing, "internet/unavailable/time/string"), 
-    malloc_string(buffer), 
-    CONFIG_MQTT_PINGER_QOS, CONFIG_MQTT_PINGER_RETAINED, true, true);
-
-  mqttPublish(mqttGetSubTopic(_mqttTopicPing, "internet/unavailable/count"), 
-    malloc_stringf("%d", data->count_unavailable), 
-    CONFIG_MQTT_PINGER_QOS, CONFIG_MQTT_PINGER_RETAINED, true, true);
+  pingerMqttPublishField(PT_INET_UNAVAILABLE_STRING, PD_EXACT, data->time_unavailable, force, "%s", buffer);
+  pingerMqttPublishField(PT_INET_UNAVAILABLE_COUNT, PD_EXACT, data->count_unavailable, force, "%d", data->count_unavailable);
 
+  // The summary is updated together with the total values
   #ifdef CONFIG_FORMAT_PING_MIXED
+    const char* display;
     switch (data->state) {
-      case PING_AVAILABLE:
-        mqttPublish(mqttGetSubTopic(_mqttTopicPing, "internet/" CONFIG_SENSOR_DISPLAY), 
-          malloc_stringf(CONFIG_FORMAT_PING_MIXED, CONFIG_FORMAT_PING_OK, data->duration_ms_total, data->loss_total), 
-          CONFIG_MQTT_PINGER_QOS, CONFIG_MQTT_PINGER_RETAINED, true, true);
+      case PING_OK:
+        display = CONFIG_FORMAT_PING_OK;
         break;
-      case PING_DELAYED:
-        mqttPublish(mqttGetSubTopic(_mqttTopicPing, "internet/" CONFIG_SENSOR_DISPLAY), 
-          malloc_stringf(CONFIG_FORMAT_PING_MIXED, CONFIG_FORMAT_PING_DELAYED, data->duration_ms_total, data->loss_total), 
-          CONFIG_MQTT_PINGER_QOS, CONFIG_MQTT_PINGER_RETAINED, true, true);
+      case PING_SLOWDOWN:
+        display = CONFIG_FORMAT_PING_SLOWDOWN;
         break;
       default:
-        mqttPublish(mqttGetSubTopic(_mqttTopicPing, "internet/" CONFIG_SENSOR_DISPLAY), 
-          malloc_stringf(CONFIG_FORMAT_PING_MIXED, CONFIG_FORMAT_PING_UNAVAILABLED, data->duration_ms_total, data->loss_total), 
-          CONFIG_MQTT_PINGER_QOS, CONFIG_MQTT_PINGER_RETAINED, true, true);
+        display = CONFIG_FORMAT_PING_UNAVAILABLED;
         break;
-    }
+    };
+    pingerMqttPublishField(PT_INET_DISPLAY, PD_EXACT, 0, force || total, CONFIG_FORMAT_PING_MIXED, 
+      display, data->duration_ms_total, data->loss_total);
+  #else
+    (void)total;
   #endif // CONFIG_FORMAT_PING_MIXED
 }
 #endif // CONFIG_MQTT_PINGER_AS_PLAIN
 
 #if CONFIG_MQTT_PINGER_AS_JSON
 
-char* pingerMqttPublishHostJson(ping_host_data_t* data)
+static void pingerMqttWriteHostJson(pinger_writer_t* json, ping_host_data_t* data, pinger_host_stats_t* stats)
 {
-  char* json_host = nullptr;
+  if (stats->skipped) {
+    pingerWriterPrintf(json, "{\"hostname\":\"%s\",\"skipped\":true}", data->host_name);
+    return;
+  };
 
-  char* json_packets = malloc_stringf("\"packets\":{\"transmitted\":%d,\"received\":%d,\"ttl\":%d}", 
-    data->transmitted, data->received, data->ttl);
+  pingerWriterPrintf(json, "{\"hostname\":\"%s\",\"state\":%d,\"packets\":{\"transmitted\":%d,\"received\":%d,\"ttl\":%d}", 
+    data->host_name, data->state, data->transmitted, data->received, data->ttl);
 
   #if CONFIG_SENSOR_STRING_ENABLE
-    char* json_duration = malloc_stringf("\"duration\":{\"" CONFIG_SENSOR_NUMERIC_VALUE "\":" CONFIG_FORMAT_PING_TIMERESP_VALUE ",\"" CONFIG_SENSOR_STRING_VALUE "\":\"" CONFIG_FORMAT_PING_TIMERESP_STRING "\"}", 
+    pingerWriterPrintf(json, ",\"duration\":{\"" CONFIG_SENSOR_NUMERIC_VALUE "\":" CONFIG_FORMAT_PING_TIMERESP_VALUE ",\"" CONFIG_SENSOR_STRING_VALUE "\":\"" CONFIG_FORMAT_PING_TIMERESP_STRING "\"}", 
       data->duration_ms, data->duration_ms);
-    char* json_loss = malloc_stringf("\"loss\":{\"" CONFIG_SENSOR_NUMERIC_VALUE "\":" CONFIG_FORMAT_PING_LOSS_VALUE ",\"" CONFIG_SENSOR_STRING_VALUE "\":\"" CONFIG_FORMAT_PING_LOSS_STRING "\"}", 
+    pingerWriterPrintf(json, ",\"loss\":{\"" CONFIG_SENSOR_NUMERIC_VALUE "\":" CONFIG_FORMAT_PING_LOSS_VALUE ",\"" CONFIG_SENSOR_STRING_VALUE "\":\"" CONFIG_FORMAT_PING_LOSS_STRING "\"}", 
       data->loss, data->loss);
   #else
-    char* json_duration = malloc_stringf("\"duration\":" CONFIG_FORMAT_PING_TIMERESP_VALUE, 
+    pingerWriterPrintf(json, ",\"duration\":" CONFIG_FORMAT_PING_TIMERESP_VALUE, 
       data->duration_ms);
-    char* json_loss = malloc_stringf("\"loss\":" CONFIG_FORMAT_PING_LOSS_VALUE, 
+    pingerWriterPrintf(json, ",\"loss\":" CONFIG_FORMAT_PING_LOSS_VALUE, 
       data->loss);
   #endif // CONFIG_SENSOR_STRING_ENABLE
 
-  char* json_unavailable = nullptr;
+  pingerWriterPrintf(json, ",\"rtt\":{\"p50\":" CONFIG_FORMAT_PING_RTT_VALUE ",\"p95\":" CONFIG_FORMAT_PING_RTT_VALUE ",\"p99\":" CONFIG_FORMAT_PING_RTT_VALUE 
+      ",\"mdev\":" CONFIG_FORMAT_PING_RTT_VALUE ",\"jitter\":" CONFIG_FORMAT_PING_RTT_VALUE "}", 
+    stats->rtt_p50_us / 1000.0, stats->rtt_p95_us / 1000.0, stats->rtt_p99_us / 1000.0, 
+    stats->rtt_mdev_us / 1000.0, stats->jitter_us / 1000.0);
+  pingerWriterPrintf(json, ",\"replies\":{\"late\":%u,\"late_rtt\":" CONFIG_FORMAT_PING_RTT_VALUE ",\"duplicate\":%u,\"reordered\":%u}", 
+    stats->replies_late, stats->late_rtt_us / 1000.0, stats->replies_duplicate, stats->replies_reordered);
+
   if (data->state >= PING_UNAVAILABLE) {
     char t_unavailable[CONFIG_BUFFER_LEN_INT64_RADIX10];
     char s_unavailable[CONFIG_FORMAT_STRFTIME_DTS_BUFFER_SIZE];
     _ui64toa(data->time_unavailable, t_unavailable, 10);
-    time2str(CONFIG_FORMAT_DTS, &(data->time_unavailable), s_unavailable, sizeof(CONFIG_FORMAT_STRFTIME_BUFFER_SIZE));
-    json_unavailable = malloc_stringf("\"unavailable\":{\"time\":{\"unix\":%s,\"string\":\"%s\"}}", 
+    time2str(CONFIG_FORMAT_DTS, &(data->time_unavailable), s_unavailable, sizeof(s_unavailable));
+    pingerWriterPrintf(json, ",\"unavailable\":{\"time\":{\"unix\":%s,\"string\":\"%s\"}}", 
       t_unavailable, s_unavailable);
   };
-  
-  if ((json_packets) && (json_duration) && (json_loss)) {
-    if (json_unavailable) {
-      json_host = malloc_stringf("{\"hostname\":\"%s\",\"state\":%d,%s,%s,%s,%s}",
-        data->host_name, data->state, json_packets, json_duration, json_loss, json_unavailable);
-    } else {
-      json_host = malloc_stringf("{\"hostname\":\"%s\",\"state\":%d,%s,%s,%s}",
-        data->host_name, data->state, json_packets, json_duration, json_loss);
-    };
-  };
-  
-  if (json_packets) free(json_packets);
-  if (json_duration) free(json_duration);
-  if (json_loss) free(json_loss);
-  if (json_unavailable) free(json_unavailable);
-  
-  return json_host;
+
+  pingerWriterPuts(json, "}");
 }
 
-char* pingerMqttPublishInetJson(ping_inet_data_t* data)
+static void pingerMqttWriteInetJson(pinger_writer_t* json, ping_inet_data_t* data, pinger_inet_stats_t* stats)
 {
-  char* json_inet = nullptr;
+  pingerWriterPrintf(json, "{\"state\":%d,\"hosts\":{\"count\":%d,\"checked\":%d}", 
+    data->state, data->hosts_count, stats->hosts_checked);
 
   // Durations
-  char* json_duration = nullptr;
   #if CONFIG_SENSOR_STRING_ENABLE
-    char* json_duration_min = malloc_stringf("\"min\":{\"" CONFIG_SENSOR_NUMERIC_VALUE "\":" CONFIG_FORMAT_PING_TIMERESP_VALUE ",\"" CONFIG_SENSOR_STRING_VALUE "\":\"" CONFIG_FORMAT_PING_TIMERESP_STRING "\"}", 
-      data->duration_ms_min, data->duration_ms_min);
-    char* json_duration_max = malloc_stringf("\"max\":{\"" CONFIG_SENSOR_NUMERIC_VALUE "\":" CONFIG_FORMAT_PING_TIMERESP_VALUE ",\"" CONFIG_SENSOR_STRING_VALUE "\":\"" CONFIG_FORMAT_PING_TIMERESP_STRING "\"}", 
-      data->duration_ms_max, data->duration_ms_max);
-    char* json_duration_total = malloc_stringf("\"total\":{\"" CONFIG_SENSOR_NUMERIC_VALUE "\":" CONFIG_FORMAT_PING_TIMERESP_VALUE ",\"" CONFIG_SENSOR_STRING_VALUE "\":\"" CONFIG_FORMAT_PING_TIMERESP_STRING "\"}", 
+    pingerWriterPrintf(json, ",\"duration\":{"
+      "\"min\":{\"" CONFIG_SENSOR_NUMERIC_VALUE "\":" CONFIG_FORMAT_PING_TIMERESP_VALUE ",\"" CONFIG_SENSOR_STRING_VALUE "\":\"" CONFIG_FORMAT_PING_TIMERESP_STRING "\"},"
+      "\"max\":{\"" CONFIG_SENSOR_NUMERIC_VALUE "\":" CONFIG_FORMAT_PING_TIMERESP_VALUE ",\"" CONFIG_SENSOR_STRING_VALUE "\":\"" CONFIG_FORMAT_PING_TIMERESP_STRING "\"},"
+      "\"total\":{\"" CONFIG_SENSOR_NUMERIC_VALUE "\":" CONFIG_FORMAT_PING_TIMERESP_VALUE ",\"" CONFIG_SENSOR_STRING_VALUE "\":\"" CONFIG_FORMAT_PING_TIMERESP_STRING "\"}}", 
+      data->duration_ms_min, data->duration_ms_min, 
+      data->duration_ms_max, data->duration_ms_max, 
       data->duration_ms_total, data->duration_ms_total);
   #else
-    char* json_duration_min = malloc_stringf("\"min\":" CONFIG_FORMAT_PING_TIMERESP_VALUE, 
-      data->duration_ms_min);
-    char* json_duration_max = malloc_stringf("\"max\":" CONFIG_FORMAT_PING_TIMERESP_VALUE, 
-      data->duration_ms_max);
-    char* json_duration_total = malloc_stringf("\"total\":" CONFIG_FORMAT_PING_TIMERESP_VALUE, 
-      data->duration_ms_total);
+    pingerWriterPrintf(json, ",\"duration\":{"
+      "\"min\":" CONFIG_FORMAT_PING_TIMERESP_VALUE ","
+      "\"max\":" CONFIG_FORMAT_PING_TIMERESP_VALUE ","
+      "\"total\":" CONFIG_FORMAT_PING_TIMERESP_VALUE "}", 
+      data->duration_ms_min, data->duration_ms_max, data->duration_ms_total);
   #endif // CONFIG_SENSOR_STRING_ENABLE
 
-  if ((json_duration_min) && (json_duration_max) && (json_duration_total)) {
-    json_duration = malloc_stringf("\"duration\":{%s,%s,%s}", 
-      json_duration_min, json_duration_max, json_duration_total);
-  };
-  if (json_duration_min) free(json_duration_min);
-  if (json_duration_max) free(json_duration_max);
-  if (json_duration_total) free(json_duration_total);
-
   // Losses
-  char* json_loss = nullptr;
   #if CONFIG_SENSOR_STRING_ENABLE
-    char* json_loss_min = malloc_stringf("\"min\":{\"" CONFIG_SENSOR_NUMERIC_VALUE "\":" CONFIG_FORMAT_PING_LOSS_VALUE ",\"" CONFIG_SENSOR_STRING_VALUE "\":\"" CONFIG_FORMAT_PING_LOSS_STRING "\"}", 
-      data->loss_min, data->loss_min);
-    char* json_loss_max = malloc_stringf("\"max\":{\"" CONFIG_SENSOR_NUMERIC_VALUE "\":" CONFIG_FORMAT_PING_LOSS_VALUE ",\"" CONFIG_SENSOR_STRING_VALUE "\":\"" CONFIG_FORMAT_PING_LOSS_STRING "\"}", 
-      data->loss_max, data->loss_max);
-    char* json_loss_total = malloc_stringf("\"total\":{\"" CONFIG_SENSOR_NUMERIC_VALUE "\":" CONFIG_FORMAT_PING_LOSS_VALUE ",\"" CONFIG_SENSOR_STRING_VALUE "\":\"" CONFIG_FORMAT_PING_LOSS_STRING "\"}", 
+    pingerWriterPrintf(json, ",\"loss\":{"
+      "\"min\":{\"" CONFIG_SENSOR_NUMERIC_VALUE "\":" CONFIG_FORMAT_PING_LOSS_VALUE ",\"" CONFIG_SENSOR_STRING_VALUE "\":\"" CONFIG_FORMAT_PING_LOSS_STRING "\"},"
+      "\"max\":{\"" CONFIG_SENSOR_NUMERIC_VALUE "\":" CONFIG_FORMAT_PING_LOSS_VALUE ",\"" CONFIG_SENSOR_STRING_VALUE "\":\"" CONFIG_FORMAT_PING_LOSS_STRING "\"},"
+      "\"total\":{\"" CONFIG_SENSOR_NUMERIC_VALUE "\":" CONFIG_FORMAT_PING_LOSS_VALUE ",\"" CONFIG_SENSOR_STRING_VALUE "\":\"" CONFIG_FORMAT_PING_LOSS_STRING "\"}}", 
+      data->loss_min, data->loss_min, 
+      data->loss_max, data->loss_max, 
       data->loss_total, data->loss_total);
   #else
-    char* json_loss_min = malloc_stringf("\"min\":" CONFIG_FORMAT_PING_LOSS_VALUE, 
-      data->loss_min);
-    char* json_loss_max = malloc_stringf("\"max\":" CONFIG_FORMAT_PING_LOSS_VALUE, 
-      data->loss_max);
-    char* json_loss_total = malloc_stringf("\"total\":" CONFIG_FORMAT_PING_LOSS_VALUE, 
-      data->loss_total);
+    pingerWriterPrintf(json, ",\"loss\":{"
+      "\"min\":" CONFIG_FORMAT_PING_LOSS_VALUE ","
+      "\"max\":" CONFIG_FORMAT_PING_LOSS_VALUE ","
+      "\"total\":" CONFIG_FORMAT_PING_LOSS_VALUE "}", 
+      data->loss_min, data->loss_max, data->loss_total);
   #endif // CONFIG_SENSOR_STRING_ENABLE
-  if ((json_loss_min) && (json_loss_max) && (json_loss_total)) {
-    json_loss = malloc_stringf("\"loss\":{%s,%s,%s}", 
-      json_loss_min, json_loss_max, json_loss_total);
-  };
-  if (json_loss_min) free(json_loss_min);
-  if (json_loss_max) free(json_loss_max);
-  if (json_loss_total) free(json_loss_total);
+
+  // Response time variation
+  pingerWriterPrintf(json, ",\"rtt\":{\"mdev\":" CONFIG_FORMAT_PING_RTT_VALUE ",\"jitter\":" CONFIG_FORMAT_PING_RTT_VALUE "}", 
+    stats->rtt_mdev_us / 1000.0, stats->jitter_us / 1000.0);
 
   // Timestamps and summary
-  char* json_unavailable = nullptr;
   if (data->state >= PING_UNAVAILABLE) {
     char t_unavailable[CONFIG_BUFFER_LEN_INT64_RADIX10];
     char s_unavailable[CONFIG_FORMAT_STRFTIME_DTS_BUFFER_SIZE];
     _ui64toa(data->time_unavailable, t_unavailable, 10);
-    time2str(CONFIG_FORMAT_DTS, &(data->time_unavailable), s_unavailable, sizeof(CONFIG_FORMAT_STRFTIME_BUFFER_SIZE));
-    json_unavailable = malloc_stringf("\"unavailable\":{\"time\":{\"unix\":%s,\"string\":\"%s\"},\"count\":%d}", 
+    time2str(CONFIG_FORMAT_DTS, &(data->time_unavailable), s_unavailable, sizeof(s_unavailable));
+    pingerWriterPrintf(json, ",\"unavailable\":{\"time\":{\"unix\":%s,\"string\":\"%s\"},\"count\":%d}", 
       t_unavailable, s_unavailable, data->count_unavailable);
   };
 
   #ifdef CONFIG_FORMAT_PING_MIXED
+    const char* display;
     switch (data->state) {
       case PING_OK:
-        if ((json_duration) && (json_loss)) {
-          json_inet = malloc_stringf("{\"state\":%d,%s,%s,\"%s\":\"" CONFIG_FORMAT_PING_MIXED "\"}",
-            data->state, json_duration, json_loss, CONFIG_SENSOR_DISPLAY, CONFIG_FORMAT_PING_OK, data->duration_ms_total, data->loss_total);
-        };
+        display = CONFIG_FORMAT_PING_OK;
         break;
       case PING_SLOWDOWN:
-        if ((json_duration) && (json_loss)) {
-          json_inet = malloc_stringf("{\"state\":%d,%s,%s,\"%s\":\"" CONFIG_FORMAT_PING_MIXED "\"}",
-            data->state, json_duration, json_loss, CONFIG_SENSOR_DISPLAY, CONFIG_FORMAT_PING_SLOWDOWN, data->duration_ms_total, data->loss_total);
-        };
+        display = CONFIG_FORMAT_PING_SLOWDOWN;
         break;
       default:
-        if ((json_duration) && (json_loss) && (json_unavailable)) {
-          json_inet = malloc_stringf("{\"state\":%d,%s,%s,%s,\"%s\":\"" CONFIG_FORMAT_PING_MIXED "\"}",
-            data->state, json_duration, json_loss, json_unavailable, CONFIG_SENSOR_DISPLAY, CONFIG_FORMAT_PING_UNAVAILABLED, data->duration_ms_total, data->loss_total);
-        };
+        display = CONFIG_FORMAT_PING_UNAVAILABLED;
         break;
-    }
-  #else
-    if ((json_duration) && (json_loss)) {
-      if (json_unavailable) {
-        json_inet = malloc_stringf("{\"state\":%d,%s,%s,%s}",
-          data->state, json_duration, json_loss, json_unavailable);
-      } else {
-        json_inet = malloc_stringf("{\"state\":%d,%s,%s}",
-          data->state, json_duration, json_loss);
-      };
     };
+    pingerWriterPrintf(json, ",\"%s\":\"" CONFIG_FORMAT_PING_MIXED "\"", 
+      CONFIG_SENSOR_DISPLAY, display, data->duration_ms_total, data->loss_total);
   #endif // CONFIG_FORMAT_PING_MIXED
 
-  if (json_duration) free(json_duration);
-  if (json_loss) free(json_loss);
-  if (json_unavailable) free(json_unavailable);
+  pingerWriterPuts(json, "}");
+}
 
-  return json_inet;
+// Subtrees of the document: 0 - internet, 1.. - hosts. If "parts" is not specified, the full document is written
+static void pingerMqttWriteJson(pinger_writer_t* json, pinger_publish_data_t* data, const bool* parts)
+{
+  bool first = true;
+  pingerWriterPuts(json, "{");
+  if (!parts || parts[0]) {
+    pingerWriterPuts(json, "\"internet\":");
+    pingerMqttWriteInetJson(json, &data->inet, &data->inet_stats);
+    first = false;
+  };
+  for (uint8_t i = 0; i < data->hosts_count; i++) {
+    if (!parts || parts[i + 1]) {
+      pingerWriterPrintf(json, first ? "\"host%d\":" : ",\"host%d\":", i + 1);
+      pingerMqttWriteHostJson(json, &data->hosts[i], &data->hosts_stats[i]);
+      first = false;
+    };
+  };
+  pingerWriterPuts(json, "}");
+}
+
+
+// The document is built in the buffer allocated with the topic, it is not enlarged on the publish path
+static char* pingerMqttBuildJson(pinger_publish_data_t* data, const bool* parts)
+{
+  if (!_mqttJsonBuffer) return nullptr;
+  pinger_writer_t json;
+  pingerWriterInit(&json, _mqttJsonBuffer, CONFIG_MQTT_PINGER_JSON_SIZE_MAX);
+  pingerMqttWriteJson(&json, data, parts);
+  if (!pingerWriterOk(&json)) {
+    rlog_e(logTAG, "JSON document requires %d bytes, the buffer has %d bytes, the document is not published", 
+      (int)pingerWriterRequired(&json), (int)CONFIG_MQTT_PINGER_JSON_SIZE_MAX);
+    return nullptr;
+  };
+  return _mqttJsonBuffer;
 }
 
 #endif // CONFIG_MQTT_PINGER_AS_JSON
 
-void pingerMqttPublish(ping_publish_data_t* data)
+#if (CONFIG_MQTT_PINGER_AS_JSON || CONFIG_MQTT_PINGER_AS_CBOR) && CONFIG_MQTT_PINGER_DELTA
+
+// All published values of the subtrees, the state is always the first one
+#define PD_FIELDS_INET 13
+#define PD_FIELDS_HOST 17
+#define PD_FIELDS (PD_FIELDS_HOST > PD_FIELDS_INET ? PD_FIELDS_HOST : PD_FIELDS_INET)
+
+static pinger_delta_t _mqttDocDelta[CONFIG_PINGER_HOSTS_MAX + 1][PD_FIELDS];
+static TickType_t _mqttDocFull = 0;
+static uint8_t _mqttDocHosts = 0;
+
+static void pingerMqttDocDeltaReset()
+{
+  memset(_mqttDocDelta, 0, sizeof(_mqttDocDelta));
+  _mqttDocFull = 0;
+}
+
+// The subtree is published entirely if at least one of its values has changed
+static bool pingerMqttDocDelta(pinger_delta_t* delta, const double* values, const pinger_delta_kind_t* kinds, uint8_t count, bool force)
+{
+  for (uint8_t i = 0; (i < count) && !force; i++) {
+    force = pingerDeltaExceeded(&delta[i], values[i], kinds[i]);
+  };
+  if (force) {
+    for (uint8_t i = 0; i < count; i++) {
+      pingerDeltaStore(&delta[i], values[i]);
+    };
+  };
+  return force;
+}
+
+// Selects the changed subtrees. The full document is sent after reconnection, at heartbeat intervals and when the state 
+// of the internet or of a host changes: only it is retained, partial documents are not
+static bool pingerMqttDocChanged(pinger_publish_data_t* data, bool* parts, bool* full_doc)
+{
+  static const pinger_delta_kind_t kinds_inet[PD_FIELDS_INET] = { PD_EXACT, PD_EXACT, PD_EXACT, 
+    PD_DURATION, PD_DURATION, PD_DURATION, PD_LOSS, PD_LOSS, PD_LOSS, PD_RTT, PD_RTT, PD_EXACT, PD_EXACT };
+  static const pinger_delta_kind_t kinds_host[PD_FIELDS_HOST] = { PD_EXACT, PD_EXACT, PD_EXACT, PD_EXACT, PD_EXACT, 
+    PD_DURATION, PD_LOSS, PD_RTT, PD_RTT, PD_RTT, PD_RTT, PD_RTT, PD_EXACT, PD_RTT, PD_EXACT, PD_EXACT, PD_EXACT };
+  TickType_t now = xTaskGetTickCount();
+  bool full = (_mqttDocFull == 0) || (_mqttDocHosts != data->hosts_count)
+    || ((now - _mqttDocFull) >= pdMS_TO_TICKS(CONFIG_MQTT_PINGER_HEARTBEAT * 1000))
+    || (_mqttDocDelta[0][0].value != (double)data->inet.state);
+  for (uint8_t i = 0; (i < data->hosts_count) && !full; i++) {
+    full = !data->hosts_stats[i].skipped && (_mqttDocDelta[i + 1][0].value != (double)data->hosts[i].state);
+  };
+  *full_doc = full;
+  if (full) {
+    _mqttDocFull = now ? now : 1;
+    _mqttDocHosts = data->hosts_count;
+  };
+  
+  bool changed = false;
+  ping_inet_data_t* inet = &data->inet;
+  double inet_values[PD_FIELDS_INET] = { (double)inet->state, (double)inet->hosts_count, (double)data->inet_stats.hosts_checked, 
+    (double)inet->duration_ms_min, (double)inet->duration_ms_max, (double)inet->duration_ms_total, 
+    inet->loss_min, inet->loss_max, inet->loss_total, 
+    data->inet_stats.rtt_mdev_us / 1000.0, data->inet_stats.jitter_us / 1000.0, 
+    (double)inet->time_unavailable, (double)inet->count_unavailable };
+  parts[0] = pingerMqttDocDelta(_mqttDocDelta[0], inet_values, kinds_inet, PD_FIELDS_INET, full);
+  changed |= parts[0];
+  for (uint8_t i = 0; i < data->hosts_count; i++) {
+    ping_host_data_t* host = &data->hosts[i];
+    pinger_host_stats_t* stats = &data->hosts_stats[i];
+    if (stats->skipped) {
+      // The last published values remain valid, the subtree is sent only in the full document or with a new name
+      double name = pingerDeltaHash(host->host_name);
+      parts[i + 1] = full || !_mqttDocDelta[i + 1][1].valid || (_mqttDocDelta[i + 1][1].value != name);
+      if (parts[i + 1]) pingerDeltaStore(&_mqttDocDelta[i + 1][1], name);
+      changed |= parts[i + 1];
+      continue;
+    };
+    double host_values[PD_FIELDS_HOST] = { (double)host->state, pingerDeltaHash(host->host_name), 
+      (double)host->transmitted, (double)host->received, (double)host->ttl, (double)host->duration_ms, host->loss, 
+      stats->rtt_p50_us / 1000.0, stats->rtt_p95_us / 1000.0, stats->rtt_p99_us / 1000.0, 
+      stats->rtt_mdev_us / 1000.0, stats->jitter_us / 1000.0, 
+      (double)stats->replies_late, stats->late_rtt_us / 1000.0, (double)stats->replies_duplicate, (double)stats->replies_reordered, 
+      (double)host->time_unavailable };
+    parts[i + 1] = pingerMqttDocDelta(_mqttDocDelta[i + 1], host_values, kinds_host, PD_FIELDS_HOST, full);
+    changed |= parts[i + 1];
+  };
+  return changed;
+}
+
+#endif // (CONFIG_MQTT_PINGER_AS_JSON || CONFIG_MQTT_PINGER_AS_CBOR) && CONFIG_MQTT_PINGER_DELTA
+
+#if CONFIG_MQTT_PINGER_BACKLOG
+
+// Maximum length of one record in the message
+#define PINGER_BACKLOG_RECORD_MAX (80 + 20 * CONFIG_PINGER_HOSTS_MAX)
+static char _mqttBacklogBuffer[16 + CONFIG_MQTT_PINGER_BACKLOG_BATCH * PINGER_BACKLOG_RECORD_MAX];
+
+static void pingerMqttWriteRecord(pinger_writer_t* json, const pinger_record_t* record)
+{
+  pingerWriterPrintf(json, "{\"time\":%u,\"state\":%d,\"duration\":%d,\"loss\":%.2f,\"hosts\":[", 
+    (unsigned)record->time, record->state, record->duration_ms, record->loss / 100.0);
+  for (uint8_t i = 0; i < record->hosts_count; i++) {
+    if (i > 0) pingerWriterPuts(json, ",");
+    if (record->hosts[i].state == PINGER_BACKLOG_SKIPPED) {
+      pingerWriterPuts(json, "null");
+    } else {
+      pingerWriterPrintf(json, "[%d,%d,%.2f]", 
+        record->hosts[i].state, record->hosts[i].duration_ms, record->hosts[i].loss / 100.0);
+    };
+  };
+  pingerWriterPuts(json, "]}");
+}
+
+// Results accumulated during the absence of the connection are sent in batches, 
+// a limited number of messages per cycle so as not to delay the checks
+static void pingerMqttPublishBacklog()
+{
+  uint32_t count = pingerBacklogCount();
+  if ((count == 0) || (_mqttTopicBacklog == nullptr)) return;
+  rlog_d(logTAG, "Publishing backlog: %d records", (int)count);
+
+  for (uint8_t m = 0; (m < CONFIG_MQTT_PINGER_BACKLOG_MESSAGES) && (count > 0); m++) {
+    pinger_writer_t json;
+    pinger_record_t record;
+    uint32_t batch = 0;
+    pingerWriterInit(&json, _mqttBacklogBuffer, sizeof(_mqttBacklogBuffer));
+    pingerWriterPuts(&json, "{\"records\":[");
+    while ((batch < CONFIG_MQTT_PINGER_BACKLOG_BATCH) && (batch < count) && pingerBacklogPeek(batch, &record)) {
+      if (batch > 0) pingerWriterPutc(&json, ',');
+      pingerMqttWriteRecord(&json, &record);
+      batch++;
+    };
+    pingerWriterPuts(&json, "]}");
+    if ((batch == 0) || !pingerWriterOk(&json)) {
+      rlog_e(logTAG, "Failed to build backlog message");
+      return;
+    };
+    // Records are removed only after they have been transferred to the MQTT client
+    if (!mqttPublish(_mqttTopicBacklog, _mqttBacklogBuffer, CONFIG_MQTT_PINGER_QOS, false, false, false)) return;
+    pingerBacklogDrop(batch);
+    count -= batch;
+  };
+}
+
+#endif // CONFIG_MQTT_PINGER_BACKLOG
+
+void pingerMqttPublish(pinger_publish_data_t* data)
 {
   if ((_mqttTopicPing) && (data) && esp_heap_free_check() && statesMqttIsEnabled()) {
     #if CONFIG_MQTT_PINGER_AS_PLAIN
-      pingerMqttPublishHostPlain("host1", &data->host1);
-      #ifdef CONFIG_PINGER_HOST_2
-        pingerMqttPublishHostPlain("host2", &data->host2);
-      #endif // CONFIG_PINGER_HOST_2
-      #ifdef CONFIG_PINGER_HOST_3
-        pingerMqttPublishHostPlain("host3", &data->host3);
-      #endif // CONFIG_PINGER_HOST_3
-      pingerMqttPublishInetPlain(&data->inet);
+      if ((_mqttTopicTable == nullptr) || (_mqttTopicHosts != data->hosts_count)) {
+        pingerMqttTopicsCreate(data->hosts_count);
+      };
+      if (_mqttTopicTable) {
+        for (uint8_t i = 0; i < _mqttTopicHosts; i++) {
+          pingerMqttPublishHostPlain(i, &data->hosts[i], &data->hosts_stats[i]);
+        };
+        pingerMqttPublishInetPlain(&data->inet, &data->inet_stats);
+      };
     #endif // CONFIG_MQTT_PINGER_AS_PLAIN
 
+    // Changed subtrees are selected once for all document formats
+    #if (CONFIG_MQTT_PINGER_AS_JSON || CONFIG_MQTT_PINGER_AS_CBOR) && CONFIG_MQTT_PINGER_DELTA
+      bool parts[CONFIG_PINGER_HOSTS_MAX + 1];
+      bool full;
+      bool changed = pingerMqttDocChanged(data, parts, &full);
+    #elif CONFIG_MQTT_PINGER_AS_JSON || CONFIG_MQTT_PINGER_AS_CBOR
+      bool* parts = nullptr;
+      bool full = true;
+      bool changed = true;
+    #endif // CONFIG_MQTT_PINGER_DELTA
+
     #if CONFIG_MQTT_PINGER_AS_JSON
-      char* json_host1 = nullptr;
-      char* json_host2 = nullptr;
-      char* json_host3 = nullptr;
-      char* json_inet = nullptr;
-      char* json_full = nullptr;
-      json_host1 = pingerMqttPublishHostJson(&data->host1);
-      #ifdef CONFIG_PINGER_HOST_2
-        json_host2 = pingerMqttPublishHostJson(&data->host2);
-      #endif // CONFIG_PINGER_HOST_2
-      #ifdef CONFIG_PINGER_HOST_3
-        json_host3 = pingerMqttPublishHostJson(&data->host3);
-      #endif // CONFIG_PINGER_HOST_3
-      json_inet = pingerMqttPublishInetJson(&data->inet);
-      if (json_inet) {
-        if (json_host1) {
-          if (json_host2) {
-            if (json_host3) {
-              json_full = malloc_stringf("{\"internet\":%s,\"host1\":%s,\"host2\":%s,\"host3\":%s}", json_inet, json_host1, json_host2, json_host3);
-              free(json_host3);
-            } else {
-              json_full = malloc_stringf("{\"internet\":%s,\"host1\":%s,\"host2\":%s}", json_inet, json_host1, json_host2);
-            };
-            free(json_host2);
-          } else {
-            json_full = malloc_stringf("{\"internet\":%s,\"host1\":%s}", json_inet, json_host1);
-          };
-          free(json_host1);
+      char* json_doc = changed ? pingerMqttBuildJson(data, parts) : nullptr;
+      if (json_doc) {
+        mqttPublish(_mqttTopicPing, json_doc, 
+          CONFIG_MQTT_PINGER_QOS, CONFIG_MQTT_PINGER_RETAINED && full, false, false);
+      };
+    #endif // CONFIG_MQTT_PINGER_AS_JSON
+
+    #if CONFIG_MQTT_PINGER_AS_CBOR
+      if (changed && _mqttTopicCbor && _mqttRawPublish) {
+        size_t size = pingerCborEncode(_mqttCborBuffer, sizeof(_mqttCborBuffer), data, parts);
+        if (size > 0) {
+          _mqttRawPublish(_mqttTopicCbor, _mqttCborBuffer, size, 
+            CONFIG_MQTT_PINGER_QOS, CONFIG_MQTT_PINGER_RETAINED && full);
         } else {
-          json_full = malloc_stringf("{%s}", json_inet);
-        };
-        free(json_inet);
-        if (json_full) {
-          mqttPublish(_mqttTopicPing, json_full, 
-            CONFIG_MQTT_PINGER_QOS, CONFIG_MQTT_PINGER_RETAINED, false, true);
+          rlog_e(logTAG, "CBOR document does not fit into the buffer");
         };
       };
-    #endif // CONFIG_MQTT_PINGER_AS_JSON
+    #endif // CONFIG_MQTT_PINGER_AS_CBOR
+
+    #if CONFIG_MQTT_PINGER_BACKLOG
+      pingerMqttPublishBacklog();
+    #endif // CONFIG_MQTT_PINGER_BACKLOG
+  #if CONFIG_MQTT_PINGER_BACKLOG
+  } else if (data) {
+    // The broker is not available, the result is saved for later publication
+    pingerBacklogPut(data);
+  #endif // CONFIG_MQTT_PINGER_BACKLOG
+  };
+}
+
+#if CONFIG_PINGER_PHASE_TIMING && CONFIG_MQTT_PINGER_PHASES
+
+static const char* _mqttPhaseNames[PINGER_PHASE_MAX] = { "dns", "socket", "probes", "events", "publish", "cycle" };
+
+static void pingerMqttWritePhases(pinger_writer_t* json, const char* name, const uint32_t* values)
+{
+  pingerWriterPrintf(json, ",\"%s\":{", name);
+  for (uint8_t i = 0; i < PINGER_PHASE_MAX; i++) {
+    pingerWriterPrintf(json, i > 0 ? ",\"%s\":%u" : "\"%s\":%u", _mqttPhaseNames[i], values[i]);
+  };
+  pingerWriterPuts(json, "}");
+}
+
+void pingerMqttPublishPhases(const pinger_phases_t* phases)
+{
+  if ((_mqttTopicPhases) && (phases) && statesMqttIsEnabled()) {
+    char buffer[320];
+    pinger_writer_t json;
+    pingerWriterInit(&json, buffer, sizeof(buffer));
+    pingerWriterPrintf(&json, "{\"cycles\":%u", phases->cycles);
+    pingerMqttWritePhases(&json, "last", phases->last_us);
+    pingerMqttWritePhases(&json, "max", phases->max_us);
+    pingerWriterPuts(&json, "}");
+    if (pingerWriterOk(&json)) {
+      mqttPublish(_mqttTopicPhases, buffer, CONFIG_MQTT_PINGER_QOS, false, false, false);
+    };
   };
 }
 
+#endif // CONFIG_MQTT_PINGER_PHASES
+
+#if CONFIG_PINGER_RESOURCES && CONFIG_MQTT_PINGER_RESOURCES
+
+void pingerMqttPublishResources(const pinger_resources_t* resources)
+{
+  int64_t now = esp_timer_get_time();
+  if ((_mqttTopicResources) && (resources) && statesMqttIsEnabled()
+   && ((_mqttResourcesTime == 0) || ((now - _mqttResourcesTime) >= (int64_t)CONFIG_MQTT_PINGER_RESOURCES_INTERVAL * 1000000))) {
+    char buffer[384];
+    pinger_writer_t json;
+    pingerWriterInit(&json, buffer, sizeof(buffer));
+    pingerWriterPrintf(&json, "{\"cycles\":%u", resources->cycles);
+    pingerWriterPrintf(&json, ",\"heap\":{\"allocs\":%u,\"frees\":%u,\"bytes\":%u,\"used_blocks\":%u,\"used_bytes\":%u,\"free_min\":%u}",
+      resources->allocs, resources->frees, resources->alloc_bytes, resources->used_blocks, resources->used_bytes, resources->heap_free_min);
+    pingerWriterPrintf(&json, ",\"cycle\":{\"allocs\":%u,\"frees\":%u,\"bytes\":%u,\"heap_delta\":%d}",
+      resources->cycle_allocs, resources->cycle_frees, resources->cycle_alloc_bytes, resources->cycle_heap_delta);
+    pingerWriterPrintf(&json, ",\"stack_free\":%u", resources->stack_free_min);
+    pingerWriterPrintf(&json, ",\"sockets\":{\"open\":%u,\"max\":%u,\"opened\":%u}",
+      resources->sockets_open, resources->sockets_open_max, resources->sockets_opened);
+    pingerWriterPrintf(&json, ",\"dns\":{\"lookups\":%u,\"failed\":%u}}", resources->dns_lookups, resources->dns_failed);
+    if (pingerWriterOk(&json)) {
+      _mqttResourcesTime = now;
+      mqttPublish(_mqttTopicResources, buffer, CONFIG_MQTT_PINGER_QOS, false, false, false);
+    };
+  };
+}
+
+#endif // CONFIG_MQTT_PINGER_RESOURCES
+
 // -----------------------------------------------------------------------------------------------------------------------
 // -------------------------------------------------- WiFi event handler -------------------------------------------------
 // -----------------------------------------------------------------------------------------------------------------------
@@ -448,8 +904,18 @@ static void pingerMqttEventHandler(void* arg, esp_event_base_t event_base, int32
   };
 }
 
+#if CONFIG_MQTT_PINGER_AS_CBOR
+void pingerMqttSetRawPublisher(pinger_mqtt_raw_publish_t publisher)
+{
+  _mqttRawPublish = publisher;
+}
+#endif // CONFIG_MQTT_PINGER_AS_CBOR
+
 bool pingerMqttRegister()
 {
+  #if CONFIG_MQTT_PINGER_BACKLOG
+    pingerBacklogInit();
+  #endif // CONFIG_MQTT_PINGER_BACKLOG
   return eventHandlerRegister(RE_MQTT_EVENTS, RE_MQTT_CONNECTED, &pingerMqttEventHandler, nullptr)
       && eventHandlerRegister(RE_MQTT_EVENTS, RE_MQTT_CONN_LOST, &pingerMqttEventHandler, nullptr);
 };
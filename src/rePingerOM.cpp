@@ -8,26 +8,83 @@
 #if CONFIG_PINGER_ENABLE && CONFIG_OPENMON_ENABLE && CONFIG_OPENMON_PINGER_ENABLE
 
 #include "rePingerOM.h"
+#include "rePingerWriter.h"
+#include "rePingerRes.h"
+#include "reEsp32.h"
+
+static const char* logTAG = "PING";
+
+// Number of fields in the order of the controller description, see rePingerOM.h
+#define PINGER_OM_FIELDS_MAX (2 + 3 * CONFIG_PINGER_HOSTS_MAX + 7 + 2)
+// Maximum length of a formatted value
+#define PINGER_OM_VALUE_MAX 24
+
+// Keys "&p1=", "&p2=", ... are generated once, since the order of the fields is fixed by the configuration.
+// The separator of the first value in the payload is omitted
+static char* _omKeys = nullptr;
+static uint16_t _omKeyIndex[PINGER_OM_FIELDS_MAX];
+static char* _omBuffer = nullptr;
+static size_t _omBufferSize = 0;
+
+static void pingerOpenMonWriteKeys(pinger_writer_t* keys)
+{
+  for (uint16_t i = 0; i < PINGER_OM_FIELDS_MAX; i++) {
+    _omKeyIndex[i] = (uint16_t)keys->length;
+    pingerWriterPrintf(keys, "&p%d=", i + 1);
+    pingerWriterPutc(keys, 0);
+  };
+}
 
 void pingerOpenMonInit()
 {
   dsChannelInit(EDS_OPENMON, CONFIG_OPENMON_PINGER_ID, CONFIG_OPENMON_PINGER_TOKEN, CONFIG_OPENMON_MIN_INTERVAL, CONFIG_OPENMON_ERROR_INTERVAL);
+
+  if (_omKeys) return;
+  // First pass calculates the size of the keys, the second one fills them
+  pinger_writer_t keys;
+  pingerWriterInit(&keys, nullptr, 0);
+  pingerOpenMonWriteKeys(&keys);
+  size_t keysSize = pingerWriterRequired(&keys);
+  _omKeys = (char*)PINGER_MALLOC(keysSize);
+  RE_MEM_CHECK(logTAG, _omKeys, return);
+  pingerWriterInit(&keys, _omKeys, keysSize);
+  pingerOpenMonWriteKeys(&keys);
+
+  // The payload buffer is allocated once for the maximum number of fields
+  _omBufferSize = keysSize + PINGER_OM_FIELDS_MAX * PINGER_OM_VALUE_MAX;
+  _omBuffer = (char*)PINGER_MALLOC(_omBufferSize);
+  RE_MEM_CHECK(logTAG, _omBuffer, { PINGER_FREE(_omKeys); _omKeys = nullptr; return; });
 }
 
-void pingerOpenMonPublish(ping_publish_data_t* data)
+static void pingerOpenMonPutInt(pinger_writer_t* values, uint16_t* index, int value)
 {
-  uint8_t omIndex = 1;
-  char* omValues = nullptr;
+  const char* key = _omKeys + _omKeyIndex[*index];
+  pingerWriterPuts(values, values->length > 0 ? key : key + 1);
+  pingerWriterPrintf(values, "%d", value);
+  (*index)++;
+}
+
+static void pingerOpenMonPutFloat(pinger_writer_t* values, uint16_t* index, double value)
+{
+  const char* key = _omKeys + _omKeyIndex[*index];
+  pingerWriterPuts(values, values->length > 0 ? key : key + 1);
+  pingerWriterPrintf(values, "%f", value);
+  (*index)++;
+}
+
+void pingerOpenMonPublish(pinger_publish_data_t* data)
+{
+  if (!_omBuffer) return;
+
+  uint16_t omIndex = 0;
+  pinger_writer_t omValues;
+  pingerWriterInit(&omValues, _omBuffer, _omBufferSize);
 
   // Append RSSI
   #if CONFIG_OPENMON_PINGER_RSSI
     {
       wifi_ap_record_t wifi_info = wifiInfo();
-      omValues = concat_strings_div(omValues, 
-        malloc_stringf("p%d=%d", 
-          omIndex, wifi_info.rssi),
-        "&");
-      omIndex++;
+      pingerOpenMonPutInt(&omValues, &omIndex, wifi_info.rssi);
     }
   #endif // CONFIG_OPENMON_PINGER_RSSI
 
@@ -36,63 +93,46 @@ void pingerOpenMonPublish(ping_publish_data_t* data)
     {
       double heap_total = (double)heap_caps_get_total_size(MALLOC_CAP_DEFAULT) / 1024.0;
       double heap_free = (double)heap_caps_get_free_size(MALLOC_CAP_DEFAULT) / 1024.0;
-      omValues = concat_strings_div(omValues, 
-        malloc_stringf("p%d=%f&p%d=%f", 
-          omIndex, heap_free, 
-          omIndex+1, 100.0*heap_free/heap_total),
-        "&");
-      omIndex = omIndex+2;
+      pingerOpenMonPutFloat(&omValues, &omIndex, heap_free);
+      pingerOpenMonPutFloat(&omValues, &omIndex, 100.0*heap_free/heap_total);
     }
   #endif // CONFIG_OPENMON_PINGER_HEAP_FREE
 
   // Append hosts
   #if CONFIG_OPENMON_PINGER_HOSTS
-    #ifdef CONFIG_PINGER_HOST_1
-      omValues = concat_strings_div(omValues, 
-        malloc_stringf("p%d=%d&p%d=%d&p%d=%f", 
-          omIndex, data->host1.state, 
-          omIndex+1, data->host1.duration_ms, 
-          omIndex+2, data->host1.loss),
-        "&");
-      omIndex = omIndex+3;
-    #endif // CONFIG_PINGER_HOST_1
-    #ifdef CONFIG_PINGER_HOST_2
-      omValues = concat_strings_div(omValues, 
-        malloc_stringf("p%d=%d&p%d=%d&p%d=%f", 
-          omIndex, data->host2.state, 
-          omIndex+1, data->host2.duration_ms, 
-          omIndex+2, data->host2.loss),
-        "&");
-      omIndex = omIndex+3;
-    #endif // CONFIG_PINGER_HOST_2
-    #ifdef CONFIG_PINGER_HOST_3
-      omValues = concat_strings_div(omValues, 
-        malloc_stringf("p%d=%d&p%d=%d&p%d=%f", 
-          omIndex, data->host3.state, 
-          omIndex+1, data->host3.duration_ms, 
-          omIndex+2, data->host3.loss),
-        "&");
-      omIndex = omIndex+3;
-    #endif // CONFIG_PINGER_HOST_3
+    for (uint8_t i = 0; (i < data->hosts_count) && (i < CONFIG_PINGER_HOSTS_MAX); i++) {
+      // The fields of a host without a result in this round are left out
+      if (data->hosts_stats[i].skipped) {
+        omIndex += 3;
+        continue;
+      };
+      pingerOpenMonPutInt(&omValues, &omIndex, data->hosts[i].state);
+      pingerOpenMonPutInt(&omValues, &omIndex, data->hosts[i].duration_ms);
+      pingerOpenMonPutFloat(&omValues, &omIndex, data->hosts[i].loss);
+    };
   #endif // CONFIG_OPENMON_PINGER_HOSTS
 
   // Append internet ping
-  omValues = concat_strings_div(omValues, 
-    malloc_stringf("p%d=%d&p%d=%d&p%d=%d&p%d=%d&p%d=%f&p%d=%f&p%d=%f", 
-      omIndex, data->inet.state, 
-      omIndex+1, data->inet.duration_ms_total, 
-      omIndex+2, data->inet.duration_ms_min,
-      omIndex+3, data->inet.duration_ms_max, 
-      omIndex+4, data->inet.loss_total, 
-      omIndex+5, data->inet.loss_min, 
-      omIndex+6, data->inet.loss_max),
-    "&");
+  pingerOpenMonPutInt(&omValues, &omIndex, data->inet.state);
+  pingerOpenMonPutInt(&omValues, &omIndex, data->inet.duration_ms_total);
+  pingerOpenMonPutInt(&omValues, &omIndex, data->inet.duration_ms_min);
+  pingerOpenMonPutInt(&omValues, &omIndex, data->inet.duration_ms_max);
+  pingerOpenMonPutFloat(&omValues, &omIndex, data->inet.loss_total);
+  pingerOpenMonPutFloat(&omValues, &omIndex, data->inet.loss_min);
+  pingerOpenMonPutFloat(&omValues, &omIndex, data->inet.loss_max);
+
+  // Append variation of the response time
+  #if CONFIG_OPENMON_PINGER_JITTER
+    pingerOpenMonPutFloat(&omValues, &omIndex, data->inet_stats.rtt_mdev_us / 1000.0);
+    pingerOpenMonPutFloat(&omValues, &omIndex, data->inet_stats.jitter_us / 1000.0);
+  #endif // CONFIG_OPENMON_PINGER_JITTER
   
-  // Send to queue
-  if (omValues) {
-    dsSend(EDS_OPENMON, CONFIG_OPENMON_PINGER_ID, omValues, false);
-    free(omValues);
+  // Send to queue: the buffer is copied by the data sending service
+  if (pingerWriterOk(&omValues)) {
+    dsSend(EDS_OPENMON, CONFIG_OPENMON_PINGER_ID, _omBuffer, false);
+  } else {
+    rlog_e(logTAG, "OpenMon payload does not fit into the buffer (%u bytes)", (unsigned)pingerWriterRequired(&omValues));
   };
 }
 
-#endif // CONFIG_OPENMON_ENABLE && CONFIG_OPENMON_PINGER_ENABLE
\ No newline at end of file
+#endif // CONFIG_OPENMON_ENABLE && CONFIG_OPENMON_PINGER_ENABLE
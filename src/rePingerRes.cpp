@@ -0,0 +1,112 @@
+#include <string.h>
+#include "project_config.h"
+#include "def_consts.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_heap_caps.h"
+#include "rLog.h"
+#include "rePingerRes.h"
+
+#if CONFIG_PINGER_RESOURCES
+
+static const char* logTAG = "PING";
+
+// Topics are created in the event loop task, the checks are performed in the pinger task
+#define PINGER_RES_ADD(field, value) __atomic_add_fetch(&_pingRes.field, value, __ATOMIC_RELAXED)
+#define PINGER_RES_SUB(field, value) __atomic_sub_fetch(&_pingRes.field, value, __ATOMIC_RELAXED)
+
+static pinger_resources_t _pingRes = { };
+static uint32_t _cycleAllocs = 0;
+static uint32_t _cycleFrees = 0;
+static uint32_t _cycleBytes = 0;
+static size_t _cycleHeapFree = 0;
+
+static void* pingerResCount(void* ptr)
+{
+  if (ptr) {
+    uint32_t size = heap_caps_get_allocated_size(ptr);
+    PINGER_RES_ADD(allocs, 1);
+    PINGER_RES_ADD(alloc_bytes, size);
+    PINGER_RES_ADD(used_blocks, 1);
+    PINGER_RES_ADD(used_bytes, size);
+  };
+  return ptr;
+}
+
+void* pingerResMalloc(size_t size)
+{
+  return pingerResCount(esp_malloc(size));
+}
+
+void* pingerResCalloc(size_t count, size_t size)
+{
+  return pingerResCount(esp_calloc(count, size));
+}
+
+char* pingerResTrack(char* ptr)
+{
+  return (char*)pingerResCount(ptr);
+}
+
+void pingerResFree(void* ptr)
+{
+  if (ptr) {
+    PINGER_RES_ADD(frees, 1);
+    PINGER_RES_SUB(used_blocks, 1);
+    PINGER_RES_SUB(used_bytes, heap_caps_get_allocated_size(ptr));
+    free(ptr);
+  };
+}
+
+void pingerResSocket(bool opened)
+{
+  if (opened) {
+    PINGER_RES_ADD(sockets_opened, 1);
+    if (PINGER_RES_ADD(sockets_open, 1) > _pingRes.sockets_open_max) {
+      _pingRes.sockets_open_max = _pingRes.sockets_open;
+    };
+  } else {
+    PINGER_RES_SUB(sockets_open, 1);
+  };
+}
+
+void pingerResDns(bool failed)
+{
+  if (failed) {
+    PINGER_RES_ADD(dns_failed, 1);
+  } else {
+    PINGER_RES_ADD(dns_lookups, 1);
+  };
+}
+
+void pingerResCycleBegin()
+{
+  _cycleAllocs = _pingRes.allocs;
+  _cycleFrees = _pingRes.frees;
+  _cycleBytes = _pingRes.alloc_bytes;
+  _cycleHeapFree = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+}
+
+void pingerResCycleEnd()
+{
+  size_t heap_free = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+  _pingRes.cycles++;
+  _pingRes.cycle_allocs = _pingRes.allocs - _cycleAllocs;
+  _pingRes.cycle_frees = _pingRes.frees - _cycleFrees;
+  _pingRes.cycle_alloc_bytes = _pingRes.alloc_bytes - _cycleBytes;
+  _pingRes.cycle_heap_delta = (int32_t)((int64_t)heap_free - (int64_t)_cycleHeapFree);
+  if ((_pingRes.heap_free_min == 0) || (heap_free < _pingRes.heap_free_min)) {
+    _pingRes.heap_free_min = heap_free;
+  };
+  _pingRes.stack_free_min = uxTaskGetStackHighWaterMark(nullptr);
+  rlog_v(logTAG, "Pinger resources: %u allocs, %u frees, %u bytes in the cycle, %u blocks (%u bytes) in use, stack %u bytes free, %u sockets",
+    _pingRes.cycle_allocs, _pingRes.cycle_frees, _pingRes.cycle_alloc_bytes, _pingRes.used_blocks, _pingRes.used_bytes,
+    _pingRes.stack_free_min, _pingRes.sockets_open);
+}
+
+void pingerResourcesGet(pinger_resources_t* resources)
+{
+  if (resources) *resources = _pingRes;
+}
+
+#endif // CONFIG_PINGER_RESOURCES
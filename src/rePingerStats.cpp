@@ -0,0 +1,63 @@
+#include <string.h>
+#include "rePingerStats.h"
+
+static uint16_t pingerHistogramIndex(uint32_t value)
+{
+  if (value < 2 * PINGER_HISTOGRAM_SUB_COUNT) {
+    // Small values are stored exactly
+    return (uint16_t)value;
+  };
+  if (value >= ((uint32_t)1 << PINGER_HISTOGRAM_VALUE_BITS)) {
+    value = ((uint32_t)1 << PINGER_HISTOGRAM_VALUE_BITS) - 1;
+  };
+  uint32_t msb = 31 - __builtin_clz(value);
+  uint32_t sub = (value >> (msb - CONFIG_PINGER_HISTOGRAM_SUB_BITS)) & (PINGER_HISTOGRAM_SUB_COUNT - 1);
+  return (uint16_t)((msb - CONFIG_PINGER_HISTOGRAM_SUB_BITS + 1) * PINGER_HISTOGRAM_SUB_COUNT + sub);
+}
+
+// Middle of the range of values of the bucket
+static uint32_t pingerHistogramValue(uint16_t index)
+{
+  if (index < 2 * PINGER_HISTOGRAM_SUB_COUNT) {
+    return index;
+  };
+  uint32_t shift = index / PINGER_HISTOGRAM_SUB_COUNT - 1;
+  uint32_t sub = index % PINGER_HISTOGRAM_SUB_COUNT;
+  uint32_t lower = (PINGER_HISTOGRAM_SUB_COUNT + sub) << shift;
+  return lower + (((uint32_t)1 << shift) >> 1);
+}
+
+void pingerHistogramReset(pinger_histogram_t* hist)
+{
+  memset(hist, 0, sizeof(pinger_histogram_t));
+}
+
+void pingerHistogramAdd(pinger_histogram_t* hist, uint32_t value)
+{
+  // Aging: halve all counters when the window is full
+  if (hist->total >= CONFIG_PINGER_HISTOGRAM_WINDOW) {
+    hist->total = 0;
+    for (uint16_t i = 0; i < PINGER_HISTOGRAM_BUCKETS; i++) {
+      hist->buckets[i] = hist->buckets[i] / 2;
+      hist->total += hist->buckets[i];
+    };
+  };
+  hist->buckets[pingerHistogramIndex(value)]++;
+  hist->total++;
+}
+
+uint32_t pingerHistogramQuantile(const pinger_histogram_t* hist, float quantile)
+{
+  if (hist->total == 0) return 0;
+  uint32_t target = (uint32_t)(quantile * hist->total + 0.5f);
+  if (target < 1) target = 1;
+  if (target > hist->total) target = hist->total;
+  uint32_t count = 0;
+  for (uint16_t i = 0; i < PINGER_HISTOGRAM_BUCKETS; i++) {
+    count += hist->buckets[i];
+    if (count >= target) {
+      return pingerHistogramValue(i);
+    };
+  };
+  return pingerHistogramValue(PINGER_HISTOGRAM_BUCKETS - 1);
+}
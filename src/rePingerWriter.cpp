@@ -0,0 +1,66 @@
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include "rePingerWriter.h"
+
+void pingerWriterInit(pinger_writer_t* writer, char* buffer, size_t size)
+{
+  writer->buffer = buffer;
+  writer->size = buffer ? size : 0;
+  writer->length = 0;
+  if (writer->size > 0) writer->buffer[0] = 0;
+}
+
+void pingerWriterPuts(pinger_writer_t* writer, const char* text)
+{
+  size_t len = strlen(text);
+  if (writer->length + len < writer->size) {
+    memcpy(writer->buffer + writer->length, text, len + 1);
+  } else if (writer->length < writer->size) {
+    // Text is cut off, the buffer is always terminated
+    writer->buffer[writer->length] = 0;
+  };
+  writer->length += len;
+}
+
+void pingerWriterPutc(pinger_writer_t* writer, char c)
+{
+  if (writer->length + 1 < writer->size) {
+    writer->buffer[writer->length] = c;
+    writer->buffer[writer->length + 1] = 0;
+  } else if (writer->length < writer->size) {
+    writer->buffer[writer->length] = 0;
+  };
+  writer->length++;
+}
+
+void pingerWriterPrintf(pinger_writer_t* writer, const char* format, ...)
+{
+  va_list args;
+  va_start(args, format);
+  int len;
+  if (writer->length < writer->size) {
+    len = vsnprintf(writer->buffer + writer->length, writer->size - writer->length, format, args);
+  } else {
+    // Only the length is counted
+    len = vsnprintf(nullptr, 0, format, args);
+  };
+  va_end(args);
+  if (len > 0) {
+    writer->length += len;
+    // A partially written piece is removed
+    if ((writer->length >= writer->size) && (writer->length - len < writer->size)) {
+      writer->buffer[writer->length - len] = 0;
+    };
+  };
+}
+
+bool pingerWriterOk(const pinger_writer_t* writer)
+{
+  return writer->length < writer->size;
+}
+
+size_t pingerWriterRequired(const pinger_writer_t* writer)
+{
+  return writer->length + 1;
+}